@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/Baggage.h"
+
+#include <functional>
+
+namespace jaegertracing {
+
+const std::string* Baggage::find(const std::string& key) const
+{
+    const auto* node = _root.get();
+    while (node) {
+        if (key < node->_key) {
+            node = node->_left.get();
+        }
+        else if (node->_key < key) {
+            node = node->_right.get();
+        }
+        else {
+            return &node->_value;
+        }
+    }
+    return nullptr;
+}
+
+void Baggage::set(const std::string& key, const std::string& value)
+{
+    auto added = false;
+    _root = insert(_root, key, value, std::hash<std::string>()(key), added);
+    if (added) {
+        ++_size;
+    }
+}
+
+Baggage::NodePtr Baggage::insert(const NodePtr& node,
+                                 const std::string& key,
+                                 const std::string& value,
+                                 std::size_t priority,
+                                 bool& added)
+{
+    if (!node) {
+        added = true;
+        return std::make_shared<const Node>(
+            key, value, priority, nullptr, nullptr);
+    }
+
+    if (key < node->_key) {
+        const auto left = insert(node->_left, key, value, priority, added);
+        if (left->_priority > node->_priority) {
+            // Rotate the new node up to keep the heap order.
+            return std::make_shared<const Node>(
+                left->_key,
+                left->_value,
+                left->_priority,
+                left->_left,
+                std::make_shared<const Node>(node->_key,
+                                             node->_value,
+                                             node->_priority,
+                                             left->_right,
+                                             node->_right));
+        }
+        return std::make_shared<const Node>(
+            node->_key, node->_value, node->_priority, left, node->_right);
+    }
+
+    if (node->_key < key) {
+        const auto right = insert(node->_right, key, value, priority, added);
+        if (right->_priority > node->_priority) {
+            return std::make_shared<const Node>(
+                right->_key,
+                right->_value,
+                right->_priority,
+                std::make_shared<const Node>(node->_key,
+                                             node->_value,
+                                             node->_priority,
+                                             node->_left,
+                                             right->_left),
+                right->_right);
+        }
+        return std::make_shared<const Node>(
+            node->_key, node->_value, node->_priority, node->_left, right);
+    }
+
+    return std::make_shared<const Node>(
+        key, value, node->_priority, node->_left, node->_right);
+}
+
+bool operator==(const Baggage& lhs, const Baggage& rhs)
+{
+    if (lhs._root == rhs._root) {
+        return true;
+    }
+    if (lhs._size != rhs._size) {
+        return false;
+    }
+    auto equal = true;
+    lhs.forEach([&rhs, &equal](const std::string& key,
+                               const std::string& value) {
+        const auto* other = rhs.find(key);
+        equal = other && *other == value;
+        return equal;
+    });
+    return equal;
+}
+
+}  // namespace jaegertracing
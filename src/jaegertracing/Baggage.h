@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_BAGGAGE_H
+#define JAEGERTRACING_BAGGAGE_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace jaegertracing {
+
+// Persistent map of baggage items. Copies share their items, and setting an
+// item copies only the path to it, so a copy never observes changes made
+// through another one. Items are kept in a treap whose priorities are
+// hashes of the keys, which makes its shape depend only on the keys.
+class Baggage {
+  public:
+    using StrMap = std::unordered_map<std::string, std::string>;
+
+    Baggage()
+        : _root()
+        , _size(0)
+    {
+    }
+
+    Baggage(const StrMap& items)
+        : Baggage()
+    {
+        for (auto&& item : items) {
+            set(item.first, item.second);
+        }
+    }
+
+    Baggage(std::initializer_list<std::pair<const std::string, std::string>>
+                items)
+        : Baggage()
+    {
+        for (auto&& item : items) {
+            set(item.first, item.second);
+        }
+    }
+
+    std::size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    // Returns the value of `key`, or null if it is not set. The value lives
+    // as long as any copy of this baggage that shares it.
+    const std::string* find(const std::string& key) const;
+
+    void set(const std::string& key, const std::string& value);
+
+    // Calls `f(key, value)` for each item in key order until it returns
+    // false.
+    template <typename Function>
+    void forEach(Function f) const
+    {
+        forEach(_root.get(), f);
+    }
+
+    StrMap toMap() const
+    {
+        StrMap map;
+        forEach([&map](const std::string& key, const std::string& value) {
+            map.emplace(key, value);
+            return true;
+        });
+        return map;
+    }
+
+    friend bool operator==(const Baggage& lhs, const Baggage& rhs);
+
+    friend bool operator!=(const Baggage& lhs, const Baggage& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+  private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node {
+        Node(const std::string& key,
+             const std::string& value,
+             std::size_t priority,
+             const NodePtr& left,
+             const NodePtr& right)
+            : _key(key)
+            , _value(value)
+            , _priority(priority)
+            , _left(left)
+            , _right(right)
+        {
+        }
+
+        std::string _key;
+        std::string _value;
+        std::size_t _priority;
+        NodePtr _left;
+        NodePtr _right;
+    };
+
+    static NodePtr insert(const NodePtr& node,
+                          const std::string& key,
+                          const std::string& value,
+                          std::size_t priority,
+                          bool& added);
+
+    template <typename Function>
+    static bool forEach(const Node* node, Function& f)
+    {
+        if (!node) {
+            return true;
+        }
+        return forEach(node->_left.get(), f) && f(node->_key, node->_value) &&
+               forEach(node->_right.get(), f);
+    }
+
+    NodePtr _root;
+    std::size_t _size;
+};
+
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_BAGGAGE_H
@@ -18,12 +18,16 @@
 #define JAEGERTRACING_CONFIG_H
 
 #include "jaegertracing/Constants.h"
+#include "jaegertracing/SpanLimitsConfig.h"
 #include "jaegertracing/baggage/RestrictionsConfig.h"
 #include "jaegertracing/propagation/HeadersConfig.h"
 #include "jaegertracing/reporters/Config.h"
 #include "jaegertracing/samplers/Config.h"
+#include "jaegertracing/utils/MemoryResource.h"
 #include "jaegertracing/utils/YAML.h"
 
+#include <memory>
+
 namespace jaegertracing {
 
 class Config {
@@ -47,8 +51,15 @@ class Config {
         const auto baggageRestrictionsNode = configYAML["baggage_restrictions"];
         const auto baggageRestrictions =
             baggage::RestrictionsConfig::parse(baggageRestrictionsNode);
-        return Config(
-            disabled, sampler, reporter, headers, baggageRestrictions);
+        const auto spanLimitsNode = configYAML["span_limits"];
+        const auto spanLimits = SpanLimitsConfig::parse(spanLimitsNode);
+        return Config(disabled,
+                      sampler,
+                      reporter,
+                      headers,
+                      baggageRestrictions,
+                      nullptr,
+                      spanLimits);
     }
 
 #endif  // JAEGERTRACING_WITH_YAML_CPP
@@ -59,12 +70,17 @@ class Config {
                     const propagation::HeadersConfig& headers =
                         propagation::HeadersConfig(),
                     const baggage::RestrictionsConfig& baggageRestrictions =
-                        baggage::RestrictionsConfig())
+                        baggage::RestrictionsConfig(),
+                    const std::shared_ptr<utils::MemoryResource>&
+                        memoryResource = nullptr,
+                    const SpanLimitsConfig& spanLimits = SpanLimitsConfig())
         : _disabled(disabled)
         , _sampler(sampler)
         , _reporter(reporter)
         , _headers(headers)
         , _baggageRestrictions(baggageRestrictions)
+        , _memoryResource(memoryResource)
+        , _spanLimits(spanLimits)
     {
     }
 
@@ -81,12 +97,23 @@ class Config {
         return _baggageRestrictions;
     }
 
+    // Where the tracer allocates spans from. Null for the heap, or the
+    // span pool with Tracer::kSpanPoolOption. Only set in code, not YAML.
+    const std::shared_ptr<utils::MemoryResource>& memoryResource() const
+    {
+        return _memoryResource;
+    }
+
+    const SpanLimitsConfig& spanLimits() const { return _spanLimits; }
+
   private:
     bool _disabled;
     samplers::Config _sampler;
     reporters::Config _reporter;
     propagation::HeadersConfig _headers;
     baggage::RestrictionsConfig _baggageRestrictions;
+    std::shared_ptr<utils::MemoryResource> _memoryResource;
+    SpanLimitsConfig _spanLimits;
 };
 
 }  // namespace jaegertracing
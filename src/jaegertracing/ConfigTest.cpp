@@ -47,6 +47,12 @@ baggage_restrictions:
     denyBaggageOnInitializationFailure: false
     hostPort: 127.0.0.1:5778
     refreshInterval: 60
+span_limits:
+    maxLogs: 10
+    maxLogFields: 5
+    maxTags: 20
+    maxStringLength: 256
+    maxSpanBytes: 8192
 )cfg";
         const auto config = Config::parse(YAML::Load(kConfigYAML));
         ASSERT_EQ("probabilistic", config.sampler().type());
@@ -54,6 +60,39 @@ baggage_restrictions:
         ASSERT_EQ("baggage", config.headers().jaegerBaggageHeader());
         ASSERT_EQ("trace-id", config.headers().traceContextHeaderName());
         ASSERT_EQ("testctx-", config.headers().traceBaggageHeaderPrefix());
+        ASSERT_TRUE(config.reporter().endpoint().empty());
+        ASSERT_EQ(10, config.spanLimits().maxLogs());
+        ASSERT_EQ(5, config.spanLimits().maxLogFields());
+        ASSERT_EQ(20, config.spanLimits().maxTags());
+        ASSERT_EQ(256, config.spanLimits().maxStringLength());
+        ASSERT_EQ(8192, config.spanLimits().maxSpanBytes());
+    }
+
+    {
+        constexpr auto kConfigYAML = R"cfg(
+reporter:
+    endpoint: http://127.0.0.1:14268/api/traces
+    maxBatchBytes: 65536
+    gzip: true
+)cfg";
+        const auto config = Config::parse(YAML::Load(kConfigYAML));
+        ASSERT_EQ("http://127.0.0.1:14268/api/traces",
+                  config.reporter().endpoint());
+        ASSERT_EQ(65536, config.reporter().maxBatchBytes());
+        ASSERT_TRUE(config.reporter().gzip());
+        ASSERT_FALSE(config.reporter().ioUring());
+    }
+
+    {
+        constexpr auto kConfigYAML = R"cfg(
+reporter:
+    localAgentHostPort: unix:///var/run/jaeger-agent.sock
+    ioUring: true
+)cfg";
+        const auto config = Config::parse(YAML::Load(kConfigYAML));
+        ASSERT_EQ("/var/run/jaeger-agent.sock",
+                  config.reporter().unixSocketPath());
+        ASSERT_TRUE(config.reporter().ioUring());
     }
 
     {
@@ -63,6 +102,7 @@ sampler: 1
 reporter: 2
 headers: 3
 baggage_restrictions: 4
+span_limits: 5
 )cfg"));
     }
 }
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/FinishedSpan.h"
+#include "jaegertracing/Tracer.h"
+
+namespace jaegertracing {
+
+std::string FinishedSpan::serviceName() const
+{
+    if (!_tracer) {
+        return std::string();
+    }
+    return _tracer->serviceName();
+}
+
+std::shared_ptr<const Tracer> FinishedSpan::processTracer() const
+{
+    if (_tracer) {
+        return _tracer;
+    }
+    return std::dynamic_pointer_cast<const Tracer>(
+        opentracing::Tracer::Global());
+}
+
+}  // namespace jaegertracing
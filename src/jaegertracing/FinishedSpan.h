@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_FINISHEDSPAN_H
+#define JAEGERTRACING_FINISHEDSPAN_H
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opentracing/span.h>
+
+#include "jaegertracing/LogRecord.h"
+#include "jaegertracing/Operation.h"
+#include "jaegertracing/Reference.h"
+#include "jaegertracing/SpanContext.h"
+#include "jaegertracing/Tag.h"
+#include "jaegertracing/thrift-gen/jaeger_types.h"
+#include "jaegertracing/utils/SmallVector.h"
+
+namespace jaegertracing {
+
+class Tracer;
+
+// Immutable snapshot of a span taken when it finishes. Span moves its tags,
+// logs and references into a FinishedSpan, so reporters receive the data by
+// ownership transfer instead of deep-copying a live Span.
+class FinishedSpan {
+  public:
+    using SteadyClock = opentracing::SteadyClock;
+    using SystemClock = opentracing::SystemClock;
+    // Most spans have a few tags and at most one reference, which are kept
+    // inline to avoid allocating.
+    using TagList = utils::SmallVector<Tag, 8>;
+    using ReferenceList = utils::SmallVector<Reference, 1>;
+
+    explicit FinishedSpan(
+        const std::shared_ptr<const Tracer>& tracer = nullptr,
+        const SpanContext& context = SpanContext(),
+        std::string operationName = "",
+        const SystemClock::time_point& startTimeSystem = SystemClock::now(),
+        const SteadyClock::duration& duration = SteadyClock::duration(),
+        TagList tags = {},
+        std::vector<LogRecord> logs = {},
+        ReferenceList references = {},
+        const OperationHandle& operation = nullptr)
+        : _tracer(tracer)
+        , _context(context)
+        , _operationName(std::move(operationName))
+        , _startTimeSystem(startTimeSystem)
+        , _duration(duration)
+        , _tags(std::move(tags))
+        , _logs(std::move(logs))
+        , _references(std::move(references))
+        , _operation(operation)
+    {
+    }
+
+    FinishedSpan(const FinishedSpan&) = delete;
+
+    FinishedSpan& operator=(const FinishedSpan&) = delete;
+
+    thrift::Span thrift() const
+    {
+        thrift::Span span;
+        span.__set_traceIdHigh(_context.traceID().high());
+        span.__set_traceIdLow(_context.traceID().low());
+        span.__set_spanId(_context.spanID());
+        span.__set_parentSpanId(_context.parentID());
+        span.__set_operationName(operationName());
+
+        std::vector<thrift::SpanRef> refs;
+        refs.reserve(_references.size());
+        std::transform(std::begin(_references),
+                       std::end(_references),
+                       std::back_inserter(refs),
+                       [](const Reference& ref) { return ref.thrift(); });
+        span.__set_references(refs);
+
+        span.__set_flags(_context.flags());
+        span.__set_startTime(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                _startTimeSystem.time_since_epoch())
+                .count());
+        span.__set_duration(
+            std::chrono::duration_cast<std::chrono::microseconds>(_duration)
+                .count());
+
+        std::vector<thrift::Tag> tags;
+        tags.reserve(operationTags().size() + _tags.size());
+        std::transform(std::begin(operationTags()),
+                       std::end(operationTags()),
+                       std::back_inserter(tags),
+                       [](const Tag& tag) { return tag.thrift(); });
+        std::transform(std::begin(_tags),
+                       std::end(_tags),
+                       std::back_inserter(tags),
+                       [](const Tag& tag) { return tag.thrift(); });
+        span.__set_tags(tags);
+
+        std::vector<thrift::Log> logs;
+        logs.reserve(_logs.size());
+        std::transform(std::begin(_logs),
+                       std::end(_logs),
+                       std::back_inserter(logs),
+                       [](const LogRecord& log) { return log.thrift(); });
+        span.__set_logs(logs);
+
+        return span;
+    }
+
+    template <typename Stream>
+    void print(Stream& out) const
+    {
+        out << _context;
+    }
+
+    const std::shared_ptr<const Tracer>& tracer() const { return _tracer; }
+
+    std::string serviceName() const;
+
+    // Tracer whose process the span belongs to: its own, else the global
+    // tracer if that is a Jaeger tracer, else null.
+    std::shared_ptr<const Tracer> processTracer() const;
+
+    const SpanContext& context() const { return _context; }
+
+    const std::string& operationName() const
+    {
+        return _operation ? _operation->name() : _operationName;
+    }
+
+    const SystemClock::time_point& startTimeSystem() const
+    {
+        return _startTimeSystem;
+    }
+
+    const SteadyClock::duration& duration() const { return _duration; }
+
+    // Tags set on the span. Reported after operationTags().
+    const TagList& tags() const { return _tags; }
+
+    // Static tags of the registered operation the span was started from.
+    const std::vector<Tag>& operationTags() const
+    {
+        static const std::vector<Tag> kNoTags;
+        return _operation ? _operation->tags() : kNoTags;
+    }
+
+    const std::vector<LogRecord>& logs() const { return _logs; }
+
+    const ReferenceList& references() const { return _references; }
+
+  private:
+    std::shared_ptr<const Tracer> _tracer;
+    SpanContext _context;
+    std::string _operationName;
+    SystemClock::time_point _startTimeSystem;
+    SteadyClock::duration _duration;
+    TagList _tags;
+    std::vector<LogRecord> _logs;
+    ReferenceList _references;
+    // Set for spans started from a registered operation, in which case it
+    // provides the name instead of _operationName.
+    OperationHandle _operation;
+};
+
+}  // namespace jaegertracing
+
+inline std::ostream& operator<<(std::ostream& out,
+                                const jaegertracing::FinishedSpan& span)
+{
+    span.print(out);
+    return out;
+}
+
+#endif  // JAEGERTRACING_FINISHEDSPAN_H
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/HTTPTransport.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/transport/TBufferTransports.h>
+
+#include "jaegertracing/Constants.h"
+#include "jaegertracing/Tracer.h"
+#include "jaegertracing/thrift-gen/jaeger_types.h"
+
+#ifdef JAEGERTRACING_WITH_ZLIB
+#include <zlib.h>
+#endif  // JAEGERTRACING_WITH_ZLIB
+
+namespace jaegertracing {
+namespace {
+
+std::string getBufferAsString(apache::thrift::transport::TMemoryBuffer& buffer)
+{
+    uint8_t* data = nullptr;
+    uint32_t size = 0;
+    buffer.getBuffer(&data, &size);
+    return std::string(reinterpret_cast<const char*>(data), size);
+}
+
+#ifdef JAEGERTRACING_WITH_ZLIB
+
+std::string gzipCompress(const std::string& data)
+{
+    ::z_stream stream = {};
+    // 16 added to the window bits selects the gzip wrapper.
+    constexpr auto kWindowBits = 15 + 16;
+    constexpr auto kMemLevel = 8;
+    if (::deflateInit2(&stream,
+                       Z_DEFAULT_COMPRESSION,
+                       Z_DEFLATED,
+                       kWindowBits,
+                       kMemLevel,
+                       Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("Failed to initialize gzip stream");
+    }
+
+    std::string compressed(::deflateBound(&stream, data.size()), '\0');
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    stream.avail_out = compressed.size();
+    const auto result = ::deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    ::deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error("Failed to gzip span batch");
+    }
+    return compressed;
+}
+
+#endif  // JAEGERTRACING_WITH_ZLIB
+
+}  // anonymous namespace
+
+constexpr int HTTPTransport::kDefaultMaxBatchBytes;
+
+HTTPTransport::HTTPTransport(const net::URI& endpoint,
+                             int maxBatchBytes,
+                             bool gzip)
+    : _endpoint(endpoint)
+    , _maxBatchBytes(maxBatchBytes > 0 ? maxBatchBytes
+                                       : kDefaultMaxBatchBytes)
+    , _gzip(gzip)
+    , _client()
+    , _spanBuffer(new apache::thrift::transport::TMemoryBuffer())
+    , _protocol(
+          apache::thrift::protocol::TBinaryProtocolFactory().getProtocol(
+              _spanBuffer))
+    , _body()
+    , _prefixSize(0)
+    , _numSpans(0)
+{
+#ifndef JAEGERTRACING_WITH_ZLIB
+    if (_gzip) {
+        throw std::invalid_argument(
+            "gzip compression requires building with zlib");
+    }
+#endif  // JAEGERTRACING_WITH_ZLIB
+}
+
+int HTTPTransport::append(const FinishedSpan& span)
+{
+    if (_prefixSize == 0) {
+        // Encode a batch with no spans once and keep everything up to the
+        // final field stop byte as the prefix of every request.
+        // Without a tracer, spans are sent with an empty process.
+        const auto tracer = span.processTracer();
+        thrift::Batch batch;
+        batch.process.__set_serviceName(tracer ? tracer->serviceName()
+                                               : std::string());
+        const auto tracerTags = tracer ? tracer->tags() : std::vector<Tag>();
+        std::vector<thrift::Tag> thriftTags;
+        thriftTags.reserve(tracerTags.size());
+        std::transform(std::begin(tracerTags),
+                       std::end(tracerTags),
+                       std::back_inserter(thriftTags),
+                       [](const Tag& tag) { return tag.thrift(); });
+        batch.process.__set_tags(thriftTags);
+        _spanBuffer->resetBuffer();
+        batch.write(_protocol.get());
+        _body = getBufferAsString(*_spanBuffer);
+        _body.pop_back();
+        _prefixSize = _body.size();
+    }
+
+    _spanBuffer->resetBuffer();
+    span.thrift().write(_protocol.get());
+    const auto encodedSpan = getBufferAsString(*_spanBuffer);
+
+    auto flushed = 0;
+    if (_numSpans > 0 &&
+        _body.size() + encodedSpan.size() + 1 >
+            static_cast<std::size_t>(_maxBatchBytes)) {
+        flushed = flush();
+    }
+    // A single span larger than the limit is still sent on its own.
+    _body.append(encodedSpan);
+    ++_numSpans;
+    return flushed;
+}
+
+int HTTPTransport::flush()
+{
+    if (_numSpans == 0) {
+        return 0;
+    }
+
+    const auto numSpans = _numSpans;
+    // Binary protocol list sizes are big-endian i32.
+    const auto countOffset = _prefixSize - 4;
+    const auto count = static_cast<uint32_t>(numSpans);
+    _body[countOffset] = static_cast<char>((count >> 24) & 0xff);
+    _body[countOffset + 1] = static_cast<char>((count >> 16) & 0xff);
+    _body[countOffset + 2] = static_cast<char>((count >> 8) & 0xff);
+    _body[countOffset + 3] = static_cast<char>(count & 0xff);
+    _body.push_back('\0');  // Batch field stop
+
+    try {
+        std::vector<net::http::Header> headers{ net::http::Header(
+            "Content-Type", "application/x-thrift") };
+        net::http::Response response;
+#ifdef JAEGERTRACING_WITH_ZLIB
+        if (_gzip) {
+            headers.emplace_back("Content-Encoding", "gzip");
+            response =
+                _client.post(_endpoint, headers, gzipCompress(_body));
+        }
+        else {
+            response = _client.post(_endpoint, headers, _body);
+        }
+#else
+        response = _client.post(_endpoint, headers, _body);
+#endif  // JAEGERTRACING_WITH_ZLIB
+        resetBody();
+        if (response.statusCode() < 200 || response.statusCode() >= 300) {
+            std::ostringstream oss;
+            oss << "Could not send spans, collector responded with status "
+                << response.statusCode() << ' ' << response.reason();
+            throw Transport::Exception(oss.str(), numSpans);
+        }
+    } catch (const Transport::Exception&) {
+        throw;
+    } catch (const std::system_error& ex) {
+        resetBody();
+        std::ostringstream oss;
+        oss << "Could not send spans " << ex.what()
+            << ", code=" << ex.code().value();
+        throw Transport::Exception(oss.str(), numSpans);
+    } catch (const std::exception& ex) {
+        resetBody();
+        std::ostringstream oss;
+        oss << "Could not send spans " << ex.what();
+        throw Transport::Exception(oss.str(), numSpans);
+    } catch (...) {
+        resetBody();
+        throw Transport::Exception("Could not send spans, unknown error",
+                                   numSpans);
+    }
+    return numSpans;
+}
+
+}  // namespace jaegertracing
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_HTTPTRANSPORT_H
+#define JAEGERTRACING_HTTPTRANSPORT_H
+
+#include <memory>
+#include <string>
+
+#include "jaegertracing/FinishedSpan.h"
+#include "jaegertracing/Transport.h"
+#include "jaegertracing/net/URI.h"
+#include "jaegertracing/net/http/Client.h"
+
+namespace apache {
+namespace thrift {
+namespace protocol {
+class TProtocol;
+}  // namespace protocol
+namespace transport {
+class TMemoryBuffer;
+}  // namespace transport
+}  // namespace thrift
+}  // namespace apache
+
+namespace jaegertracing {
+
+// Sends spans straight to a collector's HTTP endpoint (e.g.
+// http://jaeger-collector:14268/api/traces) as a Thrift binary encoded
+// Batch, over a single keep-alive connection. Spans are batched until the
+// encoded batch would grow past maxBatchBytes or the reporter flushes.
+class HTTPTransport : public Transport {
+  public:
+    static constexpr auto kDefaultMaxBatchBytes = 1024 * 1024;
+
+    HTTPTransport(const net::URI& endpoint, int maxBatchBytes, bool gzip);
+
+    ~HTTPTransport() { close(); }
+
+    int append(const FinishedSpan& span) override;
+
+    int flush() override;
+
+    void close() override { _client.close(); }
+
+  private:
+    void resetBody()
+    {
+        _body.resize(_prefixSize);
+        _numSpans = 0;
+    }
+
+    net::URI _endpoint;
+    int _maxBatchBytes;
+    bool _gzip;
+    net::http::Client _client;
+    std::shared_ptr<apache::thrift::transport::TMemoryBuffer> _spanBuffer;
+    std::shared_ptr<apache::thrift::protocol::TProtocol> _protocol;
+    // Encoded batch up to and including the span list header, followed by
+    // the spans appended so far. The list size sits in the last four bytes
+    // of the prefix and is filled in on flush.
+    std::string _body;
+    std::size_t _prefixSize;
+    int _numSpans;
+};
+
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_HTTPTRANSPORT_H
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "jaegertracing/Constants.h"
+#include "jaegertracing/HTTPTransport.h"
+#include "jaegertracing/Tracer.h"
+#include "jaegertracing/net/Socket.h"
+#include "jaegertracing/testutils/TracerUtil.h"
+#include "jaegertracing/thrift-gen/jaeger_types.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/transport/TBufferTransports.h>
+
+#ifdef JAEGERTRACING_WITH_ZLIB
+#include <zlib.h>
+#endif  // JAEGERTRACING_WITH_ZLIB
+
+namespace jaegertracing {
+namespace {
+
+#ifdef JAEGERTRACING_WITH_ZLIB
+
+std::string gunzip(const std::string& data)
+{
+    ::z_stream stream = {};
+    EXPECT_EQ(Z_OK, ::inflateInit2(&stream, 15 + 16));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    std::string result;
+    char buffer[4096];
+    auto status = Z_OK;
+    while (status == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = ::inflate(&stream, Z_NO_FLUSH);
+        result.append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+    EXPECT_EQ(Z_STREAM_END, status);
+    ::inflateEnd(&stream);
+    return result;
+}
+
+#endif  // JAEGERTRACING_WITH_ZLIB
+
+// Minimal collector endpoint. Serves requests on each accepted connection
+// until the client closes it.
+class MockCollector {
+  public:
+    explicit MockCollector(int statusCode = 202)
+        : _statusCode(statusCode)
+        , _running(true)
+        , _numConnections(0)
+    {
+        _socket.open(AF_INET, SOCK_STREAM);
+        _socket.bind(net::IPAddress::v4("127.0.0.1", 0));
+        _socket.listen();
+        ::sockaddr_storage addrStorage;
+        ::socklen_t addrLen = sizeof(addrStorage);
+        ::getsockname(_socket.handle(),
+                      reinterpret_cast<::sockaddr*>(&addrStorage),
+                      &addrLen);
+        _address = net::IPAddress(addrStorage, addrLen);
+        _thread = std::thread([this]() { serve(); });
+    }
+
+    ~MockCollector()
+    {
+        _running = false;
+        // Wake up the blocking accept.
+        net::Socket socket;
+        socket.open(AF_INET, SOCK_STREAM);
+        socket.connect(_address);
+        socket.close();
+        _thread.join();
+    }
+
+    net::URI endpoint() const
+    {
+        return net::URI::parse("http://" + _address.authority() +
+                               "/api/traces");
+    }
+
+    std::vector<thrift::Batch> batches() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _batches;
+    }
+
+    int numConnections() const { return _numConnections; }
+
+  private:
+    void serve()
+    {
+        while (_running) {
+            auto clientSocket = _socket.accept();
+            if (!_running) {
+                break;
+            }
+            ++_numConnections;
+            std::string buffer;
+            while (handleRequest(clientSocket, buffer)) {
+            }
+        }
+    }
+
+    bool readMore(net::Socket& clientSocket, std::string& buffer)
+    {
+        char data[4096];
+        const auto numRead =
+            ::recv(clientSocket.handle(), data, sizeof(data), 0);
+        if (numRead <= 0) {
+            return false;
+        }
+        buffer.append(data, numRead);
+        return true;
+    }
+
+    bool handleRequest(net::Socket& clientSocket, std::string& buffer)
+    {
+        auto headEnd = std::string::npos;
+        while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!readMore(clientSocket, buffer)) {
+                return false;
+            }
+        }
+        const auto head = buffer.substr(0, headEnd);
+        EXPECT_EQ(0U, head.find("POST /api/traces HTTP/1.1\r\n"));
+        EXPECT_NE(std::string::npos,
+                  head.find("Content-Type: application/x-thrift"));
+        const auto lengthPos = head.find("Content-Length: ");
+        EXPECT_NE(std::string::npos, lengthPos);
+        const auto length = static_cast<std::size_t>(std::strtoull(
+            head.c_str() + lengthPos + std::strlen("Content-Length: "),
+            nullptr,
+            10));
+        const auto bodyStart = headEnd + 4;
+        while (buffer.size() - bodyStart < length) {
+            if (!readMore(clientSocket, buffer)) {
+                return false;
+            }
+        }
+        auto body = buffer.substr(bodyStart, length);
+        buffer.erase(0, bodyStart + length);
+
+#ifdef JAEGERTRACING_WITH_ZLIB
+        if (head.find("Content-Encoding: gzip") != std::string::npos) {
+            body = gunzip(body);
+        }
+#endif  // JAEGERTRACING_WITH_ZLIB
+
+        std::shared_ptr<apache::thrift::transport::TMemoryBuffer> transport(
+            new apache::thrift::transport::TMemoryBuffer(
+                reinterpret_cast<uint8_t*>(&body[0]), body.size()));
+        apache::thrift::protocol::TBinaryProtocol protocol(transport);
+        thrift::Batch batch;
+        batch.read(&protocol);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _batches.push_back(batch);
+        }
+
+        std::ostringstream oss;
+        oss << "HTTP/1.1 " << _statusCode << " Status\r\n"
+            << "Content-Length: 0\r\n\r\n";
+        const auto response = oss.str();
+        ::send(clientSocket.handle(), response.data(), response.size(), 0);
+        return true;
+    }
+
+    int _statusCode;
+    net::Socket _socket;
+    net::IPAddress _address;
+    std::atomic<bool> _running;
+    std::atomic<int> _numConnections;
+    mutable std::mutex _mutex;
+    std::vector<thrift::Batch> _batches;
+    std::thread _thread;
+};
+
+int countSpans(const std::vector<thrift::Batch>& batches)
+{
+    auto numSpans = 0;
+    for (auto&& batch : batches) {
+        numSpans += batch.spans.size();
+    }
+    return numSpans;
+}
+
+}  // anonymous namespace
+
+TEST(HTTPTransport, testReusesConnection)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    MockCollector collector;
+    constexpr auto kNumSpans = 100;
+    auto numSent = 0;
+    {
+        // Small batches so the spans take several requests.
+        HTTPTransport sender(collector.endpoint(), 1024, false);
+        for (auto i = 0; i < kNumSpans; ++i) {
+            const FinishedSpan span(
+                tracer, SpanContext(), "test" + std::to_string(i));
+            numSent += sender.append(span);
+        }
+        numSent += sender.flush();
+    }
+    ASSERT_EQ(kNumSpans, numSent);
+
+    const auto batches = collector.batches();
+    ASSERT_GT(batches.size(), 1U);
+    ASSERT_EQ(kNumSpans, countSpans(batches));
+    ASSERT_EQ(tracer->serviceName(), batches[0].process.serviceName);
+    ASSERT_EQ("test0", batches[0].spans[0].operationName);
+    ASSERT_EQ(1, collector.numConnections());
+}
+
+TEST(HTTPTransport, testSpanWithoutTracer)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    // The process comes from the global tracer.
+    MockCollector collector;
+    {
+        HTTPTransport sender(collector.endpoint(), 0, false);
+        sender.append(FinishedSpan(nullptr, SpanContext(), "test"));
+        ASSERT_EQ(1, sender.flush());
+    }
+    const auto batches = collector.batches();
+    ASSERT_EQ(1U, batches.size());
+    ASSERT_EQ(tracer->serviceName(), batches[0].process.serviceName);
+}
+
+#ifdef JAEGERTRACING_WITH_ZLIB
+
+TEST(HTTPTransport, testGzip)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    MockCollector collector;
+    constexpr auto kNumSpans = 10;
+    {
+        HTTPTransport sender(collector.endpoint(), 0, true);
+        for (auto i = 0; i < kNumSpans; ++i) {
+            sender.append(FinishedSpan(tracer, SpanContext(), "test"));
+        }
+        ASSERT_EQ(kNumSpans, sender.flush());
+    }
+    const auto batches = collector.batches();
+    ASSERT_EQ(1U, batches.size());
+    ASSERT_EQ(kNumSpans, countSpans(batches));
+}
+
+#endif  // JAEGERTRACING_WITH_ZLIB
+
+TEST(HTTPTransport, testErrorStatus)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    MockCollector collector(500);
+    HTTPTransport sender(collector.endpoint(), 0, false);
+    constexpr auto kNumSpans = 3;
+    for (auto i = 0; i < kNumSpans; ++i) {
+        sender.append(FinishedSpan(tracer, SpanContext(), "test"));
+    }
+    try {
+        sender.flush();
+        FAIL() << "Expected Transport::Exception";
+    } catch (const Transport::Exception& ex) {
+        ASSERT_EQ(kNumSpans, ex.numFailed());
+    }
+    // The failed batch is dropped, not resent on the next flush.
+    ASSERT_EQ(0, sender.flush());
+}
+
+}  // namespace jaegertracing
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/IDGenerator.h"
+
+#include <pthread.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace jaegertracing {
+namespace {
+
+// Incremented in the child after every fork. Thread states remember the
+// generation they were seeded in and reseed when it changes.
+std::atomic<unsigned> forkGeneration(1);
+
+void onFork() { forkGeneration.fetch_add(1, std::memory_order_relaxed); }
+
+std::once_flag atForkFlag;
+
+uint64_t splitMix64(uint64_t& x)
+{
+    auto z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t rotateLeft(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+class ThreadState {
+  public:
+    ThreadState()
+        : _state()
+        , _generation(0)
+    {
+    }
+
+    uint64_t next()
+    {
+        const auto generation = forkGeneration.load(std::memory_order_relaxed);
+        if (_generation != generation) {
+            seed();
+            _generation = generation;
+        }
+
+        // xoshiro256** (http://xoshiro.di.unimi.it/).
+        const auto result = rotateLeft(_state[1] * 5, 7) * 9;
+        const auto t = _state[1] << 17;
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = rotateLeft(_state[3], 45);
+        return result;
+    }
+
+  private:
+    void seed()
+    {
+        std::random_device device;
+        auto x = (static_cast<uint64_t>(device()) << 32) | device();
+        // Mix in values that differ between threads and processes in case
+        // random_device is deterministic on this platform.
+        x ^= std::hash<std::thread::id>()(std::this_thread::get_id());
+        x ^= static_cast<uint64_t>(
+            std::chrono::high_resolution_clock::now().time_since_epoch()
+                .count());
+        for (auto&& word : _state) {
+            word = splitMix64(x);
+        }
+    }
+
+    std::array<uint64_t, 4> _state;
+    unsigned _generation;
+};
+
+thread_local ThreadState threadState;
+
+}  // anonymous namespace
+
+RandomIDGenerator::RandomIDGenerator()
+{
+    std::call_once(atForkFlag,
+                   []() { ::pthread_atfork(nullptr, nullptr, &onFork); });
+}
+
+uint64_t RandomIDGenerator::generate() { return threadState.next(); }
+
+}  // namespace jaegertracing
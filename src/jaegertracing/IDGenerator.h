@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_IDGENERATOR_H
+#define JAEGERTRACING_IDGENERATOR_H
+
+#include <cstdint>
+
+namespace jaegertracing {
+
+class IDGenerator {
+  public:
+    virtual ~IDGenerator() = default;
+
+    // Must be safe to call concurrently from any thread. Tracer discards
+    // zero values, so implementations need not filter them.
+    virtual uint64_t generate() = 0;
+};
+
+// Default generator. Each thread owns an independent xoshiro256** state, so
+// generating an ID never takes a lock. The state is seeded lazily from
+// std::random_device on first use in a thread and reseeded in a child process
+// after fork so parent and child never produce the same sequence.
+class RandomIDGenerator : public IDGenerator {
+  public:
+    RandomIDGenerator();
+
+    uint64_t generate() override;
+};
+
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_IDGENERATOR_H
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/IDGenerator.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <mutex>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
+#include <vector>
+
+namespace jaegertracing {
+
+TEST(IDGenerator, testUniqueAcrossThreads)
+{
+    constexpr auto kNumThreads = 4;
+    constexpr auto kNumIDs = 10000;
+
+    RandomIDGenerator generator;
+    std::unordered_set<uint64_t> ids;
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&generator, &ids, &mutex]() {
+            std::vector<uint64_t> localIDs;
+            localIDs.reserve(kNumIDs);
+            for (auto j = 0; j < kNumIDs; ++j) {
+                localIDs.push_back(generator.generate());
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            std::copy(std::begin(localIDs),
+                      std::end(localIDs),
+                      std::inserter(ids, std::end(ids)));
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(kNumThreads * kNumIDs, ids.size());
+}
+
+TEST(IDGenerator, testReseedAfterFork)
+{
+    RandomIDGenerator generator;
+    generator.generate();
+
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    const auto pid = ::fork();
+    ASSERT_LE(0, pid);
+    if (pid == 0) {
+        const auto childID = generator.generate();
+        const auto numWritten = ::write(fds[1], &childID, sizeof(childID));
+        ::_exit(numWritten == sizeof(childID) ? 0 : 1);
+    }
+
+    const auto parentID = generator.generate();
+    auto childID = static_cast<uint64_t>(0);
+    const auto numRead = ::read(fds[0], &childID, sizeof(childID));
+    ::close(fds[0]);
+    ::close(fds[1]);
+    auto status = 0;
+    ::waitpid(pid, &status, 0);
+    ASSERT_EQ(sizeof(childID), numRead);
+    ASSERT_NE(parentID, childID);
+}
+
+}  // namespace jaegertracing
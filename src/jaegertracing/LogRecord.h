@@ -57,6 +57,8 @@ class LogRecord {
 
     const std::vector<Tag>& fields() const { return _fields; }
 
+    std::vector<Tag>& fields() { return _fields; }
+
     thrift::Log thrift() const
     {
         thrift::Log log;
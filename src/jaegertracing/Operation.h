@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_OPERATION_H
+#define JAEGERTRACING_OPERATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "jaegertracing/Tag.h"
+
+namespace jaegertracing {
+
+// An operation registered once through Tracer::registerOperation. Spans
+// started from it share its name and static tags instead of copying them,
+// and samplers look it up by its precomputed hash, or in the slot the last
+// one to find it left.
+class Operation {
+  public:
+    static std::size_t hash(const std::string& name)
+    {
+        return std::hash<std::string>()(name);
+    }
+
+    Operation(std::string name, std::vector<Tag> tags)
+        : _name(std::move(name))
+        , _hash(hash(_name))
+        , _tags(std::move(tags))
+        , _samplerVersion(0)
+        , _samplerOwner(0)
+        , _samplerSlot(nullptr)
+    {
+    }
+
+    const std::string& name() const { return _name; }
+
+    std::size_t hash() const { return _hash; }
+
+    const std::vector<Tag>& tags() const { return _tags; }
+
+    // Returns the slot set by the sampler whose unique id is `owner`, or
+    // null if another one set it last or is setting it.
+    void* samplerSlot(uint64_t owner) const
+    {
+        const auto version = _samplerVersion.load(std::memory_order_acquire);
+        if (version % 2 != 0) {
+            return nullptr;
+        }
+        const auto currentOwner =
+            _samplerOwner.load(std::memory_order_relaxed);
+        auto* slot = _samplerSlot.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (currentOwner != owner ||
+            _samplerVersion.load(std::memory_order_relaxed) != version) {
+            return nullptr;
+        }
+        return slot;
+    }
+
+    // Sets the slot, replacing the one of another owner, such as a sampler
+    // that was since replaced. Skipped while another owner is setting it.
+    // The slot must stay valid while `owner` lives.
+    void setSamplerSlot(uint64_t owner, void* slot) const
+    {
+        auto version = _samplerVersion.load(std::memory_order_relaxed);
+        if (version % 2 != 0 ||
+            !_samplerVersion.compare_exchange_strong(
+                version, version + 1, std::memory_order_relaxed)) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        _samplerOwner.store(owner, std::memory_order_relaxed);
+        _samplerSlot.store(slot, std::memory_order_relaxed);
+        _samplerVersion.store(version + 2, std::memory_order_release);
+    }
+
+  private:
+    const std::string _name;
+    const std::size_t _hash;
+    const std::vector<Tag> _tags;
+    // Odd while a sampler sets its slot, so readers never pair one
+    // sampler's slot with another's id.
+    mutable std::atomic<uint64_t> _samplerVersion;
+    mutable std::atomic<uint64_t> _samplerOwner;
+    mutable std::atomic<void*> _samplerSlot;
+};
+
+using OperationHandle = std::shared_ptr<const Operation>;
+
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_OPERATION_H
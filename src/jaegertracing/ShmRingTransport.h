@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_SHMRINGTRANSPORT_H
+#define JAEGERTRACING_SHMRINGTRANSPORT_H
+
+#include <memory>
+#include <string>
+
+#include "jaegertracing/UDPTransport.h"
+#include "jaegertracing/utils/ShmRingClient.h"
+
+namespace jaegertracing {
+
+// Hands spans to an agent on the same host through shared memory, packed
+// the same way as over UDP. The agent registers rings on a Unix socket at
+// `path`.
+class ShmRingTransport : public UDPTransport {
+  public:
+    ShmRingTransport(const std::string& path, int maxPacketSize)
+        : UDPTransport(std::unique_ptr<utils::UDPClient>(
+              new utils::ShmRingClient(path, maxPacketSize)))
+    {
+    }
+};
+
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_SHMRINGTRANSPORT_H
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "jaegertracing/ShmRingTransport.h"
+#include "jaegertracing/Tracer.h"
+#include "jaegertracing/reporters/Config.h"
+#include "jaegertracing/testutils/MockAgent.h"
+#include "jaegertracing/testutils/TracerUtil.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace jaegertracing {
+namespace {
+
+std::shared_ptr<testutils::MockAgent> startAgent(const std::string& name)
+{
+    auto agent = testutils::MockAgent::make();
+    agent->listenRing("/tmp/jaeger-" + name + '-' +
+                      std::to_string(::getpid()) + ".sock");
+    agent->start();
+    return agent;
+}
+
+int waitForSpans(const testutils::MockAgent& agent, int numSpans)
+{
+    constexpr auto kNumTries = 100;
+    auto numReceived = 0;
+    for (auto i = 0; i < kNumTries && numReceived < numSpans; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        numReceived = 0;
+        for (auto&& batch : agent.batches()) {
+            numReceived += static_cast<int>(batch.spans.size());
+        }
+    }
+    return numReceived;
+}
+
+}  // anonymous namespace
+
+TEST(ShmRingTransport, testAgentReceivesSpans)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+    const auto agent = startAgent("ring");
+
+    // Small messages, so the spans take several laps of the ring.
+    ShmRingTransport sender(agent->spanServerRingPath(), 512);
+    constexpr auto kNumMessages = 5000;
+    for (auto i = 0; i < kNumMessages; ++i) {
+        const FinishedSpan span(
+            tracer, SpanContext(), "test" + std::to_string(i));
+        sender.append(span);
+        if (i % 100 == 0) {
+            sender.flush();
+        }
+    }
+    sender.flush();
+
+    ASSERT_EQ(kNumMessages, waitForSpans(*agent, kNumMessages));
+    const auto batches = agent->batches();
+    ASSERT_EQ(tracer->serviceName(), batches[0].process.serviceName);
+    ASSERT_EQ("test0", batches[0].spans.at(0).operationName);
+}
+
+TEST(ShmRingTransport, testConfig)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+    const auto agent = startAgent("ring-config");
+
+    const reporters::Config config(
+        0,
+        std::chrono::milliseconds(1),
+        false,
+        reporters::Config::kSharedMemoryPrefix + agent->spanServerRingPath());
+    ASSERT_EQ(agent->spanServerRingPath(), config.sharedMemorySocketPath());
+    ASSERT_EQ("", config.unixSocketPath());
+
+    const auto logger = logging::nullLogger();
+    const auto metrics = metrics::Metrics::makeNullMetrics();
+    const auto reporter =
+        config.makeReporter(tracer->serviceName(), *logger, *metrics);
+    reporter->report(
+        std::make_shared<const FinishedSpan>(tracer, SpanContext(), "test"));
+    reporter->close();
+
+    ASSERT_EQ(1, waitForSpans(*agent, 1));
+}
+
+}  // namespace jaegertracing
@@ -15,6 +15,7 @@
  */
 
 #include "jaegertracing/Span.h"
+#include "jaegertracing/ThriftCompactEncoder.h"
 #include "jaegertracing/Tracer.h"
 #include "jaegertracing/baggage/BaggageSetter.h"
 #include <cassert>
@@ -26,6 +27,18 @@
 namespace jaegertracing {
 namespace {
 
+// The span pool caches blocks for spans and finished spans, the latter
+// allocated after the control block of std::allocate_shared.
+static_assert(utils::taggedSize(sizeof(Span)) <=
+                  utils::MemoryResource::kMaxPoolBlockSize,
+              "span too large for the span pool");
+// The control block holds a vtable pointer, the reference counts and the
+// allocator.
+static_assert(sizeof(FinishedSpan) + 3 * sizeof(void*) +
+                      sizeof(utils::Allocator<FinishedSpan>) <=
+                  utils::MemoryResource::kMaxPoolBlockSize,
+              "finished span too large for the span pool");
+
 struct SamplingPriorityVisitor {
     using result_type = bool;
 
@@ -61,8 +74,51 @@ struct SamplingPriorityVisitor {
     }
 };
 
+// Cuts a string value longer than `maxLength` bytes. Returns true if it
+// did.
+bool truncateString(Tag& tag, int maxLength)
+{
+    if (maxLength <= 0) {
+        return false;
+    }
+    const auto& value = tag.value();
+    opentracing::string_view str;
+    if (value.is<std::string>()) {
+        str = value.get<std::string>();
+    }
+    else if (value.is<const char*>()) {
+        str = value.get<const char*>();
+    }
+    if (str.size() <= static_cast<std::size_t>(maxLength)) {
+        return false;
+    }
+    tag = Tag(tag.key(), std::string(str.data(), maxLength));
+    return true;
+}
+
 }  // anonymous namespace
 
+void Span::SetOperationName(opentracing::string_view name) noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (isFinished()) {
+        return;
+    }
+    if (_operation) {
+        // Keep the operation's static tags, now under another name. They
+        // now count against the span's own size.
+        auto& record = this->record();
+        for (auto&& tag : _operation->tags()) {
+            record._size += ThriftCompactEncoder::maxTagSize(tag);
+        }
+        record._tags.insert(std::begin(record._tags),
+                            std::begin(_operation->tags()),
+                            std::end(_operation->tags()));
+        _operation.reset();
+    }
+    _operationName = name;
+}
+
 void Span::SetBaggageItem(opentracing::string_view restrictedKey,
                           opentracing::string_view value) noexcept
 {
@@ -88,8 +144,8 @@ void Span::FinishWithOptions(
             ? SteadyClock::now()
             : finishSpanOptions.finish_steady_timestamp;
     std::shared_ptr<const Tracer> tracer;
+    std::shared_ptr<const FinishedSpan> finishedSpan;
     {
-
         std::lock_guard<std::mutex> lock(_mutex);
         if (isFinished()) {
             // Already finished, so return immediately.
@@ -104,14 +160,48 @@ void Span::FinishWithOptions(
 
         tracer = _tracer;
 
-        std::copy(finishSpanOptions.log_records.begin(),
-                  finishSpanOptions.log_records.end(),
-                  std::back_inserter(_logs));
+        if (_context.isSampled()) {
+            for (auto&& log : finishSpanOptions.log_records) {
+                logNoLocking(log.timestamp,
+                             std::begin(log.fields),
+                             std::end(log.fields));
+            }
+            if (_record && _record->_truncated) {
+                _record->_tags.push_back(Tag(kTruncatedTagKey, true));
+            }
+            const utils::Allocator<FinishedSpan> allocator(memoryResource());
+            if (_record) {
+                finishedSpan = std::allocate_shared<const FinishedSpan>(
+                    allocator,
+                    _tracer,
+                    _context,
+                    _operationName,
+                    _startTimeSystem,
+                    _duration,
+                    std::move(_record->_tags),
+                    std::move(_record->_logs),
+                    std::move(_references),
+                    _operation);
+            }
+            else {
+                finishedSpan = std::allocate_shared<const FinishedSpan>(
+                    allocator,
+                    _tracer,
+                    _context,
+                    _operationName,
+                    _startTimeSystem,
+                    _duration,
+                    FinishedSpan::TagList(),
+                    std::vector<LogRecord>(),
+                    std::move(_references),
+                    _operation);
+            }
+        }
     }
 
     // Call `reportSpan` even for non-sampled traces.
     if (tracer) {
-        tracer->reportSpan(*this);
+        tracer->reportSpan(std::move(finishedSpan));
     }
 }
 
@@ -140,6 +230,133 @@ std::string Span::serviceNameNoLock() const noexcept
     return _tracer->serviceName();
 }
 
+const std::shared_ptr<utils::MemoryResource>&
+Span::memoryResource() const noexcept
+{
+    if (!_tracer) {
+        static const auto heap =
+            utils::unownedResource(utils::MemoryResource::heap());
+        return heap;
+    }
+    return _tracer->memoryResource();
+}
+
+const SpanLimitsConfig& Span::spanLimits() const noexcept
+{
+    if (!_tracer) {
+        static const SpanLimitsConfig kDefaultLimits;
+        return kDefaultLimits;
+    }
+    return _tracer->spanLimits();
+}
+
+bool Span::admitTag(Tag& tag, std::size_t numTags) noexcept
+{
+    const auto& limits = spanLimits();
+    if (limits.maxTags() > 0 &&
+        numTags >= static_cast<std::size_t>(limits.maxTags())) {
+        countLimited(Limit::kTags, 1);
+        return false;
+    }
+    if (truncateString(tag, limits.maxStringLength())) {
+        countLimited(Limit::kStringLength, 1);
+    }
+    const auto size = ThriftCompactEncoder::maxTagSize(tag);
+    if (!fits(size)) {
+        countLimited(Limit::kBytes, 1);
+        return false;
+    }
+    _record->_size += size;
+    return true;
+}
+
+void Span::admitLastLog() noexcept
+{
+    const auto& limits = spanLimits();
+    auto& logs = _record->_logs;
+    for (auto&& field : logs.back().fields()) {
+        if (truncateString(field, limits.maxStringLength())) {
+            countLimited(Limit::kStringLength, 1);
+        }
+    }
+    const auto size = ThriftCompactEncoder::maxLogSize(logs.back());
+    if (!fits(size)) {
+        countLimited(Limit::kBytes, 1);
+        logs.pop_back();
+        return;
+    }
+    _record->_size += size;
+}
+
+void Span::limitInitialTags() noexcept
+{
+    auto& tags = _record->_tags;
+    auto numKept = static_cast<std::size_t>(0);
+    for (auto&& tag : tags) {
+        if (admitTag(tag, numKept)) {
+            if (&tag != &tags[numKept]) {
+                tags[numKept] = std::move(tag);
+            }
+            ++numKept;
+        }
+    }
+    while (tags.size() > numKept) {
+        tags.pop_back();
+    }
+}
+
+bool Span::fits(std::size_t size) const noexcept
+{
+    const auto maxBytes = spanLimits().maxSpanBytes();
+    if (maxBytes <= 0) {
+        return true;
+    }
+    // Room for the truncation marker is always kept.
+    static const auto kMarkerSize =
+        ThriftCompactEncoder::maxTagSize(Tag(kTruncatedTagKey, true));
+    auto total = ThriftCompactEncoder::kMaxSpanOverhead + kMarkerSize +
+                 _references.size() *
+                     ThriftCompactEncoder::kMaxReferenceSize +
+                 _record->_size + size;
+    if (_operation) {
+        total += _operation->name().size();
+        for (auto&& tag : _operation->tags()) {
+            total += ThriftCompactEncoder::maxTagSize(tag);
+        }
+    }
+    else {
+        total += _operationName.size();
+    }
+    return total <= static_cast<std::size_t>(maxBytes);
+}
+
+void Span::countLimited(Limit limit, int count) noexcept
+{
+    record()._truncated = true;
+    if (!_tracer) {
+        return;
+    }
+    auto& metrics = _tracer->metrics();
+    switch (limit) {
+    case Limit::kLogs: {
+        metrics.spanLimitedLogs().inc(count);
+    } break;
+    case Limit::kLogFields: {
+        metrics.spanLimitedLogFields().inc(count);
+    } break;
+    case Limit::kTags: {
+        metrics.spanLimitedTags().inc(count);
+    } break;
+    case Limit::kStringLength: {
+        metrics.spanLimitedStrings().inc(count);
+    } break;
+    default: {
+        assert(limit == Limit::kBytes);
+        metrics.spanLimitedBytes().inc(count);
+    } break;
+    }
+}
+
 void Span::setSamplingPriority(const opentracing::Value& value)
 {
     SamplingPriorityVisitor visitor;
@@ -155,12 +372,7 @@ void Span::setSamplingPriority(const opentracing::Value& value)
         newFlags &= ~static_cast<unsigned char>(SpanContext::Flag::kSampled);
     }
 
-    _context = SpanContext(_context.traceID(),
-                           _context.spanID(),
-                           _context.parentID(),
-                           newFlags,
-                           _context.baggage(),
-                           _context.debugID());
+    _context = _context.withFlags(newFlags);
 }
 
 }  // namespace jaegertracing
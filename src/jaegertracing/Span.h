@@ -18,16 +18,21 @@
 #define JAEGERTRACING_SPAN_H
 
 #include <chrono>
+#include <iterator>
 #include <memory>
 #include <mutex>
 
 #include <opentracing/span.h>
 
+#include "jaegertracing/FinishedSpan.h"
 #include "jaegertracing/LogRecord.h"
+#include "jaegertracing/Operation.h"
 #include "jaegertracing/Reference.h"
 #include "jaegertracing/SpanContext.h"
+#include "jaegertracing/SpanLimitsConfig.h"
 #include "jaegertracing/Tag.h"
 #include "jaegertracing/thrift-gen/jaeger_types.h"
+#include "jaegertracing/utils/MemoryResource.h"
 
 namespace jaegertracing {
 
@@ -37,6 +42,36 @@ class Span : public opentracing::Span {
   public:
     using SteadyClock = opentracing::SteadyClock;
     using SystemClock = opentracing::SystemClock;
+    using TagList = FinishedSpan::TagList;
+    using ReferenceList = FinishedSpan::ReferenceList;
+
+    // Spans started by a tracer come from its memory resource, as do their
+    // records and finished spans. Other spans use the heap. Each allocation
+    // holds a reference to its resource, so a span may outlive its tracer.
+    static void* operator new(std::size_t size)
+    {
+        return utils::allocateTagged(
+            size, utils::unownedResource(utils::MemoryResource::heap()));
+    }
+
+    static void*
+    operator new(std::size_t size,
+                 const std::shared_ptr<utils::MemoryResource>& resource)
+    {
+        return utils::allocateTagged(size, resource);
+    }
+
+    static void operator delete(void* ptr, std::size_t size) noexcept
+    {
+        utils::deallocateTagged(ptr, size);
+    }
+
+    static void
+    operator delete(void* ptr,
+                    const std::shared_ptr<utils::MemoryResource>&) noexcept
+    {
+        utils::deallocateTagged(ptr, sizeof(Span));
+    }
 
     explicit Span(
         const std::shared_ptr<const Tracer>& tracer = nullptr,
@@ -44,17 +79,43 @@ class Span : public opentracing::Span {
         const std::string& operationName = "",
         const SystemClock::time_point& startTimeSystem = SystemClock::now(),
         const SteadyClock::time_point& startTimeSteady = SteadyClock::now(),
-        const std::vector<Tag>& tags = {},
-        const std::vector<Reference>& references = {})
+        TagList tags = {},
+        ReferenceList references = {})
         : _tracer(tracer)
         , _context(context)
         , _operationName(operationName)
         , _startTimeSystem(startTimeSystem)
         , _startTimeSteady(startTimeSteady)
         , _duration()
-        , _tags(tags)
-        , _references(references)
+        , _references(std::move(references))
+        , _record(makeRecord(std::move(tags)))
     {
+        if (_record) {
+            limitInitialTags();
+        }
+    }
+
+    // Starts a span of a registered operation. Its name and static tags are
+    // shared with `operation`, not copied.
+    Span(const std::shared_ptr<const Tracer>& tracer,
+         const SpanContext& context,
+         const OperationHandle& operation,
+         const SystemClock::time_point& startTimeSystem,
+         const SteadyClock::time_point& startTimeSteady,
+         TagList tags,
+         ReferenceList references)
+        : _tracer(tracer)
+        , _context(context)
+        , _operation(operation)
+        , _startTimeSystem(startTimeSystem)
+        , _startTimeSteady(startTimeSteady)
+        , _duration()
+        , _references(std::move(references))
+        , _record(makeRecord(std::move(tags)))
+    {
+        if (_record) {
+            limitInitialTags();
+        }
     }
 
     Span(const Span& span)
@@ -66,12 +127,14 @@ class Span : public opentracing::Span {
         _tracer = span._tracer;
         _context = span._context;
         _operationName = span._operationName;
+        _operation = span._operation;
         _startTimeSystem = span._startTimeSystem;
         _startTimeSteady = span._startTimeSteady;
         _duration = span._duration;
-        _tags = span._tags;
-        _logs = span._logs;
         _references = span._references;
+        if (span._record) {
+            _record.reset(new (memoryResource()) Record(*span._record));
+        }
     }
 
     // Pass-by-value intentional to implement copy-and-swap.
@@ -94,12 +157,12 @@ class Span : public opentracing::Span {
         swap(_tracer, span._tracer);
         swap(_context, span._context);
         swap(_operationName, span._operationName);
+        swap(_operation, span._operation);
         swap(_startTimeSystem, span._startTimeSystem);
         swap(_startTimeSteady, span._startTimeSteady);
         swap(_duration, span._duration);
-        swap(_tags, span._tags);
-        swap(_logs, span._logs);
         swap(_references, span._references);
+        swap(_record, span._record);
     }
 
     friend void swap(Span& lhs, Span& rhs) { lhs.swap(rhs); }
@@ -107,47 +170,28 @@ class Span : public opentracing::Span {
     thrift::Span thrift() const
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        thrift::Span span;
-        span.__set_traceIdHigh(_context.traceID().high());
-        span.__set_traceIdLow(_context.traceID().low());
-        span.__set_spanId(_context.spanID());
-        span.__set_parentSpanId(_context.parentID());
-        span.__set_operationName(_operationName);
-
-        std::vector<thrift::SpanRef> refs;
-        refs.reserve(_references.size());
-        std::transform(std::begin(_references),
-                       std::end(_references),
-                       std::back_inserter(refs),
-                       [](const Reference& ref) { return ref.thrift(); });
-        span.__set_references(refs);
-
-        span.__set_flags(_context.flags());
-        span.__set_startTime(
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                _startTimeSystem.time_since_epoch())
-                .count());
-        span.__set_duration(
-            std::chrono::duration_cast<std::chrono::microseconds>(_duration)
-                .count());
-
-        std::vector<thrift::Tag> tags;
-        tags.reserve(_tags.size());
-        std::transform(std::begin(_tags),
-                       std::end(_tags),
-                       std::back_inserter(tags),
-                       [](const Tag& tag) { return tag.thrift(); });
-        span.__set_tags(tags);
-
-        std::vector<thrift::Log> logs;
-        logs.reserve(_logs.size());
-        std::transform(std::begin(_logs),
-                       std::end(_logs),
-                       std::back_inserter(logs),
-                       [](const LogRecord& log) { return log.thrift(); });
-        span.__set_logs(logs);
-
-        return span;
+        if (!_record) {
+            return FinishedSpan(_tracer,
+                                _context,
+                                _operationName,
+                                _startTimeSystem,
+                                _duration,
+                                {},
+                                {},
+                                _references,
+                                _operation)
+                .thrift();
+        }
+        return FinishedSpan(_tracer,
+                            _context,
+                            _operationName,
+                            _startTimeSystem,
+                            _duration,
+                            _record->_tags,
+                            _record->_logs,
+                            _references,
+                            _operation)
+            .thrift();
     }
 
     template <typename Stream>
@@ -160,7 +204,7 @@ class Span : public opentracing::Span {
     std::string operationName() const
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        return _operationName;
+        return _operation ? _operation->name() : _operationName;
     }
 
     SystemClock::time_point startTimeSystem() const
@@ -181,10 +225,17 @@ class Span : public opentracing::Span {
         return _duration;
     }
 
+    // Tags are moved into the FinishedSpan handed to the reporter, so this
+    // returns nothing once a sampled span has finished. Does not include
+    // the static tags of a registered operation.
     std::vector<Tag> tags() const
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        return _tags;
+        if (!_record) {
+            return std::vector<Tag>();
+        }
+        return std::vector<Tag>(std::begin(_record->_tags),
+                                std::end(_record->_tags));
     }
 
     template <typename... Arg>
@@ -196,14 +247,7 @@ class Span : public opentracing::Span {
     void FinishWithOptions(const opentracing::FinishSpanOptions&
                                finishSpanOptions) noexcept override;
 
-    void SetOperationName(opentracing::string_view name) noexcept override
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (isFinished()) {
-            return;
-        }
-        _operationName = name;
-    }
+    void SetOperationName(opentracing::string_view name) noexcept override;
 
     void SetTag(opentracing::string_view key,
                 const opentracing::Value& value) noexcept override
@@ -216,7 +260,11 @@ class Span : public opentracing::Span {
         if (isFinished() || !_context.isSampled()) {
             return;
         }
-        _tags.push_back(Tag(key, value));
+        auto& tags = record()._tags;
+        Tag tag(key, value);
+        if (admitTag(tag, tags.size())) {
+            tags.push_back(std::move(tag));
+        }
     }
 
     void SetBaggageItem(opentracing::string_view restrictedKey,
@@ -226,9 +274,8 @@ class Span : public opentracing::Span {
         noexcept override
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        auto itr = _context.baggage().find(restrictedKey);
-        return (itr == std::end(_context.baggage())) ? std::string()
-                                                     : itr->second;
+        const auto* value = _context.baggage().find(restrictedKey);
+        return value ? *value : std::string();
     }
 
     void Log(std::initializer_list<
@@ -236,19 +283,10 @@ class Span : public opentracing::Span {
                  fieldPairs) noexcept override
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        if (!_context.isSampled()) {
+        if (isFinished() || !_context.isSampled()) {
             return;
         }
-
-        std::vector<Tag> fields;
-        fields.reserve(fieldPairs.size());
-        std::transform(
-            std::begin(fieldPairs),
-            std::end(fieldPairs),
-            std::back_inserter(fields),
-            [](const std::pair<opentracing::string_view, opentracing::Value>&
-                   pair) { return Tag(pair.first, pair.second); });
-        logFieldsNoLocking(std::begin(fields), std::end(fields));
+        logFieldsNoLocking(std::begin(fieldPairs), std::end(fieldPairs));
     }
 
     const SpanContext& context() const noexcept override
@@ -265,27 +303,140 @@ class Span : public opentracing::Span {
 
     std::string serviceNameNoLock() const noexcept;
 
+    // The tracer's memory resource, or the heap for spans without one.
+    const std::shared_ptr<utils::MemoryResource>&
+    memoryResource() const noexcept;
+
   private:
+    struct Record {
+        static void*
+        operator new(std::size_t size,
+                     const std::shared_ptr<utils::MemoryResource>& resource)
+        {
+            return utils::allocateTagged(size, resource);
+        }
+
+        static void operator delete(void* ptr, std::size_t size) noexcept
+        {
+            utils::deallocateTagged(ptr, size);
+        }
+
+        static void
+        operator delete(void* ptr,
+                        const std::shared_ptr<utils::MemoryResource>&) noexcept
+        {
+            utils::deallocateTagged(ptr, sizeof(Record));
+        }
+
+        explicit Record(TagList tags)
+            : _tags(std::move(tags))
+            , _logs()
+            , _size(0)
+            , _truncated(false)
+        {
+        }
+
+        TagList _tags;
+        std::vector<LogRecord> _logs;
+        // Upper bound on the encoded size of _tags and _logs.
+        std::size_t _size;
+        // Set once a span limit cut or dropped anything.
+        bool _truncated;
+    };
+
+    static_assert(utils::taggedSize(sizeof(Record)) <=
+                      utils::MemoryResource::kMaxPoolBlockSize,
+                  "span record too large for the span pool");
+
+    enum class Limit { kLogs, kLogFields, kTags, kStringLength, kBytes };
+
+    std::unique_ptr<Record> makeRecord(TagList tags) const
+    {
+        if (tags.empty()) {
+            return nullptr;
+        }
+        return std::unique_ptr<Record>(new (memoryResource())
+                                           Record(std::move(tags)));
+    }
+
+    Record& record()
+    {
+        if (!_record) {
+            _record.reset(new (memoryResource()) Record(TagList()));
+        }
+        return *_record;
+    }
+
     bool isFinished() const { return _duration != SteadyClock::duration(); }
 
     template <typename FieldIterator>
     void logFieldsNoLocking(FieldIterator first, FieldIterator last) noexcept
     {
-        LogRecord log(SystemClock::now(), first, last);
-        _logs.push_back(log);
+        logNoLocking(SystemClock::now(), first, last);
+    }
+
+    // Appends a log, building its tags straight from the fields, unless the
+    // span is at its log limit. Fields past the field limit are cut.
+    template <typename FieldIterator>
+    void logNoLocking(const SystemClock::time_point& timestamp,
+                      FieldIterator first,
+                      FieldIterator last) noexcept
+    {
+        const auto& limits = spanLimits();
+        auto& logs = record()._logs;
+        if (limits.maxLogs() > 0 &&
+            logs.size() >= static_cast<std::size_t>(limits.maxLogs())) {
+            countLimited(Limit::kLogs, 1);
+            return;
+        }
+        const auto numFields = std::distance(first, last);
+        if (limits.maxLogFields() > 0 && numFields > limits.maxLogFields()) {
+            countLimited(Limit::kLogFields,
+                         static_cast<int>(numFields - limits.maxLogFields()));
+            last = first;
+            std::advance(last, limits.maxLogFields());
+        }
+        logs.emplace_back(timestamp, first, last);
+        admitLastLog();
     }
 
+    // Limits of the tracer, or the defaults for spans without one.
+    const SpanLimitsConfig& spanLimits() const noexcept;
+
+    // Cuts long string values in `tag` and returns whether it fits after
+    // `numTags` tags within the span limits, counting its size if it does.
+    // Needs the record.
+    bool admitTag(Tag& tag, std::size_t numTags) noexcept;
+
+    // Same for the log just appended, which is removed if it does not fit.
+    // Needs the record.
+    void admitLastLog() noexcept;
+
+    // Applies the tag limits to the tags the span started with.
+    void limitInitialTags() noexcept;
+
+    // Whether `size` more bytes keep the encoded span within its limit.
+    bool fits(std::size_t size) const noexcept;
+
+    // Marks the span truncated and counts `count` against `limit`.
+    void countLimited(Limit limit, int count) noexcept;
+
     void setSamplingPriority(const opentracing::Value& value);
 
     std::shared_ptr<const Tracer> _tracer;
     SpanContext _context;
     std::string _operationName;
+    // Set for spans of a registered operation, until renamed.
+    OperationHandle _operation;
     SystemClock::time_point _startTimeSystem;
     SteadyClock::time_point _startTimeSteady;
     SteadyClock::duration _duration;
-    std::vector<Tag> _tags;
-    std::vector<LogRecord> _logs;
-    std::vector<Reference> _references;
+    // Kept for every span, as setting the sampling priority can make a span
+    // sampled after it started.
+    ReferenceList _references;
+    // Everything that is only reported, allocated once there is any of
+    // it. Spans that are not sampled never allocate one.
+    std::unique_ptr<Record> _record;
     mutable std::mutex _mutex;
 };
 
@@ -17,22 +17,25 @@
 #ifndef JAEGERTRACING_SPANCONTEXT_H
 #define JAEGERTRACING_SPANCONTEXT_H
 
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <memory>
-#include <mutex>
 #include <string>
-#include <unordered_map>
 
 #include <opentracing/span.h>
 
+#include "jaegertracing/Baggage.h"
 #include "jaegertracing/TraceID.h"
 
 namespace jaegertracing {
 
+// Immutable apart from assignment. Copies share the baggage, so copying a
+// context or deriving one with different baggage or flags does not copy
+// the baggage items, and reading it needs no lock.
 class SpanContext : public opentracing::SpanContext {
   public:
-    using StrMap = std::unordered_map<std::string, std::string>;
+    using StrMap = Baggage::StrMap;
 
     enum class Flag : unsigned char { kSampled = 1, kDebug = 2 };
 
@@ -43,7 +46,8 @@ class SpanContext : public opentracing::SpanContext {
         , _spanID(0)
         , _parentID(0)
         , _flags(0)
-        , _mutex()
+        , _baggage()
+        , _debugID()
     {
     }
 
@@ -51,7 +55,7 @@ class SpanContext : public opentracing::SpanContext {
                 uint64_t spanID,
                 uint64_t parentID,
                 unsigned char flags,
-                const StrMap& baggage,
+                const Baggage& baggage,
                 const std::string& debugID = "")
         : _traceID(traceID)
         , _spanID(spanID)
@@ -59,26 +63,9 @@ class SpanContext : public opentracing::SpanContext {
         , _flags(flags)
         , _baggage(baggage)
         , _debugID(debugID)
-        , _mutex()
     {
     }
 
-    SpanContext(const SpanContext& ctx)
-        : _traceID(ctx._traceID)
-        , _spanID(ctx._spanID)
-        , _parentID(ctx._parentID)
-        , _flags(ctx._flags)
-        , _baggage(ctx._baggage)
-        , _debugID(ctx._debugID)
-    {
-    }
-
-    SpanContext& operator=(SpanContext rhs)
-    {
-        swap(rhs);
-        return *this;
-    }
-
     void swap(SpanContext& ctx)
     {
         using std::swap;
@@ -98,35 +85,24 @@ class SpanContext : public opentracing::SpanContext {
 
     uint64_t parentID() const { return _parentID; }
 
-    const StrMap& baggage() const { return _baggage; }
+    const Baggage& baggage() const { return _baggage; }
 
-    SpanContext withBaggage(const StrMap& baggage) const
+    SpanContext withBaggage(const Baggage& baggage) const
     {
-        std::lock_guard<std::mutex> lock(_mutex);
         return SpanContext(
             _traceID, _spanID, _parentID, _flags, baggage, _debugID);
     }
 
-    template <typename Function>
-    void forEachBaggageItem(Function f) const
+    SpanContext withFlags(unsigned char flags) const
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        for (auto&& pair : _baggage) {
-            if (!f(pair.first, pair.second)) {
-                break;
-            }
-        }
+        return SpanContext(
+            _traceID, _spanID, _parentID, flags, _baggage, _debugID);
     }
 
     template <typename Function>
-    void forEachBaggageItem(Function f)
+    void forEachBaggageItem(Function f) const
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        for (auto&& pair : _baggage) {
-            if (!f(pair.first, pair.second)) {
-                break;
-            }
-        }
+        _baggage.forEach(f);
     }
 
     unsigned char flags() const { return _flags; }
@@ -167,24 +143,15 @@ class SpanContext : public opentracing::SpanContext {
 
     std::unique_ptr<opentracing::SpanContext> Clone() const noexcept
     {
-        std::lock_guard<std::mutex> lock(_mutex);
         return std::unique_ptr<opentracing::SpanContext>(
             new SpanContext(*this));
     }
 
     friend bool operator==(const SpanContext& lhs, const SpanContext& rhs)
     {
-        {
-            std::lock(lhs._mutex, rhs._mutex);
-            std::lock_guard<std::mutex> lhsLock(lhs._mutex, std::adopt_lock);
-            std::lock_guard<std::mutex> rhsLock(rhs._mutex, std::adopt_lock);
-            if (lhs._baggage != rhs._baggage) {
-                return false;
-            }
-        }
         return lhs._traceID == rhs._traceID && lhs._spanID == rhs._spanID &&
                lhs._parentID == rhs._parentID && lhs._flags == rhs._flags &&
-               lhs._debugID == rhs._debugID;
+               lhs._debugID == rhs._debugID && lhs._baggage == rhs._baggage;
     }
 
     friend bool operator!=(const SpanContext& lhs, const SpanContext& rhs)
@@ -197,9 +164,8 @@ class SpanContext : public opentracing::SpanContext {
     uint64_t _spanID;
     uint64_t _parentID;
     unsigned char _flags;
-    StrMap _baggage;
+    Baggage _baggage;
     std::string _debugID;
-    mutable std::mutex _mutex;  // Protects _baggage.
 };
 
 }  // namespace jaegertracing
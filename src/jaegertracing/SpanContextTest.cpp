@@ -107,6 +107,30 @@ TEST(SpanContext, testBaggage)
     }
 }
 
+TEST(SpanContext, testSharedBaggage)
+{
+    const SpanContext parent(
+        TraceID(1, 2), 3, 0, 0, { { "key1", "value1" }, { "key2", "value2" } });
+    const SpanContext child(TraceID(1, 2), 4, 3, 0, parent.baggage());
+    // Copies share the items rather than copying them.
+    ASSERT_EQ(parent.baggage().find("key1"), child.baggage().find("key1"));
+
+    auto baggage = child.baggage();
+    baggage.set("key1", "changed");
+    baggage.set("key3", "value3");
+    const auto updated = child.withBaggage(baggage);
+    ASSERT_EQ(3U, updated.baggage().size());
+    ASSERT_EQ("changed", *updated.baggage().find("key1"));
+    ASSERT_EQ("value2", *updated.baggage().find("key2"));
+    ASSERT_EQ(2U, child.baggage().size());
+    ASSERT_EQ("value1", *child.baggage().find("key1"));
+    ASSERT_EQ(nullptr, child.baggage().find("key3"));
+
+    ASSERT_EQ(parent.baggage(), child.baggage());
+    ASSERT_NE(parent.baggage(), updated.baggage());
+    ASSERT_EQ(updated.baggage(), Baggage(updated.baggage().toMap()));
+}
+
 TEST(SpanContext, testDebug)
 {
     const SpanContext spanContext;
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_SPANLIMITSCONFIG_H
+#define JAEGERTRACING_SPANLIMITSCONFIG_H
+
+#include "jaegertracing/Constants.h"
+#include "jaegertracing/utils/YAML.h"
+
+namespace jaegertracing {
+
+// Bounds on what a single span keeps, enforced as tags and logs are
+// recorded so memory per span is predictable. Logs past maxLogs() and tags
+// past maxTags() are dropped, fields past maxLogFields() are cut from their
+// log, string values are cut to maxStringLength() bytes, and tags and logs
+// that would take the encoded span past maxSpanBytes() are dropped. Spans
+// that lost anything carry a "jaeger.truncated" tag, and the tracer's
+// metrics count each reason. Zero means no limit.
+class SpanLimitsConfig {
+  public:
+    // No limit: the UDP transport splits spans too large for one packet
+    // into continuations, so logs are not dropped for their size.
+    static constexpr auto kDefaultMaxLogs = 0;
+    static constexpr auto kDefaultMaxLogFields = 128;
+    static constexpr auto kDefaultMaxTags = 128;
+    static constexpr auto kDefaultMaxStringLength = 4096;
+    // No limit, see kDefaultMaxLogs.
+    static constexpr auto kDefaultMaxSpanBytes = 0;
+
+#ifdef JAEGERTRACING_WITH_YAML_CPP
+
+    static SpanLimitsConfig parse(const YAML::Node& configYAML)
+    {
+        if (!configYAML.IsDefined() || !configYAML.IsMap()) {
+            return SpanLimitsConfig();
+        }
+
+        const auto maxLogs = utils::yaml::findOrDefault<int>(
+            configYAML, "maxLogs", kDefaultMaxLogs);
+        const auto maxLogFields = utils::yaml::findOrDefault<int>(
+            configYAML, "maxLogFields", kDefaultMaxLogFields);
+        const auto maxTags = utils::yaml::findOrDefault<int>(
+            configYAML, "maxTags", kDefaultMaxTags);
+        const auto maxStringLength = utils::yaml::findOrDefault<int>(
+            configYAML, "maxStringLength", kDefaultMaxStringLength);
+        const auto maxSpanBytes = utils::yaml::findOrDefault<int>(
+            configYAML, "maxSpanBytes", kDefaultMaxSpanBytes);
+        return SpanLimitsConfig(
+            maxLogs, maxLogFields, maxTags, maxStringLength, maxSpanBytes);
+    }
+
+#endif  // JAEGERTRACING_WITH_YAML_CPP
+
+    explicit SpanLimitsConfig(
+        int maxLogs = kDefaultMaxLogs,
+        int maxLogFields = kDefaultMaxLogFields,
+        int maxTags = kDefaultMaxTags,
+        int maxStringLength = kDefaultMaxStringLength,
+        int maxSpanBytes = kDefaultMaxSpanBytes)
+        : _maxLogs(maxLogs)
+        , _maxLogFields(maxLogFields)
+        , _maxTags(maxTags)
+        , _maxStringLength(maxStringLength)
+        , _maxSpanBytes(maxSpanBytes)
+    {
+    }
+
+    int maxLogs() const { return _maxLogs; }
+
+    int maxLogFields() const { return _maxLogFields; }
+
+    int maxTags() const { return _maxTags; }
+
+    int maxStringLength() const { return _maxStringLength; }
+
+    int maxSpanBytes() const { return _maxSpanBytes; }
+
+  private:
+    int _maxLogs;
+    int _maxLogFields;
+    int _maxTags;
+    int _maxStringLength;
+    int _maxSpanBytes;
+};
+
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_SPANLIMITSCONFIG_H
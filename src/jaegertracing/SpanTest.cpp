@@ -15,6 +15,7 @@
  */
 
 #include "jaegertracing/Span.h"
+#include "jaegertracing/utils/MemoryResource.h"
 #include <gtest/gtest.h>
 #include <string>
 
@@ -28,4 +29,59 @@ TEST(Span, testThriftConversion)
     ASSERT_NO_THROW(span.thrift());
 }
 
+TEST(Span, testCompactLayout)
+{
+    // Beyond its context, lock, name and references, a span holds little
+    // more than pointers and time points; tags and logs live elsewhere.
+    const auto overhead = sizeof(Span) - sizeof(SpanContext) -
+                          sizeof(std::mutex) - sizeof(std::string) -
+                          sizeof(Span::ReferenceList);
+    ASSERT_LE(overhead, 10 * sizeof(void*));
+}
+
+TEST(Span, testAllocations)
+{
+    // Spans without a tracer allocate from the heap resource, which counts
+    // what they take.
+    const auto numAllocations = []() {
+        return utils::MemoryResource::heap().stats()._allocations;
+    };
+    const auto now = Span::SteadyClock::now();
+    const auto systemNow = Span::SystemClock::now();
+    const SpanContext notSampled(TraceID(1, 2), 3, 0, 0, {});
+    const SpanContext sampled(
+        TraceID(1, 2),
+        4,
+        3,
+        static_cast<unsigned char>(SpanContext::Flag::kSampled),
+        {});
+
+    {
+        const auto before = numAllocations();
+        Span span(nullptr, notSampled, "op", systemNow, now);
+        span.SetTag("key", 1);
+        ASSERT_EQ(before, numAllocations());
+    }
+
+    {
+        Span::TagList tags;
+        for (auto i = 0; i < 8; ++i) {
+            tags.push_back(Tag("key" + std::to_string(i), i));
+        }
+        Span::ReferenceList references{ Reference(
+            notSampled, Reference::Type::ChildOfRef) };
+        const auto before = numAllocations();
+        Span span(nullptr,
+                  sampled,
+                  "op",
+                  systemNow,
+                  now,
+                  std::move(tags),
+                  std::move(references));
+        // One record holds the tags inline, the span the reference.
+        ASSERT_EQ(before + 1, numAllocations());
+        ASSERT_EQ(8U, span.tags().size());
+    }
+}
+
 }  // namespace jaegertracing
@@ -15,3 +15,149 @@
  */
 
 #include "jaegertracing/Tag.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace jaegertracing {
+namespace {
+
+// Open addressing table of interned keys. Slots are only ever filled, never
+// cleared, so lookups can probe without the lock.
+class InternTable {
+  public:
+    InternTable()
+        : _slots()
+        , _size(0)
+        , _mutex()
+    {
+        for (auto&& slot : _slots) {
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+        for (auto key : { "jaeger.version",
+                          "hostname",
+                          "ip",
+                          "sampler.type",
+                          "sampler.param",
+                          "jaeger.truncated",
+                          "jaeger.continuation",
+                          "span.kind",
+                          "component",
+                          "error",
+                          "http.url",
+                          "http.method",
+                          "http.status_code",
+                          "peer.service",
+                          "peer.hostname",
+                          "peer.ipv4",
+                          "peer.ipv6",
+                          "peer.port",
+                          "db.instance",
+                          "db.statement",
+                          "db.type",
+                          "db.user",
+                          "message_bus.destination",
+                          "event",
+                          "message",
+                          "error.kind",
+                          "error.object",
+                          "stack",
+                          "key",
+                          "value",
+                          "override",
+                          "truncated",
+                          "invalid" }) {
+            intern(key);
+        }
+    }
+
+    const std::string* find(opentracing::string_view key) const
+    {
+        for (auto i = hash(key);; ++i) {
+            const auto* interned =
+                _slots[i & kMask].load(std::memory_order_acquire);
+            if (!interned) {
+                return nullptr;
+            }
+            if (equals(*interned, key)) {
+                return interned;
+            }
+        }
+    }
+
+    const std::string* intern(opentracing::string_view key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto i = hash(key);; ++i) {
+            auto& slot = _slots[i & kMask];
+            const auto* interned = slot.load(std::memory_order_relaxed);
+            if (!interned) {
+                if (_size == TagKey::kMaxInterned) {
+                    return nullptr;
+                }
+                interned = new std::string(key.data(), key.size());
+                slot.store(interned, std::memory_order_release);
+                ++_size;
+                return interned;
+            }
+            if (equals(*interned, key)) {
+                return interned;
+            }
+        }
+    }
+
+  private:
+    // Twice the maximum number of keys, so probe sequences stay short and
+    // always end at an empty slot.
+    static constexpr auto kNumSlots = 2 * TagKey::kMaxInterned;
+    static constexpr auto kMask = static_cast<std::size_t>(kNumSlots - 1);
+
+    static_assert((kNumSlots & (kNumSlots - 1)) == 0,
+                  "Number of slots must be a power of two");
+
+    // FNV-1a.
+    static std::size_t hash(opentracing::string_view key)
+    {
+        auto result = static_cast<uint64_t>(14695981039346656037ULL);
+        for (auto i = static_cast<std::size_t>(0); i < key.size(); ++i) {
+            result = (result ^ static_cast<unsigned char>(key[i])) *
+                     1099511628211ULL;
+        }
+        return static_cast<std::size_t>(result);
+    }
+
+    static bool equals(const std::string& lhs, opentracing::string_view rhs)
+    {
+        return lhs.size() == rhs.size() &&
+               std::memcmp(lhs.data(), rhs.data(), rhs.size()) == 0;
+    }
+
+    std::array<std::atomic<const std::string*>, kNumSlots> _slots;
+    int _size;
+    std::mutex _mutex;
+};
+
+InternTable& internTable()
+{
+    // Leaked so tags destroyed during static destruction stay valid.
+    static auto* table = new InternTable();
+    return *table;
+}
+
+}  // anonymous namespace
+
+constexpr int TagKey::kMaxInterned;
+
+const std::string* TagKey::intern(opentracing::string_view key)
+{
+    return internTable().intern(key);
+}
+
+const std::string* TagKey::find(opentracing::string_view key)
+{
+    return internTable().find(key);
+}
+
+}  // namespace jaegertracing
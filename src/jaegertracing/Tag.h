@@ -24,22 +24,79 @@
 #include <opentracing/value.h>
 #include <opentracing/variant/variant.hpp>
 #include <string>
+#include <utility>
 
 namespace jaegertracing {
 
+// Key of a Tag. Interned keys refer to a single shared copy, so making and
+// copying tags with them does not allocate. Other keys are owned. Well-known
+// keys (sampler, OpenTracing standard tags and log fields) are interned
+// up front; applications can intern their own with intern().
+class TagKey {
+  public:
+    static constexpr auto kMaxInterned = 512;
+
+    // Returns the shared copy of `key`, adding it to the intern table if
+    // needed. Returns null once the table holds kMaxInterned keys. Interned
+    // keys are never freed.
+    static const std::string* intern(opentracing::string_view key);
+
+    // Returns the shared copy of `key`, or null if it is not interned.
+    // Lock-free.
+    static const std::string* find(opentracing::string_view key);
+
+    TagKey(const char* key)
+        : TagKey(opentracing::string_view(key))
+    {
+    }
+
+    TagKey(const std::string& key)
+        : _interned(find(key))
+        , _owned(_interned ? std::string() : key)
+    {
+    }
+
+    TagKey(std::string&& key)
+        : _interned(find(key))
+        , _owned(_interned ? std::string() : std::move(key))
+    {
+    }
+
+    TagKey(opentracing::string_view key)
+        : _interned(find(key))
+        , _owned(_interned ? std::string() : std::string(key))
+    {
+    }
+
+    bool interned() const { return _interned != nullptr; }
+
+    const std::string& str() const { return _interned ? *_interned : _owned; }
+
+    bool operator==(const TagKey& rhs) const
+    {
+        return (_interned && _interned == rhs._interned) || str() == rhs.str();
+    }
+
+  private:
+    const std::string* _interned;
+    std::string _owned;
+};
+
 class Tag {
   public:
     using ValueType = opentracing::Value;
 
+    // `const char*` values are kept as pointers, not copied, so they must
+    // outlive the tag (e.g. string literals).
     template <typename ValueArg>
-    Tag(const std::string& key, ValueArg&& value)
-        : _key(key)
+    Tag(TagKey key, ValueArg&& value)
+        : _key(std::move(key))
         , _value(std::forward<ValueArg>(value))
     {
     }
 
-    template <typename ValueArg>
-    Tag(const std::pair<std::string,ValueArg> & tag_pair)
+    template <typename KeyArg, typename ValueArg>
+    Tag(const std::pair<KeyArg, ValueArg>& tag_pair)
         : _key(tag_pair.first)
         , _value(tag_pair.second)
     {
@@ -50,14 +107,16 @@ class Tag {
         return _key == rhs._key && _value == rhs._value;
     }
 
-    const std::string& key() const { return _key; }
+    const std::string& key() const { return _key.str(); }
+
+    bool hasInternedKey() const { return _key.interned(); }
 
     const ValueType& value() const { return _value; }
 
     thrift::Tag thrift() const
     {
         thrift::Tag tag;
-        tag.__set_key(_key);
+        tag.__set_key(_key.str());
         ThriftVisitor visitor(tag);
         opentracing::util::apply_visitor(visitor, _value);
         return tag;
@@ -115,7 +174,7 @@ class Tag {
         thrift::Tag& _tag;
     };
 
-    std::string _key;
+    TagKey _key;
     ValueType _value;
 };
 
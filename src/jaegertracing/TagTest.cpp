@@ -17,6 +17,8 @@
 #include "jaegertracing/Tag.h"
 #include <gtest/gtest.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace jaegertracing {
 
@@ -35,4 +37,54 @@ TEST(Tag, testThriftConversion)
     }
 }
 
+TEST(Tag, testWellKnownKeysAreInterned)
+{
+    const Tag tag("sampler.type", "const");
+    ASSERT_TRUE(tag.hasInternedKey());
+    ASSERT_EQ("sampler.type", tag.key());
+    ASSERT_EQ(TagKey::find("sampler.type"), &tag.key());
+
+    const Tag copy(tag);
+    ASSERT_EQ(&tag.key(), &copy.key());
+
+    const Tag other(std::string("testKey"), "value");
+    ASSERT_FALSE(other.hasInternedKey());
+    ASSERT_EQ("testKey", other.key());
+    ASSERT_EQ(nullptr, TagKey::find("testKey"));
+}
+
+TEST(Tag, testIntern)
+{
+    const auto* interned = TagKey::intern("testInternKey");
+    ASSERT_NE(nullptr, interned);
+    ASSERT_EQ("testInternKey", *interned);
+    ASSERT_EQ(interned, TagKey::intern("testInternKey"));
+    ASSERT_EQ(interned, TagKey::find(std::string("testInternKey")));
+
+    const Tag tag(opentracing::string_view("testInternKey"), 1.0);
+    ASSERT_TRUE(tag.hasInternedKey());
+    ASSERT_EQ(interned, &tag.key());
+    ASSERT_EQ(Tag("testInternKey", 1.0), tag);
+}
+
+TEST(Tag, testConcurrentIntern)
+{
+    constexpr auto kNumThreads = 4;
+    constexpr auto kNumKeys = 64;
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([]() {
+            for (auto j = 0; j < kNumKeys; ++j) {
+                const auto key = "testConcurrentKey" + std::to_string(j);
+                const auto* interned = TagKey::intern(key);
+                ASSERT_NE(nullptr, interned);
+                ASSERT_EQ(interned, TagKey::find(key));
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+}
+
 }  // namespace jaegertracing
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/ThriftCompactEncoder.h"
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace jaegertracing {
+namespace {
+
+// Type codes from the compact protocol specification.
+enum CompactType {
+    kBooleanTrue = 1,
+    kBooleanFalse = 2,
+    kI32 = 5,
+    kI64 = 6,
+    kDouble = 7,
+    kBinary = 8,
+    kList = 9,
+    kStruct = 12
+};
+
+constexpr auto kProtocolID = static_cast<char>(0x82);
+// Version 1 in the low bits, T_ONEWAY (4) in the high three bits.
+constexpr auto kOnewayVersion = static_cast<char>((4 << 5) | 1);
+constexpr auto kEmitBatchName = "emitBatch";
+
+int64_t toMicroseconds(const std::chrono::system_clock::time_point& time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               time.time_since_epoch())
+        .count();
+}
+
+// Mirrors Tag::ThriftVisitor so value types map to the same Thrift fields.
+// Leaves `type` untouched for values Tag::thrift() does not encode.
+class TagTypeVisitor {
+  public:
+    using result_type = void;
+
+    explicit TagTypeVisitor(int& type)
+        : _type(type)
+    {
+    }
+
+    void operator()(const std::string&) const
+    {
+        _type = thrift::TagType::STRING;
+    }
+
+    void operator()(const char*) const { _type = thrift::TagType::STRING; }
+
+    void operator()(double) const { _type = thrift::TagType::DOUBLE; }
+
+    void operator()(bool) const { _type = thrift::TagType::BOOL; }
+
+    void operator()(int64_t) const { _type = thrift::TagType::LONG; }
+
+    void operator()(uint64_t) const { _type = thrift::TagType::LONG; }
+
+    template <typename Arg>
+    void operator()(Arg&&) const
+    {
+        // No-op
+    }
+
+  private:
+    int& _type;
+};
+
+// Upper bound on the encoded size of a tag value, including its field
+// header.
+class ValueSizeVisitor {
+  public:
+    using result_type = std::size_t;
+
+    std::size_t operator()(const std::string& value) const
+    {
+        return 6 + value.size();
+    }
+
+    std::size_t operator()(const char* value) const
+    {
+        return 6 + std::strlen(value);
+    }
+
+    std::size_t operator()(double) const { return 9; }
+
+    std::size_t operator()(bool) const { return 1; }
+
+    std::size_t operator()(int64_t) const { return 11; }
+
+    std::size_t operator()(uint64_t) const { return 11; }
+
+    template <typename Arg>
+    std::size_t operator()(Arg&&) const
+    {
+        return 0;
+    }
+};
+
+}  // anonymous namespace
+
+constexpr int ThriftCompactEncoder::kMaxSpanOverhead;
+constexpr int ThriftCompactEncoder::kMaxReferenceSize;
+constexpr int ThriftCompactEncoder::kMaxLogOverhead;
+
+std::size_t ThriftCompactEncoder::maxTagSize(const Tag& tag)
+{
+    // Key and type fields and the stop byte.
+    return 13 + tag.key().size() +
+           opentracing::util::apply_visitor(ValueSizeVisitor(), tag.value());
+}
+
+std::size_t ThriftCompactEncoder::maxLogSize(const LogRecord& log)
+{
+    auto size = static_cast<std::size_t>(kMaxLogOverhead);
+    for (auto&& field : log.fields()) {
+        size += maxTagSize(field);
+    }
+    return size;
+}
+
+void ThriftCompactEncoder::writeEmitBatchPrefix(
+    const std::string& serviceName, const std::vector<Tag>& processTags)
+{
+    _buffer.push_back(kProtocolID);
+    _buffer.push_back(kOnewayVersion);
+    writeVarint(0);  // Sequence ID, always zero for Agent clients.
+    writeString(kEmitBatchName, std::strlen(kEmitBatchName));
+
+    // Agent_emitBatch_pargs
+    auto argsLastID = static_cast<int16_t>(0);
+    writeFieldHeader(kStruct, 1, argsLastID);
+
+    // Batch
+    auto batchLastID = static_cast<int16_t>(0);
+    writeFieldHeader(kStruct, 1, batchLastID);
+    {
+        // Process
+        auto lastID = static_cast<int16_t>(0);
+        writeFieldHeader(kBinary, 1, lastID);
+        writeString(serviceName);
+        writeFieldHeader(kList, 2, lastID);
+        writeListHeader(processTags.size());
+        for (auto&& tag : processTags) {
+            writeTag(tag);
+        }
+        writeStop();
+    }
+    writeFieldHeader(kList, 2, batchLastID);
+}
+
+void ThriftCompactEncoder::writeListHeader(int size)
+{
+    if (size <= 14) {
+        _buffer.push_back(static_cast<char>((size << 4) | kStruct));
+    }
+    else {
+        _buffer.push_back(static_cast<char>(0xf0 | kStruct));
+        writeVarint(static_cast<uint32_t>(size));
+    }
+}
+
+void ThriftCompactEncoder::writeSpan(const FinishedSpan& span)
+{
+    const auto& context = span.context();
+    auto lastID = static_cast<int16_t>(0);
+    writeFieldHeader(kI64, 1, lastID);
+    writeI64(context.traceID().low());
+    writeFieldHeader(kI64, 2, lastID);
+    writeI64(context.traceID().high());
+    writeFieldHeader(kI64, 3, lastID);
+    writeI64(context.spanID());
+    writeFieldHeader(kI64, 4, lastID);
+    writeI64(context.parentID());
+    writeFieldHeader(kBinary, 5, lastID);
+    writeString(span.operationName());
+
+    writeFieldHeader(kList, 6, lastID);
+    writeListHeader(span.references().size());
+    for (auto&& reference : span.references()) {
+        writeReference(reference);
+    }
+
+    writeFieldHeader(kI32, 7, lastID);
+    writeI32(context.flags());
+    writeFieldHeader(kI64, 8, lastID);
+    writeI64(toMicroseconds(span.startTimeSystem()));
+    writeFieldHeader(kI64, 9, lastID);
+    writeI64(std::chrono::duration_cast<std::chrono::microseconds>(
+                 span.duration())
+                 .count());
+
+    writeFieldHeader(kList, 10, lastID);
+    writeListHeader(span.operationTags().size() + span.tags().size());
+    for (auto&& tag : span.operationTags()) {
+        writeTag(tag);
+    }
+    for (auto&& tag : span.tags()) {
+        writeTag(tag);
+    }
+
+    writeFieldHeader(kList, 11, lastID);
+    writeListHeader(span.logs().size());
+    for (auto&& log : span.logs()) {
+        writeLog(log);
+    }
+
+    writeStop();
+}
+
+void ThriftCompactEncoder::writeEmitBatchSuffix()
+{
+    writeStop();  // Batch
+    writeStop();  // Agent_emitBatch_pargs
+}
+
+void ThriftCompactEncoder::writeFieldHeader(int type,
+                                            int16_t id,
+                                            int16_t& lastID)
+{
+    const auto delta = id - lastID;
+    if (delta > 0 && delta <= 15) {
+        _buffer.push_back(static_cast<char>((delta << 4) | type));
+    }
+    else {
+        _buffer.push_back(static_cast<char>(type));
+        writeI32(id);
+    }
+    lastID = id;
+}
+
+void ThriftCompactEncoder::writeVarint(uint64_t value)
+{
+    while (value >= 0x80) {
+        _buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    _buffer.push_back(static_cast<char>(value));
+}
+
+void ThriftCompactEncoder::writeDouble(double value)
+{
+    static_assert(sizeof(double) == sizeof(uint64_t),
+                  "double must be 64 bits");
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // Compact protocol stores doubles little-endian.
+    for (auto i = 0; i < 8; ++i) {
+        _buffer.push_back(static_cast<char>(bits & 0xff));
+        bits >>= 8;
+    }
+}
+
+void ThriftCompactEncoder::writeString(const char* data, std::size_t size)
+{
+    writeVarint(static_cast<uint32_t>(size));
+    _buffer.append(data, size);
+}
+
+void ThriftCompactEncoder::writeTag(const Tag& tag)
+{
+    auto lastID = static_cast<int16_t>(0);
+    writeFieldHeader(kBinary, 1, lastID);
+    writeString(tag.key());
+
+    const auto& value = tag.value();
+    auto type = -1;
+    opentracing::util::apply_visitor(TagTypeVisitor(type), value);
+    // thrift::Tag defaults vType to STRING and omits the value field.
+    writeFieldHeader(kI32, 2, lastID);
+    writeI32(type < 0 ? thrift::TagType::STRING : type);
+
+    switch (type) {
+    case thrift::TagType::STRING: {
+        writeFieldHeader(kBinary, 3, lastID);
+        if (value.is<std::string>()) {
+            writeString(value.get<std::string>());
+        }
+        else {
+            const auto str = value.get<const char*>();
+            writeString(str, std::strlen(str));
+        }
+    } break;
+    case thrift::TagType::DOUBLE: {
+        writeFieldHeader(kDouble, 4, lastID);
+        writeDouble(value.get<double>());
+    } break;
+    case thrift::TagType::BOOL: {
+        // Compact protocol folds bool values into the field type.
+        writeFieldHeader(
+            value.get<bool>() ? kBooleanTrue : kBooleanFalse, 5, lastID);
+    } break;
+    case thrift::TagType::LONG: {
+        writeFieldHeader(kI64, 6, lastID);
+        writeI64(value.is<int64_t>()
+                     ? value.get<int64_t>()
+                     : static_cast<int64_t>(value.get<uint64_t>()));
+    } break;
+    default:
+        break;
+    }
+
+    writeStop();
+}
+
+void ThriftCompactEncoder::writeLog(const LogRecord& log)
+{
+    auto lastID = static_cast<int16_t>(0);
+    writeFieldHeader(kI64, 1, lastID);
+    writeI64(toMicroseconds(log.timestamp()));
+    writeFieldHeader(kList, 2, lastID);
+    writeListHeader(log.fields().size());
+    for (auto&& field : log.fields()) {
+        writeTag(field);
+    }
+    writeStop();
+}
+
+void ThriftCompactEncoder::writeReference(const Reference& reference)
+{
+    auto refType = static_cast<int32_t>(thrift::SpanRefType::CHILD_OF);
+    switch (reference.type()) {
+    case Reference::Type::ChildOfRef: {
+        refType = thrift::SpanRefType::CHILD_OF;
+    } break;
+    case Reference::Type::FollowsFromRef: {
+        refType = thrift::SpanRefType::FOLLOWS_FROM;
+    } break;
+    default: {
+        std::ostringstream oss;
+        oss << "Invalid span reference type "
+            << static_cast<int>(reference.type()) << ", context "
+            << reference.spanContext();
+        throw std::invalid_argument(oss.str());
+    } break;
+    }
+
+    const auto& context = reference.spanContext();
+    auto lastID = static_cast<int16_t>(0);
+    writeFieldHeader(kI32, 1, lastID);
+    writeI32(refType);
+    writeFieldHeader(kI64, 2, lastID);
+    writeI64(context.traceID().low());
+    writeFieldHeader(kI64, 3, lastID);
+    writeI64(context.traceID().high());
+    writeFieldHeader(kI64, 4, lastID);
+    writeI64(context.spanID());
+    writeStop();
+}
+
+}  // namespace jaegertracing
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_THRIFTCOMPACTENCODER_H
+#define JAEGERTRACING_THRIFTCOMPACTENCODER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "jaegertracing/FinishedSpan.h"
+#include "jaegertracing/LogRecord.h"
+#include "jaegertracing/Reference.h"
+#include "jaegertracing/Tag.h"
+
+namespace jaegertracing {
+
+// Writes Thrift compact protocol bytes for Jaeger types straight from the
+// tracer's own representation, without building intermediate thrift::
+// structs. The output is byte-for-byte what the generated Thrift code
+// produces for the equivalent thrift:: values.
+//
+// An Agent.emitBatch message is written in three parts so the span list
+// can be built incrementally:
+//   writeEmitBatchPrefix, writeListHeader, writeSpan..., writeEmitBatchSuffix
+class ThriftCompactEncoder {
+  public:
+    // Largest possible encoding of a list header.
+    static constexpr auto kMaxListHeaderSize = 6;
+
+    // Size of the bytes written by writeEmitBatchSuffix.
+    static constexpr auto kEmitBatchSuffixSize = 2;
+
+    // Upper bounds on the encoded size of a span, not counting its
+    // operation name, references, tags and logs, and of one reference.
+    static constexpr auto kMaxSpanOverhead = 100;
+    static constexpr auto kMaxReferenceSize = 40;
+
+    // Upper bound on the encoded size of a log without its fields.
+    static constexpr auto kMaxLogOverhead = 19;
+
+    // Upper bounds on the encoded size of a tag and of a log, so limits on
+    // span size can be checked without encoding.
+    static std::size_t maxTagSize(const Tag& tag);
+
+    static std::size_t maxLogSize(const LogRecord& log);
+
+    // Appends to `buffer`.
+    explicit ThriftCompactEncoder(std::string& buffer)
+        : _buffer(buffer)
+    {
+    }
+
+    // Writes the message header, the process and the span list field
+    // header of an Agent.emitBatch call.
+    void writeEmitBatchPrefix(const std::string& serviceName,
+                              const std::vector<Tag>& processTags);
+
+    // Writes the header of a list of `size` structs.
+    void writeListHeader(int size);
+
+    void writeSpan(const FinishedSpan& span);
+
+    // Closes the batch and argument structs opened by writeEmitBatchPrefix.
+    void writeEmitBatchSuffix();
+
+  private:
+    void writeFieldHeader(int type, int16_t id, int16_t& lastID);
+
+    void writeStop() { _buffer.push_back(0); }
+
+    void writeVarint(uint64_t value);
+
+    // Zigzag encoding, as in TCompactProtocol.
+    void writeI32(int32_t value)
+    {
+        writeVarint((static_cast<uint32_t>(value) << 1) ^
+                    static_cast<uint32_t>(value >> 31));
+    }
+
+    void writeI64(int64_t value)
+    {
+        writeVarint((static_cast<uint64_t>(value) << 1) ^
+                    static_cast<uint64_t>(value >> 63));
+    }
+
+    void writeDouble(double value);
+
+    void writeString(const char* data, std::size_t size);
+
+    void writeString(const std::string& value)
+    {
+        writeString(value.data(), value.size());
+    }
+
+    void writeTag(const Tag& tag);
+
+    void writeLog(const LogRecord& log);
+
+    void writeReference(const Reference& reference);
+
+    std::string& _buffer;
+};
+
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_THRIFTCOMPACTENCODER_H
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/ThriftCompactEncoder.h"
+#include "jaegertracing/thrift-gen/Agent.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thrift/protocol/TCompactProtocol.h>
+#include <thrift/transport/TBufferTransports.h>
+#include <vector>
+
+namespace jaegertracing {
+namespace {
+
+std::vector<Tag> makeTags()
+{
+    return { { "testBool", true },
+             { "testFalse", false },
+             { "testDouble", 1.5 },
+             { "testInt64", -42LL },
+             { "testUint64", 1ULL << 40 },
+             { "testStr", std::string{ "test" } },
+             { "testNull", nullptr },
+             { "testCStr", "test" } };
+}
+
+std::vector<thrift::Tag> toThrift(const std::vector<Tag>& tags)
+{
+    std::vector<thrift::Tag> thriftTags;
+    std::transform(std::begin(tags),
+                   std::end(tags),
+                   std::back_inserter(thriftTags),
+                   [](const Tag& tag) { return tag.thrift(); });
+    return thriftTags;
+}
+
+std::unique_ptr<FinishedSpan> makeSpan(const std::string& operationName)
+{
+    const SpanContext parent(TraceID(1, 2), 3, 0, 1, {});
+    const SpanContext context(TraceID(1, 2), 4, 3, 1, {});
+    std::vector<LogRecord> logs;
+    const auto fields = makeTags();
+    logs.emplace_back(
+        LogRecord::Clock::now(), std::begin(fields), std::end(fields));
+    return std::unique_ptr<FinishedSpan>(new FinishedSpan(
+        nullptr,
+        context,
+        operationName,
+        FinishedSpan::SystemClock::now(),
+        std::chrono::microseconds(1234),
+        makeTags(),
+        std::move(logs),
+        { Reference(parent, Reference::Type::ChildOfRef),
+          Reference(parent, Reference::Type::FollowsFromRef) }));
+}
+
+}  // anonymous namespace
+
+TEST(ThriftCompactEncoder, testSameBytesAsThrift)
+{
+    constexpr auto kServiceName = "test-service";
+    const auto processTags = makeTags();
+    // More than 14 spans to exercise the long list header form.
+    constexpr auto kNumSpans = 20;
+    std::vector<std::unique_ptr<FinishedSpan>> spans;
+    for (auto i = 0; i < kNumSpans; ++i) {
+        spans.push_back(makeSpan("span-" + std::to_string(i)));
+    }
+
+    std::string encoded;
+    ThriftCompactEncoder encoder(encoded);
+    encoder.writeEmitBatchPrefix(kServiceName, processTags);
+    encoder.writeListHeader(static_cast<int>(spans.size()));
+    for (auto&& span : spans) {
+        encoder.writeSpan(*span);
+    }
+    encoder.writeEmitBatchSuffix();
+
+    thrift::Batch batch;
+    batch.process.__set_serviceName(kServiceName);
+    batch.process.__set_tags(toThrift(processTags));
+    for (auto&& span : spans) {
+        batch.spans.push_back(span->thrift());
+    }
+    std::shared_ptr<apache::thrift::transport::TMemoryBuffer> buffer(
+        new apache::thrift::transport::TMemoryBuffer());
+    apache::thrift::protocol::TCompactProtocolFactory factory;
+    agent::thrift::AgentClient client(factory.getProtocol(buffer));
+    client.emitBatch(batch);
+
+    ASSERT_EQ(buffer->getBufferAsString(), encoded);
+}
+
+TEST(ThriftCompactEncoder, testMaxSizes)
+{
+    const auto span = makeSpan("span");
+    std::string encoded;
+    ThriftCompactEncoder(encoded).writeSpan(*span);
+
+    auto maxSize = ThriftCompactEncoder::kMaxSpanOverhead +
+                   span->operationName().size() +
+                   span->references().size() *
+                       ThriftCompactEncoder::kMaxReferenceSize;
+    for (auto&& tag : span->tags()) {
+        maxSize += ThriftCompactEncoder::maxTagSize(tag);
+    }
+    for (auto&& log : span->logs()) {
+        maxSize += ThriftCompactEncoder::maxLogSize(log);
+    }
+    ASSERT_LE(encoded.size(), maxSize);
+}
+
+}  // namespace jaegertracing
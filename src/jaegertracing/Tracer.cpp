@@ -18,8 +18,8 @@
 #include "jaegertracing/Reference.h"
 #include "jaegertracing/TraceID.h"
 #include "jaegertracing/samplers/SamplingStatus.h"
+#include "jaegertracing/utils/MemoryResource.h"
 #include <algorithm>
-#include <cassert>
 #include <chrono>
 #include <iterator>
 #include <opentracing/util.h>
@@ -54,21 +54,26 @@ TimePoints determineStartTimes(const opentracing::StartSpanOptions& options)
 
 }  // anonymous namespace
 
-using StrMap = SpanContext::StrMap;
-
 constexpr int Tracer::kGen128BitOption;
+constexpr int Tracer::kSpanPoolOption;
 
 std::unique_ptr<opentracing::Span>
 Tracer::StartSpanWithOptions(string_view operationName,
                              const opentracing::StartSpanOptions& options) const
     noexcept
+{
+    return startSpanForOperation(operationName, nullptr, options);
+}
+
+std::unique_ptr<Span> Tracer::startSpanForOperation(
+    string_view operationName,
+    const OperationHandle& operation,
+    const opentracing::StartSpanOptions& options) const noexcept
 {
     try {
-        const auto result = analyzeReferences(options.references);
-        const auto* parent = result._parent;
-        const auto& references = result._references;
+        const auto* parent = findParent(options.references);
 
-        std::vector<Tag> samplerTags;
+        samplers::SamplingStatus::Tags samplerTags;
         auto newTrace = false;
         SpanContext ctx;
         if (!parent || !parent->isValid()) {
@@ -88,39 +93,47 @@ Tracer::StartSpanWithOptions(string_view operationName,
             }
             else {
                 const auto samplingStatus =
-                    _sampler->isSampled(traceID, operationName);
+                    operation
+                        ? _sampler->isOperationSampled(traceID, *operation)
+                        : _sampler->isSampled(traceID, operationName);
                 if (samplingStatus.isSampled()) {
                     flags |=
                         static_cast<unsigned char>(SpanContext::Flag::kSampled);
-                    samplerTags = samplingStatus.tags();
+                    samplerTags = samplingStatus.sharedTags();
                 }
             }
-            ctx = SpanContext(traceID, spanID, parentID, flags, StrMap());
+            // A parent that only carries baggage, e.g. one extracted from
+            // the baggage header alone, still passes it on.
+            ctx = SpanContext(traceID,
+                              spanID,
+                              parentID,
+                              flags,
+                              parent ? parent->baggage() : Baggage());
         }
         else {
+            // The child shares the parent's baggage.
             const auto traceID = parent->traceID();
             const auto spanID = randomID();
             const auto parentID = parent->spanID();
             const auto flags = parent->flags();
-            ctx = SpanContext(traceID, spanID, parentID, flags, StrMap());
-        }
-
-        if (parent && !parent->baggage().empty()) {
-            ctx = ctx.withBaggage(parent->baggage());
+            ctx = SpanContext(
+                traceID, spanID, parentID, flags, parent->baggage());
         }
 
         SystemClock::time_point startTimeSystem;
         SteadyClock::time_point startTimeSteady;
         std::tie(startTimeSystem, startTimeSteady) =
             determineStartTimes(options);
+        static const std::vector<Tag> kNoTags;
         return startSpanInternal(ctx,
                                  operationName,
+                                 operation,
                                  startTimeSystem,
                                  startTimeSteady,
-                                 samplerTags,
+                                 samplerTags ? *samplerTags : kNoTags,
                                  options.tags,
                                  newTrace,
-                                 references);
+                                 options.references);
     } catch (...) {
         utils::ErrorUtil::logError(
             *_logger, "Error occurred in Tracer::StartSpanWithOptions");
@@ -130,34 +143,67 @@ Tracer::StartSpanWithOptions(string_view operationName,
 
 std::unique_ptr<Span>
 Tracer::startSpanInternal(const SpanContext& context,
-                          const std::string& operationName,
+                          string_view operationName,
+                          const OperationHandle& operation,
                           const SystemClock::time_point& startTimeSystem,
                           const SteadyClock::time_point& startTimeSteady,
                           const std::vector<Tag>& internalTags,
                           const std::vector<OpenTracingTag>& tags,
                           bool newTrace,
-                          const std::vector<Reference>& references) const
+                          const std::vector<OpenTracingRef>& references) const
 {
-    std::vector<Tag> spanTags;
-    spanTags.reserve(tags.size() + internalTags.size());
-    std::transform(
-        std::begin(tags),
-        std::end(tags),
-        std::back_inserter(spanTags),
-        [](const OpenTracingTag& tag) { return Tag(tag.first, tag.second); });
-    spanTags.insert(
-        std::end(spanTags), std::begin(internalTags), std::end(internalTags));
-
-    std::unique_ptr<Span> span(new Span(shared_from_this(),
-                                        context,
-                                        operationName,
-                                        startTimeSystem,
-                                        startTimeSteady,
-                                        spanTags,
-                                        references));
+    // Tags are only reported, so a span that is not sampled starts without
+    // them. References are kept, since the span may become sampled later.
+    FinishedSpan::TagList spanTags;
+    if (context.isSampled()) {
+        // Internal tags go first so the span's tag limit never drops them.
+        spanTags.reserve(tags.size() + internalTags.size());
+        spanTags.append(std::begin(internalTags), std::end(internalTags));
+        std::transform(std::begin(tags),
+                       std::end(tags),
+                       std::back_inserter(spanTags),
+                       [](const OpenTracingTag& tag) {
+                           return Tag(tag.first, tag.second);
+                       });
+    }
+    auto spanReferences = collectReferences(references);
+
+    // Only the size class of spans is measured. Records and finished spans
+    // come from other classes of the same pool.
+    if (_memoryResource.get() == &utils::MemoryResource::pool()) {
+        const auto poolSize =
+            utils::MemoryResource::poolSize(utils::taggedSize(sizeof(Span)));
+        _metrics->spanPoolSize().update(poolSize);
+        if (poolSize > 0) {
+            _metrics->spanPoolHits().inc(1);
+        }
+        else {
+            _metrics->spanPoolMisses().inc(1);
+        }
+    }
+
+    std::unique_ptr<Span> span;
+    if (operation) {
+        span.reset(new (_memoryResource) Span(shared_from_this(),
+                                              context,
+                                              operation,
+                                              startTimeSystem,
+                                              startTimeSteady,
+                                              std::move(spanTags),
+                                              std::move(spanReferences)));
+    }
+    else {
+        span.reset(new (_memoryResource) Span(shared_from_this(),
+                                              context,
+                                              operationName,
+                                              startTimeSystem,
+                                              startTimeSteady,
+                                              std::move(spanTags),
+                                              std::move(spanReferences)));
+    }
 
     _metrics->spansStarted().inc(1);
-    if (span->context().isSampled()) {
+    if (span->contextNoLock().isSampled()) {
         _metrics->spansSampled().inc(1);
         if (newTrace) {
             _metrics->tracesStartedSampled().inc(1);
@@ -173,27 +219,31 @@ Tracer::startSpanInternal(const SpanContext& context,
     return span;
 }
 
-Tracer::AnalyzedReferences
-Tracer::analyzeReferences(const std::vector<OpenTracingRef>& references) const
+const SpanContext* Tracer::toSpanContext(const OpenTracingRef& ref)
+{
+    const auto* ctx = dynamic_cast<const SpanContext*>(ref.second);
+    if (!ctx || (!ctx->isValid() && !ctx->isDebugIDContainerOnly() &&
+                 ctx->baggage().empty())) {
+        return nullptr;
+    }
+    return ctx;
+}
+
+const SpanContext*
+Tracer::findParent(const std::vector<OpenTracingRef>& references) const
 {
-    AnalyzedReferences result;
     auto hasParent = false;
-    const auto* parent = result._parent;
+    const SpanContext* parent = nullptr;
     for (auto&& ref : references) {
-        const auto* ctx = dynamic_cast<const SpanContext*>(ref.second);
-
+        const auto* ctx = toSpanContext(ref);
         if (!ctx) {
-            _logger->error("Reference contains invalid type of SpanReference");
-            continue;
-        }
-
-        if (!ctx->isValid() && !ctx->isDebugIDContainerOnly() &&
-            ctx->baggage().empty()) {
+            if (!dynamic_cast<const SpanContext*>(ref.second)) {
+                _logger->error(
+                    "Reference contains invalid type of SpanReference");
+            }
             continue;
         }
 
-        result._references.emplace_back(Reference(*ctx, ref.first));
-
         if (!hasParent) {
             parent = ctx;
             hasParent =
@@ -206,11 +256,19 @@ Tracer::analyzeReferences(const std::vector<OpenTracingRef>& references) const
         hasParent = true;
     }
 
-    if (hasParent) {
-        assert(parent);
-        result._parent = parent;
-    }
+    return hasParent ? parent : nullptr;
+}
 
+FinishedSpan::ReferenceList
+Tracer::collectReferences(const std::vector<OpenTracingRef>& references)
+{
+    FinishedSpan::ReferenceList result;
+    for (auto&& ref : references) {
+        const auto* ctx = toSpanContext(ref);
+        if (ctx) {
+            result.emplace_back(Reference(*ctx, ref.first));
+        }
+    }
     return result;
 }
 
@@ -19,7 +19,6 @@
 
 #include <chrono>
 #include <memory>
-#include <random>
 #include <vector>
 
 #include <opentracing/noop.h>
@@ -27,8 +26,12 @@
 
 #include "jaegertracing/Config.h"
 #include "jaegertracing/Constants.h"
+#include "jaegertracing/FinishedSpan.h"
+#include "jaegertracing/IDGenerator.h"
 #include "jaegertracing/Logging.h"
+#include "jaegertracing/Operation.h"
 #include "jaegertracing/Span.h"
+#include "jaegertracing/SpanLimitsConfig.h"
 #include "jaegertracing/Tag.h"
 #include "jaegertracing/baggage/BaggageSetter.h"
 #include "jaegertracing/baggage/RestrictionManager.h"
@@ -40,6 +43,7 @@
 #include "jaegertracing/reporters/Reporter.h"
 #include "jaegertracing/samplers/Sampler.h"
 #include "jaegertracing/utils/ErrorUtil.h"
+#include "jaegertracing/utils/MemoryResource.h"
 
 namespace jaegertracing {
 
@@ -51,6 +55,10 @@ class Tracer : public opentracing::Tracer,
     using string_view = opentracing::string_view;
 
     static constexpr auto kGen128BitOption = 1;
+    // Reuse the memory of finished spans for new ones, per thread. Suits
+    // services that start spans at a high rate on long-lived threads.
+    // Ignored if the config provides a memory resource.
+    static constexpr auto kSpanPoolOption = 2;
 
     static std::shared_ptr<opentracing::Tracer>
     make(const std::string& serviceName, const Config& config)
@@ -84,6 +92,22 @@ class Tracer : public opentracing::Tracer,
          const std::shared_ptr<logging::Logger>& logger,
          metrics::StatsFactory& statsFactory,
          int options)
+    {
+        return make(serviceName,
+                    config,
+                    logger,
+                    statsFactory,
+                    options,
+                    std::make_shared<RandomIDGenerator>());
+    }
+
+    static std::shared_ptr<opentracing::Tracer>
+    make(const std::string& serviceName,
+         const Config& config,
+         const std::shared_ptr<logging::Logger>& logger,
+         metrics::StatsFactory& statsFactory,
+         int options,
+         const std::shared_ptr<IDGenerator>& idGenerator)
     {
         if (serviceName.empty()) {
             throw std::invalid_argument("no service name provided");
@@ -93,6 +117,10 @@ class Tracer : public opentracing::Tracer,
             return opentracing::MakeNoopTracer();
         }
 
+        if (!idGenerator) {
+            throw std::invalid_argument("no ID generator provided");
+        }
+
         auto metrics = std::make_shared<metrics::Metrics>(statsFactory);
         std::shared_ptr<samplers::Sampler> sampler(
             config.sampler().makeSampler(serviceName, *logger, *metrics));
@@ -104,7 +132,10 @@ class Tracer : public opentracing::Tracer,
                                                   logger,
                                                   metrics,
                                                   config.headers(),
-                                                  options));
+                                                  options,
+                                                  idGenerator,
+                                                  config.memoryResource(),
+                                                  config.spanLimits()));
     }
 
     ~Tracer() { Close(); }
@@ -114,6 +145,40 @@ class Tracer : public opentracing::Tracer,
                          const opentracing::StartSpanOptions& options) const
         noexcept override;
 
+    // Registers an operation once, so spans of it can be started without
+    // copying its name or `tags`, or hashing the name for the sampler.
+    OperationHandle registerOperation(const std::string& operationName,
+                                      std::vector<Tag> tags = {}) const
+    {
+        return std::make_shared<const Operation>(operationName,
+                                                 std::move(tags));
+    }
+
+    std::unique_ptr<Span>
+    startSpan(const OperationHandle& operation,
+              std::initializer_list<
+                  opentracing::option_wrapper<opentracing::StartSpanOption>>
+                  optionList = {}) const noexcept
+    {
+        opentracing::StartSpanOptions options;
+        for (auto&& option : optionList) {
+            option.get().Apply(options);
+        }
+        return startSpanWithOptions(operation, options);
+    }
+
+    std::unique_ptr<Span>
+    startSpanWithOptions(const OperationHandle& operation,
+                         const opentracing::StartSpanOptions& options) const
+        noexcept
+    {
+        if (!operation) {
+            _logger->error("Cannot start span of null operation");
+            return nullptr;
+        }
+        return startSpanForOperation(operation->name(), operation, options);
+    }
+
     opentracing::expected<void> Inject(const opentracing::SpanContext& ctx,
                                        std::ostream& writer) const override
     {
@@ -203,16 +268,39 @@ class Tracer : public opentracing::Tracer,
 
     const std::vector<Tag>& tags() const { return _tags; }
 
+    // Spans, the records holding their tags and logs, and finished spans on
+    // their way to the reporter are allocated from this resource. The
+    // vectors of logs and the strings in tags still use the global heap.
+    const std::shared_ptr<utils::MemoryResource>& memoryResource() const
+    {
+        return _memoryResource;
+    }
+
+    // Nonzero ID from the tracer's ID generator.
+    uint64_t randomID() const
+    {
+        auto value = _idGenerator->generate();
+        while (value == 0) {
+            value = _idGenerator->generate();
+        }
+        return value;
+    }
+
+    const SpanLimitsConfig& spanLimits() const { return _spanLimits; }
+
+    metrics::Metrics& metrics() const { return *_metrics; }
+
     const baggage::BaggageSetter& baggageSetter() const
     {
         return _baggageSetter;
     }
 
-    void reportSpan(const Span& span) const
+    // `span` is null if the span was not sampled.
+    void reportSpan(std::shared_ptr<const FinishedSpan> span) const
     {
         _metrics->spansFinished().inc(1);
-        if (span.context().isSampled()) {
-            _reporter->report(span);
+        if (span && span->context().isSampled()) {
+            _reporter->report(std::move(span));
         }
     }
 
@@ -223,14 +311,17 @@ class Tracer : public opentracing::Tracer,
            const std::shared_ptr<logging::Logger>& logger,
            const std::shared_ptr<metrics::Metrics>& metrics,
            const propagation::HeadersConfig& headersConfig,
-           int options)
+           int options,
+           const std::shared_ptr<IDGenerator>& idGenerator,
+           const std::shared_ptr<utils::MemoryResource>& memoryResource,
+           const SpanLimitsConfig& spanLimits)
         : _serviceName(serviceName)
         , _hostIPv4(net::IPAddress::localIP(AF_INET))
         , _sampler(sampler)
         , _reporter(reporter)
         , _metrics(metrics)
         , _logger(logger)
-        , _randomNumberGenerator()
+        , _idGenerator(idGenerator)
         , _textPropagator(headersConfig, _metrics)
         , _httpHeaderPropagator(headersConfig, _metrics)
         , _binaryPropagator(_metrics)
@@ -238,6 +329,13 @@ class Tracer : public opentracing::Tracer,
         , _restrictionManager(new baggage::DefaultRestrictionManager(0))
         , _baggageSetter(*_restrictionManager, *_metrics)
         , _options(options)
+        , _memoryResource(memoryResource
+                              ? memoryResource
+                              : utils::unownedResource(
+                                    (options & kSpanPoolOption)
+                                        ? utils::MemoryResource::pool()
+                                        : utils::MemoryResource::heap()))
+        , _spanLimits(spanLimits)
     {
         _tags.push_back(Tag(kJaegerClientVersionTagKey, kJaegerClientVersion));
 
@@ -253,49 +351,41 @@ class Tracer : public opentracing::Tracer,
         else {
             _tags.push_back(Tag(kTracerIPTagKey, _hostIPv4.host()));
         }
-
-        std::random_device device;
-        _randomNumberGenerator.seed(device());
-    }
-
-    uint64_t randomID() const
-    {
-        std::lock_guard<std::mutex> lock(_randomMutex);
-        auto value = _randomNumberGenerator();
-        while (value == 0) {
-            value = _randomNumberGenerator();
-        }
-        return value;
     }
 
     using OpenTracingTag = std::pair<std::string, opentracing::Value>;
 
+    using OpenTracingRef = std::pair<opentracing::SpanReferenceType,
+                                     const opentracing::SpanContext*>;
+
+    // `operation` is null for spans started by name.
+    std::unique_ptr<Span>
+    startSpanForOperation(string_view operationName,
+                          const OperationHandle& operation,
+                          const opentracing::StartSpanOptions& options) const
+        noexcept;
+
     std::unique_ptr<Span>
     startSpanInternal(const SpanContext& context,
-                      const std::string& operationName,
+                      string_view operationName,
+                      const OperationHandle& operation,
                       const SystemClock::time_point& startTimeSystem,
                       const SteadyClock::time_point& startTimeSteady,
                       const std::vector<Tag>& internalTags,
                       const std::vector<OpenTracingTag>& tags,
                       bool newTrace,
-                      const std::vector<Reference>& references) const;
-
-    using OpenTracingRef = std::pair<opentracing::SpanReferenceType,
-                                     const opentracing::SpanContext*>;
+                      const std::vector<OpenTracingRef>& references) const;
 
-    struct AnalyzedReferences {
-        AnalyzedReferences()
-            : _parent(nullptr)
-            , _references()
-        {
-        }
+    // Returns the referenced context, or null if the reference is ignored.
+    static const SpanContext* toSpanContext(const OpenTracingRef& ref);
 
-        const SpanContext* _parent;
-        std::vector<Reference> _references;
-    };
+    // Returns the context the new span continues, if any. Does not copy
+    // the references, which only sampled spans need.
+    const SpanContext*
+    findParent(const std::vector<OpenTracingRef>& references) const;
 
-    AnalyzedReferences
-    analyzeReferences(const std::vector<OpenTracingRef>& references) const;
+    static FinishedSpan::ReferenceList
+    collectReferences(const std::vector<OpenTracingRef>& references);
 
     std::string _serviceName;
     net::IPAddress _hostIPv4;
@@ -303,8 +393,7 @@ class Tracer : public opentracing::Tracer,
     std::shared_ptr<reporters::Reporter> _reporter;
     std::shared_ptr<metrics::Metrics> _metrics;
     std::shared_ptr<logging::Logger> _logger;
-    mutable std::mt19937_64 _randomNumberGenerator;
-    mutable std::mutex _randomMutex;
+    std::shared_ptr<IDGenerator> _idGenerator;
     propagation::TextMapPropagator _textPropagator;
     propagation::HTTPHeaderPropagator _httpHeaderPropagator;
     propagation::BinaryPropagator _binaryPropagator;
@@ -312,6 +401,8 @@ class Tracer : public opentracing::Tracer,
     std::unique_ptr<baggage::RestrictionManager> _restrictionManager;
     baggage::BaggageSetter _baggageSetter;
     int _options;
+    std::shared_ptr<utils::MemoryResource> _memoryResource;
+    SpanLimitsConfig _spanLimits;
 };
 
 }  // namespace jaegertracing
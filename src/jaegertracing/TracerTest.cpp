@@ -17,17 +17,23 @@
 #include "jaegertracing/Tracer.h"
 #include "jaegertracing/Config.h"
 #include "jaegertracing/Constants.h"
+#include "jaegertracing/IDGenerator.h"
 #include "jaegertracing/Span.h"
 #include "jaegertracing/SpanContext.h"
+#include "jaegertracing/SpanLimitsConfig.h"
 #include "jaegertracing/Tag.h"
 #include "jaegertracing/TraceID.h"
 #include "jaegertracing/baggage/RestrictionsConfig.h"
+#include "jaegertracing/metrics/InMemoryStatsReporter.h"
+#include "jaegertracing/metrics/StatsFactoryImpl.h"
 #include "jaegertracing/net/IPAddress.h"
 #include "jaegertracing/propagation/HeadersConfig.h"
 #include "jaegertracing/reporters/Config.h"
 #include "jaegertracing/samplers/Config.h"
+#include "jaegertracing/testutils/MockAgent.h"
 #include "jaegertracing/testutils/TracerUtil.h"
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <gtest/gtest.h>
 #include <iterator>
@@ -43,6 +49,7 @@
 #include <stdexcept>
 #include <string>
 #include <sys/socket.h>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -106,6 +113,19 @@ struct ReaderMock : public BaseReader {
     const StrMap& _keyValuePairs;
 };
 
+class SequentialIDGenerator : public IDGenerator {
+  public:
+    SequentialIDGenerator()
+        : _next(0)
+    {
+    }
+
+    uint64_t generate() override { return _next++; }
+
+  private:
+    std::atomic<uint64_t> _next;
+};
+
 template <typename ClockType>
 typename ClockType::duration
 absTimeDiff(const typename ClockType::time_point& lhs,
@@ -270,6 +290,506 @@ TEST(Tracer, testDisabledConfig)
         Tracer::make("test-service", config))));
 }
 
+TEST(Tracer, testIDGenerator)
+{
+    Config config(false,
+                  samplers::Config("const",
+                                   1,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig());
+    metrics::NullStatsFactory factory;
+    const auto tracer = Tracer::make("test-service",
+                                     config,
+                                     logging::nullLogger(),
+                                     factory,
+                                     Tracer::kGen128BitOption,
+                                     std::make_shared<SequentialIDGenerator>());
+
+    // Zero is skipped, so the first trace ID is (1, 2).
+    const auto parent = tracer->StartSpan("parent");
+    const auto& parentCtx = static_cast<const SpanContext&>(parent->context());
+    ASSERT_EQ(TraceID(1, 2), parentCtx.traceID());
+    ASSERT_EQ(2, parentCtx.spanID());
+
+    const auto child = tracer->StartSpan(
+        "child", { opentracing::ChildOf(&parent->context()) });
+    const auto& childCtx = static_cast<const SpanContext&>(child->context());
+    ASSERT_EQ(parentCtx.traceID(), childCtx.traceID());
+    ASSERT_EQ(3, childCtx.spanID());
+    ASSERT_EQ(2, childCtx.parentID());
+
+    ASSERT_THROW(Tracer::make("test-service",
+                              config,
+                              logging::nullLogger(),
+                              factory,
+                              0,
+                              std::shared_ptr<IDGenerator>()),
+                 std::invalid_argument);
+    tracer->Close();
+}
+
+TEST(Tracer, testRegisteredOperation)
+{
+    Config config(false,
+                  samplers::Config("const",
+                                   1,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig());
+    const auto tracer = std::static_pointer_cast<Tracer>(
+        Tracer::make("test-service", config, logging::nullLogger()));
+    const auto operation = tracer->registerOperation(
+        "registered", { Tag("static-key", "static-value") });
+    ASSERT_EQ("registered", operation->name());
+
+    const auto parent = tracer->startSpan(operation);
+    ASSERT_TRUE(static_cast<bool>(parent));
+    ASSERT_EQ("registered", parent->operationName());
+    ASSERT_TRUE(parent->context().isSampled());
+    // The static tags are not copied into the span, but are reported first.
+    const auto thriftSpan = parent->thrift();
+    ASSERT_EQ("registered", thriftSpan.operationName);
+    ASSERT_LT(parent->tags().size(), thriftSpan.tags.size());
+    ASSERT_EQ("static-key", thriftSpan.tags.front().key);
+    ASSERT_EQ("static-value", thriftSpan.tags.front().vStr);
+
+    const auto child = tracer->startSpan(
+        operation, { opentracing::ChildOf(&parent->context()) });
+    ASSERT_EQ(parent->context().traceID(), child->context().traceID());
+    ASSERT_EQ(parent->context().spanID(), child->context().parentID());
+
+    child->SetOperationName("renamed");
+    ASSERT_EQ("renamed", child->operationName());
+    const auto childTags = child->tags();
+    ASSERT_FALSE(childTags.empty());
+    ASSERT_EQ("static-key", childTags.front().key());
+
+    ASSERT_FALSE(static_cast<bool>(tracer->startSpan(nullptr)));
+    tracer->Close();
+}
+
+TEST(Tracer, testNonSampledSpan)
+{
+    Config config(false,
+                  samplers::Config("const",
+                                   0,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig());
+    const auto tracer = std::static_pointer_cast<Tracer>(
+        Tracer::make("test-service", config, logging::nullLogger()));
+
+    const auto parent = tracer->StartSpan("parent");
+    ASSERT_TRUE(static_cast<bool>(parent));
+    const auto& parentCtx = static_cast<const SpanContext&>(parent->context());
+    ASSERT_TRUE(parentCtx.isValid());
+    ASSERT_FALSE(parentCtx.isSampled());
+
+    opentracing::StartSpanOptions options;
+    options.tags.push_back({ "tag-key", 1.23 });
+    options.references.emplace_back(opentracing::SpanReferenceType::ChildOfRef,
+                                    &parentCtx);
+    std::unique_ptr<Span> span(static_cast<Span*>(
+        tracer->StartSpanWithOptions("child", options).release()));
+    ASSERT_TRUE(static_cast<bool>(span));
+    ASSERT_EQ("child", span->operationName());
+    ASSERT_EQ(parentCtx.traceID(), span->context().traceID());
+    ASSERT_EQ(parentCtx.spanID(), span->context().parentID());
+    ASSERT_FALSE(span->context().isSampled());
+    // Nothing that is only reported is kept.
+    ASSERT_TRUE(span->tags().empty());
+    span->SetTag("tag-key", "tag-value");
+    span->Log({ { "log-key", "log-value" } });
+    ASSERT_TRUE(span->tags().empty());
+
+    // Baggage still propagates.
+    span->SetBaggageItem("baggage-key", "baggage-value");
+    ASSERT_EQ("baggage-value", span->BaggageItem("baggage-key"));
+    StrMap textMap;
+    WriterMock<opentracing::TextMapWriter> textWriter(textMap);
+    ASSERT_TRUE(static_cast<bool>(tracer->Inject(span->context(), textWriter)));
+    ASSERT_EQ("baggage-value",
+              textMap.at(std::string(kTraceBaggageHeaderPrefix) +
+                         "baggage-key"));
+
+    span->Finish();
+    ASSERT_NE(Span::SteadyClock::duration(), span->duration());
+    tracer->Close();
+}
+
+TEST(Tracer, testSpanSampledAfterStart)
+{
+    Config config(false,
+                  samplers::Config("const",
+                                   0,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig());
+    const auto tracer = std::static_pointer_cast<Tracer>(
+        Tracer::make("test-service", config, logging::nullLogger()));
+
+    const auto parent = tracer->StartSpan("parent");
+    const auto& parentCtx = static_cast<const SpanContext&>(parent->context());
+    ASSERT_FALSE(parentCtx.isSampled());
+    std::unique_ptr<Span> span(static_cast<Span*>(
+        tracer->StartSpan("child", { opentracing::ChildOf(&parentCtx) })
+            .release()));
+    ASSERT_FALSE(span->context().isSampled());
+
+    span->SetTag("sampling.priority", 1);
+    ASSERT_TRUE(span->context().isSampled());
+    const auto thriftSpan = span->thrift();
+    ASSERT_EQ(1U, thriftSpan.references.size());
+    const auto& ref = thriftSpan.references.front();
+    ASSERT_EQ(thrift::SpanRefType::CHILD_OF, ref.refType);
+    ASSERT_EQ(parentCtx.traceID().low(),
+              static_cast<uint64_t>(ref.traceIdLow));
+    ASSERT_EQ(parentCtx.spanID(), static_cast<uint64_t>(ref.spanId));
+    span->Finish();
+    tracer->Close();
+}
+
+TEST(Tracer, testSpanPool)
+{
+    Config config(false,
+                  samplers::Config("const",
+                                   0,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig());
+    metrics::InMemoryStatsReporter statsReporter;
+    metrics::StatsFactoryImpl factory(statsReporter);
+    const auto tracer = Tracer::make("test-service",
+                                     config,
+                                     logging::nullLogger(),
+                                     factory,
+                                     Tracer::kSpanPoolOption);
+
+    // The pool is per thread, so use a fresh one.
+    constexpr auto kNumSpans = 10;
+    std::thread thread([&tracer]() {
+        const void* firstSpan = nullptr;
+        for (auto i = 0; i < kNumSpans; ++i) {
+            auto span = tracer->StartSpan("test");
+            if (i == 0) {
+                firstSpan = span.get();
+            }
+            else {
+                EXPECT_EQ(firstSpan, span.get());
+            }
+        }
+    });
+    thread.join();
+
+    const auto& counters = statsReporter.counters();
+    ASSERT_EQ(kNumSpans - 1, counters.at("jaeger.span-pool.result=hit"));
+    ASSERT_EQ(1, counters.at("jaeger.span-pool.result=miss"));
+    ASSERT_EQ(1, statsReporter.gauges().at("jaeger.span-pool-size"));
+    tracer->Close();
+}
+
+TEST(Tracer, testSpanPoolSampled)
+{
+    // Counts allocations the pool cannot serve from the calling thread's
+    // cache.
+    class MissCountingResource : public utils::MemoryResource {
+      public:
+        MissCountingResource()
+            : _numMisses(0)
+        {
+        }
+
+        int numMisses() const { return _numMisses; }
+
+      protected:
+        void* doAllocate(std::size_t size) override
+        {
+            if (size > kMaxPoolBlockSize || poolSize(size) == 0) {
+                ++_numMisses;
+            }
+            return pool().allocate(size);
+        }
+
+        void doDeallocate(void* ptr, std::size_t size) noexcept override
+        {
+            pool().deallocate(ptr, size);
+        }
+
+      private:
+        std::atomic<int> _numMisses;
+    };
+
+    const auto resource = std::make_shared<MissCountingResource>();
+    Config config(false,
+                  samplers::Config("const",
+                                   1,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig(),
+                  resource);
+    const auto tracer =
+        Tracer::make("test-service", config, logging::nullLogger());
+
+    // The pool is per thread, so use a fresh one.
+    constexpr auto kNumSpans = 3;
+    std::thread thread([&tracer, &resource]() {
+        const auto startSpans = [&tracer]() {
+            const auto parent = tracer->StartSpan("parent");
+            const auto child = tracer->StartSpan(
+                "child",
+                { opentracing::ChildOf(&parent->context()),
+                  opentracing::SetTag("tag-key", 1) });
+            child->SetTag("tag-key", "tag-value");
+        };
+        startSpans();
+        const auto numMisses = resource->numMisses();
+        for (auto i = 0; i < kNumSpans; ++i) {
+            startSpans();
+        }
+        // Spans and their records come from the cache. Finished spans go
+        // back to it once the reporter's thread frees them, so only those
+        // still in flight may miss.
+        EXPECT_GE(numMisses + 2 * kNumSpans, resource->numMisses());
+    });
+    thread.join();
+    tracer->Close();
+}
+
+TEST(Tracer, testMemoryResource)
+{
+    class HeapResource : public utils::MemoryResource {
+      protected:
+        void* doAllocate(std::size_t size) override
+        {
+            return utils::MemoryResource::heap().allocate(size);
+        }
+
+        void doDeallocate(void* ptr, std::size_t size) noexcept override
+        {
+            utils::MemoryResource::heap().deallocate(ptr, size);
+        }
+    };
+
+    const auto resource = std::make_shared<HeapResource>();
+    Config config(false,
+                  samplers::Config("const",
+                                   1,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig(),
+                  resource);
+    auto tracer = std::static_pointer_cast<Tracer>(
+        Tracer::make("test-service", config, logging::nullLogger()));
+    ASSERT_EQ(resource, tracer->memoryResource());
+    {
+        const auto span = tracer->StartSpan("test");
+        span->SetTag("key", "value");
+        span->Log({ { "log-key", "log-value" } });
+    }
+    // The span, its record and the finished span.
+    ASSERT_LE(3U, resource->stats()._allocations);
+    tracer->Close();
+    tracer.reset();
+    ASSERT_EQ(0U, resource->stats().bytesInUse());
+
+    // A span holding the last reference to its tracer keeps the resource
+    // alive until the span itself is freed.
+    std::weak_ptr<utils::MemoryResource> weakResource;
+    std::unique_ptr<opentracing::Span> span;
+    {
+        const auto lastResource = std::make_shared<HeapResource>();
+        weakResource = lastResource;
+        // Not sampled, so no finished span holds on to the tracer.
+        const samplers::Config samplerConfig(
+            "const", 0, "", 0, samplers::Config::Clock::duration());
+        const Config lastConfig(false,
+                                samplerConfig,
+                                reporters::Config(),
+                                propagation::HeadersConfig(),
+                                baggage::RestrictionsConfig(),
+                                lastResource);
+        span = Tracer::make("test-service", lastConfig, logging::nullLogger())
+                   ->StartSpan("test");
+    }
+    ASSERT_FALSE(weakResource.expired());
+    span.reset();
+    ASSERT_TRUE(weakResource.expired());
+}
+
+TEST(Tracer, testSpanLimits)
+{
+    const auto mockAgent = testutils::MockAgent::make();
+    mockAgent->start();
+    // The sampler's two tags count against maxTags, and its "const" type
+    // fits maxStringLength.
+    Config config(false,
+                  samplers::Config("const",
+                                   1,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(0,
+                                    reporters::Config::Clock::duration(),
+                                    false,
+                                    mockAgent->spanServerAddress().authority()),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig(),
+                  nullptr,
+                  SpanLimitsConfig(2, 1, 3, 5, 0));
+    metrics::InMemoryStatsReporter statsReporter;
+    metrics::StatsFactoryImpl factory(statsReporter);
+    const auto tracer = Tracer::make(
+        "test-service", config, logging::nullLogger(), factory);
+
+    auto span = tracer->StartSpan("test");
+    span->SetTag("cut", std::string("abcdefgh"));
+    span->SetTag("dropped", 1);
+    span->Log({ { "event", "firstlog" }, { "message", "cut" } });
+    span->Log({ { "event", "second" } });
+    span->Log({ { "event", "dropped" } });
+    const auto thriftSpan = static_cast<Span&>(*span).thrift();
+    ASSERT_EQ(3U, thriftSpan.tags.size());
+    ASSERT_EQ("abcde", thriftSpan.tags.back().vStr);
+    ASSERT_EQ(2U, thriftSpan.logs.size());
+    ASSERT_EQ(1U, thriftSpan.logs.front().fields.size());
+    ASSERT_EQ("first", thriftSpan.logs.front().fields.front().vStr);
+
+    opentracing::FinishSpanOptions options;
+    opentracing::LogRecord log;
+    log.fields.emplace_back("event", std::string("dropped"));
+    options.log_records.push_back(log);
+    span->FinishWithOptions(options);
+    tracer->Close();
+
+    const auto& counters = statsReporter.counters();
+    ASSERT_EQ(2, counters.at("jaeger.span-limited.reason=logs"));
+    ASSERT_EQ(1, counters.at("jaeger.span-limited.reason=log-fields"));
+    ASSERT_EQ(1, counters.at("jaeger.span-limited.reason=tags"));
+    ASSERT_EQ(2, counters.at("jaeger.span-limited.reason=string-length"));
+
+    constexpr auto kNumTries = 100;
+    for (auto i = 0; i < kNumTries && mockAgent->batches().empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto batches = mockAgent->batches();
+    ASSERT_EQ(1U, batches.size());
+    const auto& tags = batches[0].spans.at(0).tags;
+    ASSERT_EQ(kTruncatedTagKey, tags.back().key);
+    ASSERT_TRUE(tags.back().vBool);
+}
+
+TEST(Tracer, testSpanBytesLimit)
+{
+    Config config(false,
+                  samplers::Config("const",
+                                   1,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig(),
+                  nullptr,
+                  SpanLimitsConfig(0, 0, 0, 0, 1024));
+    metrics::InMemoryStatsReporter statsReporter;
+    metrics::StatsFactoryImpl factory(statsReporter);
+    const auto tracer = Tracer::make(
+        "test-service", config, logging::nullLogger(), factory);
+
+    auto span = tracer->StartSpan("test");
+    const std::string value(100, 'x');
+    constexpr auto kNumLogs = 20;
+    for (auto i = 0; i < kNumLogs; ++i) {
+        span->Log({ { "event", value } });
+    }
+    const auto numLogs = static_cast<Span&>(*span).thrift().logs.size();
+    ASSERT_LT(0U, numLogs);
+    ASSERT_GT(static_cast<std::size_t>(kNumLogs), numLogs);
+    ASSERT_EQ(kNumLogs - static_cast<int>(numLogs),
+              statsReporter.counters().at("jaeger.span-limited.reason=bytes"));
+    span->Finish();
+    tracer->Close();
+}
+
+TEST(Tracer, testLargeSpanArrivesAsContinuations)
+{
+    const auto mockAgent = testutils::MockAgent::make();
+    mockAgent->start();
+    // Default span limits.
+    Config config(false,
+                  samplers::Config("const",
+                                   1,
+                                   "",
+                                   0,
+                                   samplers::Config::Clock::duration()),
+                  reporters::Config(0,
+                                    reporters::Config::Clock::duration(),
+                                    false,
+                                    mockAgent->spanServerAddress().authority()),
+                  propagation::HeadersConfig(),
+                  baggage::RestrictionsConfig());
+    const auto tracer =
+        Tracer::make("test-service", config, logging::nullLogger());
+
+    // Far more than fits in one UDP packet.
+    auto span = tracer->StartSpan("test");
+    const std::string value(1000, 'x');
+    constexpr auto kNumLogs = 200;
+    for (auto i = 0; i < kNumLogs; ++i) {
+        span->Log({ { "event", value } });
+    }
+    span->Finish();
+    tracer->Close();
+
+    constexpr auto kNumTries = 100;
+    auto numBytes = static_cast<std::size_t>(0);
+    auto numContinuations = 0;
+    for (auto i = 0; i < kNumTries && numBytes < kNumLogs * value.size();
+         ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        numBytes = 0;
+        numContinuations = 0;
+        for (auto&& batch : mockAgent->batches()) {
+            for (auto&& received : batch.spans) {
+                for (auto&& tag : received.tags) {
+                    if (tag.key == kContinuationTagKey) {
+                        ++numContinuations;
+                    }
+                }
+                for (auto&& log : received.logs) {
+                    for (auto&& field : log.fields) {
+                        numBytes += field.vStr.size();
+                    }
+                }
+            }
+        }
+    }
+    ASSERT_EQ(kNumLogs * value.size(), numBytes);
+    ASSERT_LT(1, numContinuations);
+}
+
 TEST(Tracer, testPropagation)
 {
     const auto handle = testutils::TracerUtil::installGlobalTracer();
@@ -399,4 +919,31 @@ TEST(Tracer, testPropagation)
     }
 }
 
+TEST(Tracer, testBaggageOnlyParent)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<Tracer>(opentracing::Tracer::Global());
+
+    StrMap headerMap;
+    headerMap[kJaegerBaggageHeader] = "a=x,b=y";
+    ReaderMock<opentracing::HTTPHeadersReader> headerReader(headerMap);
+    auto result = tracer->Extract(headerReader);
+    ASSERT_TRUE(static_cast<bool>(result));
+    std::unique_ptr<const SpanContext> extractedCtx(
+        static_cast<SpanContext*>(result->release()));
+    ASSERT_TRUE(static_cast<bool>(extractedCtx));
+    ASSERT_FALSE(extractedCtx->isValid());
+
+    const std::unique_ptr<Span> span(static_cast<Span*>(
+        tracer
+            ->StartSpan("test-baggage-only-parent",
+                        { opentracing::ChildOf(extractedCtx.get()) })
+            .release()));
+    ASSERT_TRUE(span->context().isValid());
+    ASSERT_EQ("x", span->BaggageItem("a"));
+    ASSERT_EQ("y", span->BaggageItem("b"));
+    span->Finish();
+}
+
 }  // namespace jaegertracing
@@ -22,27 +22,41 @@
 
 namespace jaegertracing {
 
-class Span;
+class FinishedSpan;
 
 class Transport {
   public:
     class Exception : public std::runtime_error {
       public:
-        Exception(const std::string& what, int numFailed)
+        Exception(const std::string& what,
+                  int numFailed,
+                  int numSent = 0,
+                  int numDropped = 0)
             : std::runtime_error(what)
             , _numFailed(numFailed)
+            , _numSent(numSent)
+            , _numDropped(numDropped)
         {
         }
 
         int numFailed() const { return _numFailed; }
 
+        // Spans sent successfully by the same operation before it failed.
+        int numSent() const { return _numSent; }
+
+        // Spans discarded by the same operation, not counted as failed,
+        // because the socket send buffer or shared memory ring was full.
+        int numDropped() const { return _numDropped; }
+
       private:
         int _numFailed;
+        int _numSent;
+        int _numDropped;
     };
 
     virtual ~Transport() = default;
 
-    virtual int append(const Span& span) = 0;
+    virtual int append(const FinishedSpan& span) = 0;
 
     virtual int flush() = 0;
 
@@ -16,123 +16,394 @@
 
 #include "jaegertracing/UDPTransport.h"
 
-#include "jaegertracing/Span.h"
-#include "jaegertracing/Tag.h"
+#include "jaegertracing/FinishedSpan.h"
+#include "jaegertracing/IDGenerator.h"
+#include "jaegertracing/ThriftCompactEncoder.h"
 #include "jaegertracing/Tracer.h"
 #include <algorithm>
 #include <cstdint>
-#include <iostream>
 #include <iterator>
+#include <sstream>
 #include <string>
-#include <thrift/protocol/TCompactProtocol.h>
-#include <thrift/transport/TBufferTransports.h>
 
 namespace jaegertracing {
 namespace net {
 class IPAddress;
 }  // namespace net
-
 namespace {
 
-constexpr auto kEmitBatchOverhead = 30;
+// Encodes `span` at `spanStart`, replacing anything there, and returns its
+// size.
+int encodeSpan(std::string& data,
+               std::size_t spanStart,
+               const FinishedSpan& span)
+{
+    data.resize(spanStart);
+    try {
+        ThriftCompactEncoder(data).writeSpan(span);
+    } catch (...) {
+        data.resize(spanStart);
+        throw;
+    }
+    return static_cast<int>(data.size() - spanStart);
+}
+
+// Tags of a span sent without its logs: all of them if `keepTags`, else
+// only the truncation marker.
+FinishedSpan::TagList headTags(const FinishedSpan& span, bool keepTags)
+{
+    FinishedSpan::TagList tags;
+    if (keepTags) {
+        tags.append(std::begin(span.operationTags()),
+                    std::end(span.operationTags()));
+        tags.append(std::begin(span.tags()), std::end(span.tags()));
+    }
+    else {
+        tags.push_back(Tag(kTruncatedTagKey, true));
+    }
+    return tags;
+}
+
+// Span ID for a continuation, from the tracer of the span if it has one.
+uint64_t continuationID(const Tracer* tracer)
+{
+    if (tracer) {
+        return tracer->randomID();
+    }
+    static RandomIDGenerator generator;
+    auto value = generator.generate();
+    while (value == 0) {
+        value = generator.generate();
+    }
+    return value;
+}
 
-template <typename ThriftType>
-int calcSizeOfSerializedThrift(const ThriftType& base, int maxPacketSize)
+bool stringValue(const Tag& tag, opentracing::string_view& str)
 {
-    std::shared_ptr<apache::thrift::transport::TMemoryBuffer> buffer(
-        new apache::thrift::transport::TMemoryBuffer(maxPacketSize));
-    apache::thrift::protocol::TCompactProtocolFactory factory;
-    auto protocol = factory.getProtocol(buffer);
-    base.write(protocol.get());
-    uint8_t* data = nullptr;
-    uint32_t size = 0;
-    buffer->getBuffer(&data, &size);
-    return size;
+    const auto& value = tag.value();
+    if (value.is<std::string>()) {
+        str = value.get<std::string>();
+        return true;
+    }
+    if (value.is<const char*>()) {
+        str = value.get<const char*>();
+        return true;
+    }
+    return false;
+}
+
+// Splits `log` into logs with the same timestamp whose encoded size is at
+// most `maxSize`. Fields are kept whole where possible; string values too
+// long for any log are split over several.
+std::vector<LogRecord> splitLog(const LogRecord& log, std::size_t maxSize)
+{
+    std::vector<LogRecord> pieces;
+    std::vector<Tag> fields;
+    auto size =
+        static_cast<std::size_t>(ThriftCompactEncoder::kMaxLogOverhead);
+    const auto addPiece = [&]() {
+        if (!fields.empty()) {
+            pieces.emplace_back(
+                log.timestamp(), std::begin(fields), std::end(fields));
+            fields.clear();
+            size = ThriftCompactEncoder::kMaxLogOverhead;
+        }
+    };
+    const auto addField = [&](Tag field, std::size_t fieldSize) {
+        if (size + fieldSize > maxSize) {
+            addPiece();
+        }
+        fields.push_back(std::move(field));
+        size += fieldSize;
+    };
+
+    for (auto&& field : log.fields()) {
+        const auto fieldSize = ThriftCompactEncoder::maxTagSize(field);
+        opentracing::string_view str;
+        if (ThriftCompactEncoder::kMaxLogOverhead + fieldSize <= maxSize ||
+            !stringValue(field, str)) {
+            addField(field, fieldSize);
+            continue;
+        }
+        const auto chunkOverhead = ThriftCompactEncoder::kMaxLogOverhead +
+                                   ThriftCompactEncoder::maxTagSize(
+                                       Tag(field.key(), std::string()));
+        const auto chunkSize = maxSize - std::min(maxSize, chunkOverhead);
+        if (chunkSize == 0) {
+            // Not even the key fits, leave it to fail when encoded.
+            addField(field, fieldSize);
+            continue;
+        }
+        for (auto offset = static_cast<std::size_t>(0); offset < str.size();
+             offset += chunkSize) {
+            const auto length = std::min(chunkSize, str.size() - offset);
+            addField(
+                Tag(field.key(), std::string(str.data() + offset, length)),
+                chunkOverhead - ThriftCompactEncoder::kMaxLogOverhead +
+                    length);
+        }
+    }
+    addPiece();
+    return pieces;
 }
 
 }  // anonymous namespace
 
 UDPTransport::UDPTransport(const net::IPAddress& ip, int maxPacketSize)
-    : _client(new utils::UDPClient(ip, maxPacketSize))
+    : UDPTransport(std::unique_ptr<utils::UDPClient>(
+          new utils::UDPClient(ip, maxPacketSize)))
+{
+}
+
+UDPTransport::UDPTransport(std::unique_ptr<utils::UDPClient>&& client)
+    : _client(std::move(client))
     , _maxSpanBytes(0)
-    , _byteBufferSize(0)
-    , _processByteSize(0)
+    , _header()
+    , _spansOffset(0)
+    , _packets()
+    , _numReady(0)
 {
 }
 
-int UDPTransport::append(const Span& span)
+int UDPTransport::append(const FinishedSpan& span)
 {
-    if (_process.serviceName.empty()) {
-        const auto& tracer = static_cast<const Tracer&>(span.tracer());
-        _process.serviceName = tracer.serviceName();
-
-        const auto& tracerTags = tracer.tags();
-        std::vector<thrift::Tag> thriftTags;
-        thriftTags.reserve(tracerTags.size());
-        std::transform(std::begin(tracerTags),
-                       std::end(tracerTags),
-                       std::back_inserter(thriftTags),
-                       [](const Tag& tag) { return tag.thrift(); });
-        _process.__set_tags(thriftTags);
-
-        _processByteSize =
-            calcSizeOfSerializedThrift(_process, _client->maxPacketSize());
-        _maxSpanBytes =
-            _client->maxPacketSize() - _processByteSize - kEmitBatchOverhead;
-    }
-    const auto jaegerSpan = span.thrift();
-    const auto spanSize =
-        calcSizeOfSerializedThrift(jaegerSpan, _client->maxPacketSize());
-    if (spanSize > _maxSpanBytes) {
-        std::ostringstream oss;
+    if (_header.empty()) {
+        // Without a tracer, spans are sent with an empty process.
+        const auto tracer = span.processTracer();
+        ThriftCompactEncoder(_header).writeEmitBatchPrefix(
+            tracer ? tracer->serviceName() : std::string(),
+            tracer ? tracer->tags() : std::vector<Tag>());
+        _spansOffset =
+            _header.size() + ThriftCompactEncoder::kMaxListHeaderSize;
+        _maxSpanBytes = _client->maxPacketSize() -
+                        static_cast<int>(_spansOffset) -
+                        ThriftCompactEncoder::kEmitBatchSuffixSize;
+        _packets.resize(kMaxReadyPackets);
+        for (auto&& packet : _packets) {
+            resetPacket(packet);
+        }
+    }
+
+    auto& packet = currentPacket();
+    const auto spanStart = packet._data.size();
+    if (encodeSpan(packet._data, spanStart, span) <= _maxSpanBytes) {
+        return appendEncodedSpan(spanStart);
+    }
+    packet._data.resize(spanStart);
+    return appendSplit(span);
+}
+
+int UDPTransport::appendSplit(const FinishedSpan& span)
+{
+    // Send the span without its logs, then its logs in as many continuation
+    // spans as they need. Each continuation is a child of the span that also
+    // follows from it, and is tagged with its index from one.
+    auto flushed = appendWithoutLogs(span);
+    if (span.logs().empty()) {
+        return flushed;
+    }
+
+    const auto* tracer = span.tracer().get();
+    const auto& context = span.context();
+    const auto& operationName = span.operationName();
+    const auto maxSize = static_cast<std::size_t>(_maxSpanBytes);
+    auto index = static_cast<int64_t>(0);
+    std::vector<LogRecord> logs;
+    auto logsSize = static_cast<std::size_t>(0);
+    const auto appendContinuation = [&]() {
+        ++index;
+        const SpanContext continuationContext(context.traceID(),
+                                              continuationID(tracer),
+                                              context.spanID(),
+                                              context.flags(),
+                                              {});
+        const FinishedSpan continuation(
+            span.tracer(),
+            continuationContext,
+            operationName,
+            span.startTimeSystem(),
+            span.duration(),
+            { Tag(kContinuationTagKey, index) },
+            std::move(logs),
+            { Reference(context, Reference::Type::FollowsFromRef) });
+        flushed += appendWithoutSplitting(continuation);
+        logs.clear();
+        logsSize = 0;
+    };
+
+    const auto overhead =
+        ThriftCompactEncoder::kMaxSpanOverhead + operationName.size() +
+        ThriftCompactEncoder::kMaxReferenceSize +
+        ThriftCompactEncoder::maxTagSize(Tag(kContinuationTagKey, index));
+    try {
+        if (overhead + ThriftCompactEncoder::kMaxLogOverhead >= maxSize) {
+            throw Transport::Exception("Span is too large", 1);
+        }
+        for (auto&& log : span.logs()) {
+            for (auto&& piece : splitLog(log, maxSize - overhead)) {
+                const auto pieceSize = ThriftCompactEncoder::maxLogSize(piece);
+                if (!logs.empty() &&
+                    overhead + logsSize + pieceSize > maxSize) {
+                    appendContinuation();
+                }
+                logs.push_back(std::move(piece));
+                logsSize += pieceSize;
+            }
+        }
+        appendContinuation();
+    } catch (const Transport::Exception& ex) {
+        // Spans flushed before the failure were still sent.
+        throw Transport::Exception(ex.what(),
+                                   ex.numFailed(),
+                                   flushed + ex.numSent(),
+                                   ex.numDropped());
+    }
+    return flushed;
+}
+
+int UDPTransport::appendWithoutLogs(const FinishedSpan& span)
+{
+    // Drop the tags too if they do not fit, leaving the truncation marker.
+    for (auto keepTags : { true, false }) {
+        const FinishedSpan head(span.tracer(),
+                                span.context(),
+                                span.operationName(),
+                                span.startTimeSystem(),
+                                span.duration(),
+                                headTags(span, keepTags),
+                                std::vector<LogRecord>(),
+                                span.references());
+        auto& packet = currentPacket();
+        const auto spanStart = packet._data.size();
+        if (encodeSpan(packet._data, spanStart, head) <= _maxSpanBytes) {
+            return appendEncodedSpan(spanStart);
+        }
+        packet._data.resize(spanStart);
+    }
+    throw Transport::Exception("Span is too large", 1);
+}
+
+int UDPTransport::appendWithoutSplitting(const FinishedSpan& span)
+{
+    auto& packet = currentPacket();
+    const auto spanStart = packet._data.size();
+    if (encodeSpan(packet._data, spanStart, span) > _maxSpanBytes) {
+        packet._data.resize(spanStart);
         throw Transport::Exception("Span is too large", 1);
     }
+    return appendEncodedSpan(spanStart);
+}
 
-    _byteBufferSize += spanSize;
-    if (_byteBufferSize <= _maxSpanBytes) {
-        _spanBuffer.push_back(jaegerSpan);
-        if (_byteBufferSize < _maxSpanBytes) {
+int UDPTransport::appendEncodedSpan(std::size_t spanStart)
+{
+    auto& packet = currentPacket();
+    const auto byteBufferSize =
+        static_cast<int>(packet._data.size() - _spansOffset);
+    if (byteBufferSize <= _maxSpanBytes) {
+        ++packet._numSpans;
+        if (byteBufferSize < _maxSpanBytes) {
             return 0;
         }
-        return flush();
+        sealPacket();
+        return _numReady == kMaxReadyPackets ? sendReadyPackets() : 0;
     }
 
-    // Flush currently full buffer, then append this span to buffer.
-    const auto flushed = flush();
-    _spanBuffer.push_back(jaegerSpan);
-    _byteBufferSize = spanSize + _processByteSize;
+    // Seal currently full packet, then append this span to the next one.
+    const std::string encodedSpan(packet._data, spanStart);
+    packet._data.resize(spanStart);
+    sealPacket();
+    const auto flushed =
+        (_numReady == kMaxReadyPackets) ? sendReadyPackets() : 0;
+    auto& nextPacket = currentPacket();
+    nextPacket._data.append(encodedSpan);
+    nextPacket._numSpans = 1;
     return flushed;
 }
 
 int UDPTransport::flush()
 {
-    if (_spanBuffer.empty()) {
+    // Packets are only allocated by the first append.
+    if (_packets.empty()) {
         return 0;
     }
+    if (_numReady < kMaxReadyPackets && currentPacket()._numSpans > 0) {
+        sealPacket();
+    }
+    return sendReadyPackets();
+}
+
+void UDPTransport::sealPacket()
+{
+    auto& packet = currentPacket();
 
-    thrift::Batch batch;
-    batch.__set_process(_process);
-    batch.__set_spans(_spanBuffer);
+    // Fill in the header and list header just before the encoded spans.
+    std::string listHeader;
+    ThriftCompactEncoder(listHeader).writeListHeader(packet._numSpans);
+    const auto listStart = _spansOffset - listHeader.size();
+    packet._start = listStart - _header.size();
+    std::copy(std::begin(_header),
+              std::end(_header),
+              &packet._data[packet._start]);
+    std::copy(std::begin(listHeader),
+              std::end(listHeader),
+              &packet._data[listStart]);
+    ThriftCompactEncoder(packet._data).writeEmitBatchSuffix();
+    ++_numReady;
+}
 
+int UDPTransport::sendReadyPackets()
+{
+    // Through io_uring even an empty flush reaps packets sent earlier.
+    if (_numReady == 0 && !_client->usingIOUring()) {
+        return 0;
+    }
+
+    ::iovec messages[kMaxReadyPackets];
+    int weights[kMaxReadyPackets];
+    auto numSpans = 0;
+    for (auto i = 0; i < _numReady; ++i) {
+        auto& packet = _packets[i];
+        messages[i].iov_base = &packet._data[packet._start];
+        messages[i].iov_len = packet._data.size() - packet._start;
+        weights[i] = packet._numSpans;
+        numSpans += packet._numSpans;
+    }
+
+    // Through io_uring, the spans sent, lost or dropped may be those of
+    // packets sent by an earlier flush.
+    auto numSpansSent = 0;
+    auto numSpansLost = 0;
+    auto numSpansDropped = 0;
     try {
-        _client->emitBatch(batch);
+        numSpansSent = _client->sendWeighted(
+            messages, weights, _numReady, numSpansLost, numSpansDropped);
     } catch (const std::system_error& ex) {
+        resetBuffers();
         std::ostringstream oss;
         oss << "Could not send span " << ex.what()
             << ", code=" << ex.code().value();
-        throw Transport::Exception(oss.str(), _spanBuffer.size());
+        throw Transport::Exception(oss.str(), numSpans);
     } catch (const std::exception& ex) {
+        resetBuffers();
         std::ostringstream oss;
         oss << "Could not send span " << ex.what();
-        throw Transport::Exception(oss.str(), _spanBuffer.size());
+        throw Transport::Exception(oss.str(), numSpans);
     } catch (...) {
+        resetBuffers();
         throw Transport::Exception("Could not send span, unknown error",
-                                   _spanBuffer.size());
+                                   numSpans);
     }
-
     resetBuffers();
 
-    return batch.spans.size();
+    if (numSpansLost > 0 || numSpansDropped > 0) {
+        throw Transport::Exception(
+            numSpansLost > 0 ? "Could not send span"
+                             : "Could not send span, send buffer full",
+            numSpansLost,
+            numSpansSent,
+            numSpansDropped);
+    }
+    return numSpansSent;
 }
 
 }  // namespace jaegertracing
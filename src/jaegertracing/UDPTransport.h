@@ -17,9 +17,11 @@
 #ifndef JAEGERTRACING_UDPTRANSPORT_H
 #define JAEGERTRACING_UDPTRANSPORT_H
 
-#include "jaegertracing/Span.h"
+#include <string>
+#include <vector>
+
+#include "jaegertracing/FinishedSpan.h"
 #include "jaegertracing/Transport.h"
-#include "jaegertracing/thrift-gen/jaeger_types.h"
 #include "jaegertracing/utils/UDPClient.h"
 
 namespace jaegertracing {
@@ -28,14 +30,20 @@ class UDPTransport : public Transport {
   public:
     UDPTransport(const net::IPAddress& ip, int maxPacketSize);
 
+    explicit UDPTransport(std::unique_ptr<utils::UDPClient>&& client);
+
     ~UDPTransport() { close(); }
 
-    int append(const Span& span) override;
+    int append(const FinishedSpan& span) override;
 
     int flush() override;
 
     void close() override { _client->close(); }
 
+    // Sends packets through io_uring if the kernel supports it, see
+    // utils::UDPClient::useIOUring.
+    bool useIOUring() { return _client->useIOUring(kMaxReadyPackets); }
+
   protected:
     void setClient(std::unique_ptr<utils::UDPClient>&& client)
     {
@@ -43,19 +51,71 @@ class UDPTransport : public Transport {
     }
 
   private:
+    // Ready packets are sent together once this many have been filled, or
+    // on flush.
+    static constexpr auto kMaxReadyPackets = 8;
+
+    struct Packet {
+        Packet()
+            : _data()
+            , _start(0)
+            , _numSpans(0)
+        {
+        }
+
+        // Spans are encoded directly into _data, starting at _spansOffset.
+        // The space before them fits the header and the largest possible
+        // list header, which are filled in right-aligned when the packet is
+        // sealed. The finished message then starts at _start.
+        std::string _data;
+        std::size_t _start;
+        int _numSpans;
+    };
+
+    Packet& currentPacket() { return _packets[_numReady]; }
+
+    void resetPacket(Packet& packet)
+    {
+        packet._data.resize(_spansOffset);
+        packet._start = 0;
+        packet._numSpans = 0;
+    }
+
     void resetBuffers()
     {
-        _spanBuffer.clear();
-        _byteBufferSize = _processByteSize;
+        for (auto i = 0; i <= _numReady && i < kMaxReadyPackets; ++i) {
+            resetPacket(_packets[i]);
+        }
+        _numReady = 0;
     }
 
+    // Sends a span too large for a packet as the span without its logs,
+    // followed by continuation spans carrying the logs.
+    int appendSplit(const FinishedSpan& span);
+
+    int appendWithoutLogs(const FinishedSpan& span);
+
+    // Throws if the span does not fit in a packet.
+    int appendWithoutSplitting(const FinishedSpan& span);
+
+    // Adds the span just encoded at `spanStart` in the current packet,
+    // moving it to the next packet if the current one overflows.
+    int appendEncodedSpan(std::size_t spanStart);
+
+    void sealPacket();
+
+    int sendReadyPackets();
+
     std::unique_ptr<utils::UDPClient> _client;
     int _maxSpanBytes;
-    int _byteBufferSize;
-    std::vector<thrift::Span> _spanBuffer;
-    std::shared_ptr<apache::thrift::protocol::TProtocol> _protocol;
-    thrift::Process _process;
-    int _processByteSize;
+    // Encoded message up to the span list header. The process never changes,
+    // so it is encoded once.
+    std::string _header;
+    std::size_t _spansOffset;
+    // Packets before _numReady are sealed and waiting to be sent. The packet
+    // at _numReady is being filled.
+    std::vector<Packet> _packets;
+    int _numReady;
 };
 
 }  // namespace jaegertracing
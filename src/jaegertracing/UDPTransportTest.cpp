@@ -19,15 +19,19 @@
 #include "jaegertracing/Config.h"
 #include "jaegertracing/Tracer.h"
 #include "jaegertracing/UDPTransport.h"
+#include "jaegertracing/metrics/Metrics.h"
+#include "jaegertracing/reporters/RemoteReporter.h"
 #include "jaegertracing/testutils/TracerUtil.h"
 #include "jaegertracing/utils/ErrorUtil.h"
+#include <chrono>
+#include <thread>
 
 namespace jaegertracing {
 namespace {
 
 class MockUDPClient : public utils::UDPClient {
   public:
-    enum class ExceptionType { kSystemError, kException, kString };
+    enum class ExceptionType { kSystemError, kException, kString, kWouldBlock };
 
     MockUDPClient(const net::IPAddress& serverAddr,
                   int maxPacketSize,
@@ -38,9 +42,12 @@ class MockUDPClient : public utils::UDPClient {
     }
 
   private:
-    void emitBatch(const thrift::Batch& batch) override
+    int sendMany(const ::iovec* messages, int numMessages) override
     {
         switch (_type) {
+        case ExceptionType::kWouldBlock:
+            // Socket buffer fills up after the first message.
+            return 1;
         case ExceptionType::kSystemError:
             throw std::system_error(
                 std::make_error_code(std::errc::invalid_argument));
@@ -79,20 +86,235 @@ TEST(UDPTransport, testManyMessages)
     constexpr auto kNumMessages = 2000;
     const auto logger = logging::consoleLogger();
     for (auto i = 0; i < kNumMessages; ++i) {
-        Span span(tracer);
-        span.SetOperationName("test" + std::to_string(i));
+        const FinishedSpan span(
+            tracer, SpanContext(), "test" + std::to_string(i));
         ASSERT_NO_THROW(sender.append(span));
     }
 }
 
+TEST(UDPTransport, testFlushBeforeAppend)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    UDPTransport sender(handle->_mockAgent->spanServerAddress(), 0);
+    ASSERT_EQ(0, sender.flush());
+
+    // An idle reporter flushes on every interval and on close.
+    const auto logger = logging::nullLogger();
+    const auto metrics = metrics::Metrics::makeNullMetrics();
+    reporters::RemoteReporter reporter(
+        std::chrono::milliseconds(1),
+        1,
+        std::unique_ptr<Transport>(
+            new UDPTransport(handle->_mockAgent->spanServerAddress(), 0)),
+        *logger,
+        *metrics);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    reporter.close();
+}
+
+TEST(UDPTransport, testAgentReceivesSpans)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    // Small packets so the spans are split over several batches.
+    UDPTransport sender(handle->_mockAgent->spanServerAddress(), 512);
+    constexpr auto kNumMessages = 50;
+    for (auto i = 0; i < kNumMessages; ++i) {
+        const FinishedSpan span(
+            tracer, SpanContext(), "test" + std::to_string(i));
+        sender.append(span);
+    }
+    sender.flush();
+
+    constexpr auto kNumTries = 100;
+    auto numSpans = 0;
+    for (auto i = 0; i < kNumTries && numSpans < kNumMessages; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        numSpans = 0;
+        for (auto&& batch : handle->_mockAgent->batches()) {
+            ASSERT_EQ(tracer->serviceName(), batch.process.serviceName);
+            numSpans += static_cast<int>(batch.spans.size());
+        }
+    }
+    ASSERT_EQ(kNumMessages, numSpans);
+    const auto batches = handle->_mockAgent->batches();
+    ASSERT_LT(1, batches.size());
+    ASSERT_EQ("test0", batches[0].spans[0].operationName);
+}
+
+TEST(UDPTransport, testIOUring)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    // Spans arrive the same whether or not io_uring is available.
+    UDPTransport sender(handle->_mockAgent->spanServerAddress(), 512);
+    sender.useIOUring();
+    constexpr auto kNumMessages = 50;
+    auto numFlushed = 0;
+    for (auto i = 0; i < kNumMessages; ++i) {
+        const FinishedSpan span(
+            tracer, SpanContext(), "test" + std::to_string(i));
+        numFlushed += sender.append(span);
+    }
+    numFlushed += sender.flush();
+
+    constexpr auto kNumTries = 100;
+    auto numSpans = 0;
+    for (auto i = 0; i < kNumTries && numSpans < kNumMessages; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        numSpans = 0;
+        for (auto&& batch : handle->_mockAgent->batches()) {
+            numSpans += static_cast<int>(batch.spans.size());
+        }
+    }
+    ASSERT_EQ(kNumMessages, numSpans);
+
+    // Spans still in flight on the last flush are counted by a later one.
+    for (auto i = 0; i < kNumTries && numFlushed < kNumMessages; ++i) {
+        numFlushed += sender.flush();
+    }
+    ASSERT_EQ(kNumMessages, numFlushed);
+}
+
+TEST(UDPTransport, testSplitsLargeSpans)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    // Small packets, so the logs need several continuations and the values
+    // do not even fit in one.
+    UDPTransport sender(handle->_mockAgent->spanServerAddress(), 512);
+    const std::vector<Tag> fields = { Tag("event", std::string(300, 'x')) };
+    constexpr auto kNumLogs = 5;
+    std::vector<LogRecord> logs;
+    for (auto i = 0; i < kNumLogs; ++i) {
+        logs.emplace_back(
+            LogRecord::Clock::now(), std::begin(fields), std::end(fields));
+    }
+    const SpanContext context(TraceID(1, 2), 3, 0, 1, {});
+    const FinishedSpan span(tracer,
+                            context,
+                            "test",
+                            FinishedSpan::SystemClock::now(),
+                            FinishedSpan::SteadyClock::duration(),
+                            { Tag("key", "value") },
+                            std::move(logs));
+    ASSERT_NO_THROW(sender.append(span));
+    sender.flush();
+
+    // Every log value arrives, if cut into pieces.
+    const std::string expectedValues(kNumLogs * 300, 'x');
+    std::vector<thrift::Span> spans;
+    std::string values;
+    constexpr auto kNumTries = 100;
+    for (auto i = 0; i < kNumTries && values != expectedValues; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        spans.clear();
+        values.clear();
+        for (auto&& batch : handle->_mockAgent->batches()) {
+            for (auto&& received : batch.spans) {
+                spans.push_back(received);
+                for (auto&& log : received.logs) {
+                    for (auto&& field : log.fields) {
+                        values += field.vStr;
+                    }
+                }
+            }
+        }
+    }
+    ASSERT_EQ(expectedValues, values);
+    ASSERT_LE(3U, spans.size());
+
+    const auto& head = spans.front();
+    ASSERT_EQ(3, head.spanId);
+    ASSERT_TRUE(head.logs.empty());
+    ASSERT_EQ(1U, head.tags.size());
+    ASSERT_EQ("key", head.tags[0].key);
+
+    for (auto i = static_cast<std::size_t>(1); i < spans.size(); ++i) {
+        const auto& continuation = spans[i];
+        ASSERT_EQ(head.traceIdLow, continuation.traceIdLow);
+        ASSERT_EQ(3, continuation.parentSpanId);
+        ASSERT_NE(3, continuation.spanId);
+        ASSERT_EQ(kContinuationTagKey, continuation.tags.at(0).key);
+        ASSERT_EQ(static_cast<int64_t>(i), continuation.tags.at(0).vLong);
+        ASSERT_EQ(1U, continuation.references.size());
+        ASSERT_EQ(thrift::SpanRefType::FOLLOWS_FROM,
+                  continuation.references[0].refType);
+    }
+}
+
+TEST(UDPTransport, testSplitsSpanWithoutTracer)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    // The process comes from the global tracer, and continuations still
+    // get span IDs.
+    UDPTransport sender(handle->_mockAgent->spanServerAddress(), 512);
+    const std::vector<Tag> fields = { Tag("event", std::string(600, 'x')) };
+    std::vector<LogRecord> logs;
+    logs.emplace_back(
+        LogRecord::Clock::now(), std::begin(fields), std::end(fields));
+    const FinishedSpan span(nullptr,
+                            SpanContext(TraceID(1, 2), 3, 0, 1, {}),
+                            "test",
+                            FinishedSpan::SystemClock::now(),
+                            FinishedSpan::SteadyClock::duration(),
+                            {},
+                            std::move(logs));
+    ASSERT_NO_THROW(sender.append(span));
+    ASSERT_NO_THROW(sender.flush());
+
+    constexpr auto kNumTries = 100;
+    auto batches = handle->_mockAgent->batches();
+    for (auto i = 0; i < kNumTries && batches.empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        batches = handle->_mockAgent->batches();
+    }
+    ASSERT_FALSE(batches.empty());
+    ASSERT_EQ(tracer->serviceName(), batches[0].process.serviceName);
+}
+
+TEST(UDPTransport, testSendBufferFull)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+
+    MockUDPTransport sender(
+        net::IPAddress(), 512, MockUDPClient::ExceptionType::kWouldBlock);
+    constexpr auto kNumMessages = 30;
+    for (auto i = 0; i < kNumMessages; ++i) {
+        const FinishedSpan span(
+            tracer, SpanContext(), "test" + std::to_string(i));
+        ASSERT_EQ(0, sender.append(span));
+    }
+    try {
+        sender.flush();
+        FAIL() << "flush did not throw";
+    } catch (const Transport::Exception& ex) {
+        ASSERT_LT(0, ex.numSent());
+        ASSERT_EQ(0, ex.numFailed());
+        ASSERT_LT(0, ex.numDropped());
+        ASSERT_EQ(kNumMessages, ex.numSent() + ex.numDropped());
+    }
+    ASSERT_EQ(0, sender.flush());
+}
+
 TEST(UDPTransport, testExceptions)
 {
     const auto handle = testutils::TracerUtil::installGlobalTracer();
     const auto tracer =
         std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
 
-    Span span(tracer);
-    span.SetOperationName("test");
+    const FinishedSpan span(tracer, SpanContext(), "test");
 
     const MockUDPClient::ExceptionType exceptionTypes[] = {
         MockUDPClient::ExceptionType::kSystemError,
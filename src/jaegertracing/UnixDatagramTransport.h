@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UNIXDATAGRAMTRANSPORT_H
+#define JAEGERTRACING_UNIXDATAGRAMTRANSPORT_H
+
+#include <memory>
+#include <string>
+
+#include "jaegertracing/UDPTransport.h"
+#include "jaegertracing/utils/UnixDatagramClient.h"
+
+namespace jaegertracing {
+
+// Sends spans to an agent on the same host as Unix datagrams, packed the
+// same way as over UDP. Larger datagrams fit more spans per system call.
+class UnixDatagramTransport : public UDPTransport {
+  public:
+    UnixDatagramTransport(const std::string& path, int maxPacketSize)
+        : UDPTransport(std::unique_ptr<utils::UDPClient>(
+              new utils::UnixDatagramClient(path, maxPacketSize)))
+    {
+    }
+};
+
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UNIXDATAGRAMTRANSPORT_H
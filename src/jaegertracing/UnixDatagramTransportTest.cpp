@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "jaegertracing/Tracer.h"
+#include "jaegertracing/UnixDatagramTransport.h"
+#include "jaegertracing/reporters/Config.h"
+#include "jaegertracing/testutils/MockAgent.h"
+#include "jaegertracing/testutils/TracerUtil.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace jaegertracing {
+namespace {
+
+std::string socketPath(const std::string& name)
+{
+    return "/tmp/jaeger-" + name + '-' + std::to_string(::getpid()) +
+           ".sock";
+}
+
+std::shared_ptr<testutils::MockAgent> startAgent(const std::string& path)
+{
+    auto agent = testutils::MockAgent::make();
+    agent->listenUnix(path);
+    agent->start();
+    return agent;
+}
+
+std::vector<thrift::Batch> waitForSpans(const testutils::MockAgent& agent,
+                                        int numSpans)
+{
+    constexpr auto kNumTries = 100;
+    std::vector<thrift::Batch> batches;
+    for (auto i = 0; i < kNumTries; ++i) {
+        batches = agent.batches();
+        auto numReceived = 0;
+        for (auto&& batch : batches) {
+            numReceived += static_cast<int>(batch.spans.size());
+        }
+        if (numReceived >= numSpans) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return batches;
+}
+
+}  // anonymous namespace
+
+TEST(UnixDatagramTransport, testAgentReceivesSpans)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+    const auto agent = startAgent(socketPath("receives"));
+
+    // More than fits in a UDP packet, but not in a Unix datagram.
+    UnixDatagramTransport sender(agent->spanServerUnixPath(), 0);
+    constexpr auto kNumMessages = 100;
+    const std::string padding(1000, 'x');
+    for (auto i = 0; i < kNumMessages; ++i) {
+        const FinishedSpan span(
+            tracer, SpanContext(), "test" + std::to_string(i) + padding);
+        ASSERT_EQ(0, sender.append(span));
+    }
+    ASSERT_EQ(kNumMessages, sender.flush());
+
+    const auto batches = waitForSpans(*agent, kNumMessages);
+    ASSERT_EQ(1U, batches.size());
+    ASSERT_EQ(tracer->serviceName(), batches[0].process.serviceName);
+    ASSERT_EQ(kNumMessages, static_cast<int>(batches[0].spans.size()));
+    ASSERT_EQ("test0" + padding, batches[0].spans[0].operationName);
+}
+
+TEST(UnixDatagramTransport, testFlushBeforeAppend)
+{
+    UnixDatagramTransport sender(socketPath("fresh"), 0);
+    ASSERT_EQ(0, sender.flush());
+}
+
+TEST(UnixDatagramTransport, testReconnects)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+    const auto path = socketPath("reconnects");
+    const FinishedSpan span(tracer, SpanContext(), "test");
+
+    // Nothing is listening yet.
+    UnixDatagramTransport sender(path, 0);
+    sender.append(span);
+    ASSERT_THROW(sender.flush(), Transport::Exception);
+
+    for (auto i = 0; i < 2; ++i) {
+        // The second agent replaces the first at the same path.
+        const auto agent = startAgent(path);
+        sender.append(span);
+        ASSERT_EQ(1, sender.flush());
+        ASSERT_EQ(1U, waitForSpans(*agent, 1).size());
+        agent->close();
+    }
+}
+
+TEST(UnixDatagramTransport, testConfig)
+{
+    const auto handle = testutils::TracerUtil::installGlobalTracer();
+    const auto tracer =
+        std::static_pointer_cast<const Tracer>(opentracing::Tracer::Global());
+    const auto agent = startAgent(socketPath("config"));
+
+    const reporters::Config config(
+        0,
+        std::chrono::milliseconds(1),
+        false,
+        reporters::Config::kUnixSocketPrefix + agent->spanServerUnixPath());
+    ASSERT_EQ(agent->spanServerUnixPath(), config.unixSocketPath());
+    ASSERT_EQ("", reporters::Config().unixSocketPath());
+
+    const auto logger = logging::nullLogger();
+    const auto metrics = metrics::Metrics::makeNullMetrics();
+    const auto reporter =
+        config.makeReporter(tracer->serviceName(), *logger, *metrics);
+    reporter->report(
+        std::make_shared<const FinishedSpan>(tracer, SpanContext(), "test"));
+    reporter->close();
+
+    const auto batches = waitForSpans(*agent, 1);
+    ASSERT_EQ(1U, batches.size());
+    ASSERT_EQ("test", batches[0].spans.at(0).operationName);
+}
+
+}  // namespace jaegertracing
@@ -36,7 +36,7 @@ class BaggageSetter {
 
     template <typename LoggingFunction>
     void setBaggage(Span& span,
-                    SpanContext::StrMap& baggage,
+                    Baggage& baggage,
                     const std::string& key,
                     std::string value,
                     LoggingFunction logFn) const
@@ -62,15 +62,9 @@ class BaggageSetter {
             _metrics.baggageTruncate().inc(1);
         }
 
-        auto itr = baggage.find(key);
-        const auto prevItem =
-            (itr == std::end(baggage) ? std::string() : itr->second);
-        if (itr == std::end(baggage)) {
-            baggage[key] = value;
-        }
-        else {
-            itr->second = value;
-        }
+        const auto* prevValue = baggage.find(key);
+        const auto prevItem = prevValue ? *prevValue : std::string();
+        baggage.set(key, value);
         logFields(span,
                   key,
                   value,
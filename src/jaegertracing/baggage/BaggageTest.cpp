@@ -64,11 +64,11 @@ TEST(Baggage, restrictionManagerTest)
     auto baggage = span.context().baggage();
     setter.setBaggage(span, baggage, "abc", "123", logFn);
     ASSERT_EQ(1, baggage.size());
-    ASSERT_EQ("123", baggage["abc"]);
+    ASSERT_EQ(Baggage({ { "abc", "123" } }), baggage);
     setter.setBaggage(span, baggage, "bcd", "234", logFn);
     ASSERT_EQ(1, baggage.size());
     setter.setBaggage(span, baggage, "abc", "1234567890", logFn);
-    ASSERT_EQ("12345678", baggage["abc"]);
+    ASSERT_EQ(Baggage({ { "abc", "12345678" } }), baggage);
 }
 
 TEST(Baggage, testRemoteRestrictionManagerDefaults)
@@ -19,7 +19,6 @@
 #include <sstream>
 
 #include "jaegertracing/baggage/RemoteRestrictionJSON.h"
-#include "jaegertracing/net/http/Response.h"
 #include "jaegertracing/utils/ErrorUtil.h"
 
 namespace jaegertracing {
@@ -46,6 +45,7 @@ RemoteRestrictionManager::RemoteRestrictionManager(
                            : refreshInterval)
     , _logger(logger)
     , _metrics(metrics)
+    , _client()
     , _running(true)
     , _initialized(false)
     , _thread([this]() { poll(); })
@@ -124,7 +124,7 @@ void RemoteRestrictionManager::updateRestrictions(
     const net::URI& remoteURI) noexcept
 {
     try {
-        const auto responseHTTP = net::http::get(remoteURI);
+        const auto responseHTTP = _client.get(remoteURI);
         if (responseHTTP.statusCode() != 200) {
             std::ostringstream oss;
             oss << "Received HTTP error response"
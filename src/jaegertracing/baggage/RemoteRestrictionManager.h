@@ -30,6 +30,7 @@
 #include "jaegertracing/metrics/Metrics.h"
 #include "jaegertracing/net/IPAddress.h"
 #include "jaegertracing/net/URI.h"
+#include "jaegertracing/net/http/Client.h"
 #include "jaegertracing/thrift-gen/BaggageRestrictionManager.h"
 
 namespace jaegertracing {
@@ -76,6 +77,8 @@ class RemoteRestrictionManager : public RestrictionManager {
     Clock::duration _refreshInterval;
     logging::Logger& _logger;
     metrics::Metrics& _metrics;
+    // Only used by the polling thread.
+    net::http::Client _client;
     KeyRestrictionMap _restrictions;
     bool _running;
     bool _initialized;
@@ -25,6 +25,7 @@
 #include "jaegertracing/metrics/StatsFactory.h"
 #include "jaegertracing/metrics/StatsFactoryImpl.h"
 #include "jaegertracing/metrics/StatsReporter.h"
+#include "jaegertracing/metrics/Timer.h"
 
 namespace jaegertracing {
 namespace metrics {
@@ -68,6 +69,8 @@ class Metrics {
         , _reporterDropped(factory.createCounter("jaeger.reporter-spans",
                                                  { { "state", "dropped" } }))
         , _reporterQueueLength(factory.createGauge("jaeger.reporter-queue"))
+        , _reporterQueueWait(factory.createTimer("jaeger.reporter-queue-wait"))
+        , _reporterBatchSize(factory.createGauge("jaeger.reporter-batch-size"))
         , _samplerRetrieved(factory.createCounter("jaeger.sampler",
                                                   { { "state", "retrieved" } }))
         , _samplerUpdated(factory.createCounter("jaeger.sampler",
@@ -90,6 +93,21 @@ class Metrics {
               "jaeger.baggage-restrictions-update", { { "result", "ok" } }))
         , _baggageRestrictionsUpdateFailure(factory.createCounter(
               "jaeger.baggage-restrictions-update", { { "result", "err" } }))
+        , _spanPoolHits(factory.createCounter("jaeger.span-pool",
+                                              { { "result", "hit" } }))
+        , _spanPoolMisses(factory.createCounter("jaeger.span-pool",
+                                                { { "result", "miss" } }))
+        , _spanPoolSize(factory.createGauge("jaeger.span-pool-size"))
+        , _spanLimitedLogs(factory.createCounter("jaeger.span-limited",
+                                                 { { "reason", "logs" } }))
+        , _spanLimitedLogFields(factory.createCounter(
+              "jaeger.span-limited", { { "reason", "log-fields" } }))
+        , _spanLimitedTags(factory.createCounter("jaeger.span-limited",
+                                                 { { "reason", "tags" } }))
+        , _spanLimitedStrings(factory.createCounter(
+              "jaeger.span-limited", { { "reason", "string-length" } }))
+        , _spanLimitedBytes(factory.createCounter("jaeger.span-limited",
+                                                  { { "reason", "bytes" } }))
     {
     }
 
@@ -145,6 +163,16 @@ class Metrics {
 
     Gauge& reporterQueueLength() { return *_reporterQueueLength; }
 
+    // Microseconds a span spent in the reporter queue before being sent.
+    const Timer& reporterQueueWait() const { return *_reporterQueueWait; }
+
+    Timer& reporterQueueWait() { return *_reporterQueueWait; }
+
+    // Number of spans the reporter drained from its queue in one pass.
+    const Gauge& reporterBatchSize() const { return *_reporterBatchSize; }
+
+    Gauge& reporterBatchSize() { return *_reporterBatchSize; }
+
     const Counter& samplerRetrieved() const { return *_samplerRetrieved; }
 
     Counter& samplerRetrieved() { return *_samplerRetrieved; }
@@ -209,6 +237,46 @@ class Metrics {
         return *_baggageRestrictionsUpdateFailure;
     }
 
+    // Spans started with and without memory from the span pool.
+    const Counter& spanPoolHits() const { return *_spanPoolHits; }
+
+    Counter& spanPoolHits() { return *_spanPoolHits; }
+
+    const Counter& spanPoolMisses() const { return *_spanPoolMisses; }
+
+    Counter& spanPoolMisses() { return *_spanPoolMisses; }
+
+    // Spans cached by the starting thread's pool.
+    const Gauge& spanPoolSize() const { return *_spanPoolSize; }
+
+    Gauge& spanPoolSize() { return *_spanPoolSize; }
+
+    // Logs, log fields and tags dropped, and string values cut, by span
+    // limits. Logs and tags dropped to bound the encoded span size count
+    // as bytes.
+    const Counter& spanLimitedLogs() const { return *_spanLimitedLogs; }
+
+    Counter& spanLimitedLogs() { return *_spanLimitedLogs; }
+
+    const Counter& spanLimitedLogFields() const
+    {
+        return *_spanLimitedLogFields;
+    }
+
+    Counter& spanLimitedLogFields() { return *_spanLimitedLogFields; }
+
+    const Counter& spanLimitedTags() const { return *_spanLimitedTags; }
+
+    Counter& spanLimitedTags() { return *_spanLimitedTags; }
+
+    const Counter& spanLimitedStrings() const { return *_spanLimitedStrings; }
+
+    Counter& spanLimitedStrings() { return *_spanLimitedStrings; }
+
+    const Counter& spanLimitedBytes() const { return *_spanLimitedBytes; }
+
+    Counter& spanLimitedBytes() { return *_spanLimitedBytes; }
+
   private:
     std::unique_ptr<Counter> _tracesStartedSampled;
     std::unique_ptr<Counter> _tracesStartedNotSampled;
@@ -223,6 +291,8 @@ class Metrics {
     std::unique_ptr<Counter> _reporterFailure;
     std::unique_ptr<Counter> _reporterDropped;
     std::unique_ptr<Gauge> _reporterQueueLength;
+    std::unique_ptr<Timer> _reporterQueueWait;
+    std::unique_ptr<Gauge> _reporterBatchSize;
     std::unique_ptr<Counter> _samplerRetrieved;
     std::unique_ptr<Counter> _samplerUpdated;
     std::unique_ptr<Counter> _samplerUpdateFailure;
@@ -233,6 +303,14 @@ class Metrics {
     std::unique_ptr<Counter> _baggageTruncate;
     std::unique_ptr<Counter> _baggageRestrictionsUpdateSuccess;
     std::unique_ptr<Counter> _baggageRestrictionsUpdateFailure;
+    std::unique_ptr<Counter> _spanPoolHits;
+    std::unique_ptr<Counter> _spanPoolMisses;
+    std::unique_ptr<Gauge> _spanPoolSize;
+    std::unique_ptr<Counter> _spanLimitedLogs;
+    std::unique_ptr<Counter> _spanLimitedLogFields;
+    std::unique_ptr<Counter> _spanLimitedTags;
+    std::unique_ptr<Counter> _spanLimitedStrings;
+    std::unique_ptr<Counter> _spanLimitedBytes;
 };
 
 }  // namespace metrics
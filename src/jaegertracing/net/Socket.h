@@ -184,6 +184,10 @@ class Socket {
 
 static constexpr auto kUDPPacketMaxLength = 65000;
 
+// Unix datagrams are bounded by the socket send buffer instead, which is
+// 208KiB by default on Linux.
+static constexpr auto kUnixDatagramMaxLength = 128 * 1024;
+
 }  // namespace net
 }  // namespace jaegertracing
 
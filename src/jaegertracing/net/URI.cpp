@@ -17,10 +17,10 @@
 #include "jaegertracing/net/URI.h"
 
 #include <cassert>
+#include <cctype>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
-#include <regex>
 
 namespace jaegertracing {
 namespace net {
@@ -63,40 +63,88 @@ bool isUnreserved(char ch)
 
 }  // anonymous namespace
 
-URI URI::parse(const std::string& uriStr)
+URIView URIView::parse(opentracing::string_view uriStr)
 {
-    // See https://tools.ietf.org/html/rfc3986 for explanation.
-    URI uri;
-    std::regex uriRegex(
-        "^(([^:/?#]+):)?(//([^/?#]*))?([^?#]*)(\\?([^#]*))?(#(.*))?",
-        std::regex::extended);
-    std::smatch match;
-    std::regex_match(uriStr, match, uriRegex);
-
-    constexpr auto kSchemeIndex = 2;
-    constexpr auto kAuthorityIndex = 4;
-    constexpr auto kPathIndex = 5;
-    constexpr auto kQueryIndex = 7;
+    // Splits the string the same way as the regular expression in
+    // https://tools.ietf.org/html/rfc3986#appendix-B.
+    URIView uri;
+    const auto* itr = uriStr.data();
+    const auto* const end = itr + uriStr.size();
 
-    assert(match.size() >= kQueryIndex);
+    const auto* pos = itr;
+    while (pos != end && *pos != ':' && *pos != '/' && *pos != '?' &&
+           *pos != '#') {
+        ++pos;
+    }
+    if (pos != end && pos != itr && *pos == ':') {
+        uri._scheme = opentracing::string_view(itr, pos - itr);
+        itr = pos + 1;
+    }
 
-    uri._scheme = match[kSchemeIndex].str();
+    if (end - itr >= 2 && itr[0] == '/' && itr[1] == '/') {
+        itr += 2;
+        pos = itr;
+        while (pos != end && *pos != '/' && *pos != '?' && *pos != '#') {
+            ++pos;
+        }
+        const auto* colon = itr;
+        while (colon != pos && *colon != ':') {
+            ++colon;
+        }
+        uri._host = opentracing::string_view(itr, colon - itr);
+        if (colon != pos) {
+            uri._port = opentracing::string_view(colon + 1, pos - colon - 1);
+        }
+        itr = pos;
+    }
 
-    const auto authority = match[kAuthorityIndex].str();
-    const auto colonPos = authority.find(':');
-    if (colonPos == std::string::npos) {
-        uri._host = authority;
+    pos = itr;
+    while (pos != end && *pos != '?' && *pos != '#') {
+        ++pos;
     }
-    else {
-        uri._host = authority.substr(0, colonPos);
-        const auto portStr = authority.substr(colonPos + 1);
-        std::istringstream iss(portStr);
-        iss >> uri._port;
+    uri._path = opentracing::string_view(itr, pos - itr);
+    itr = pos;
+
+    if (itr != end && *itr == '?') {
+        ++itr;
+        pos = itr;
+        while (pos != end && *pos != '#') {
+            ++pos;
+        }
+        uri._query = opentracing::string_view(itr, pos - itr);
     }
 
-    uri._path = match[kPathIndex].str();
-    uri._query = match[kQueryIndex].str();
+    return uri;
+}
+
+int URIView::port() const
+{
+    // Same result as reading an int from a stream.
+    auto i = static_cast<std::size_t>(0);
+    while (i < _port.size() && std::isspace(_port[i])) {
+        ++i;
+    }
+    auto sign = 1;
+    if (i < _port.size() && (_port[i] == '+' || _port[i] == '-')) {
+        sign = (_port[i] == '-') ? -1 : 1;
+        ++i;
+    }
+    auto port = 0;
+    for (; i < _port.size() && std::isdigit(_port[i]); ++i) {
+        port = port * 10 + (_port[i] - '0');
+    }
+    return sign * port;
+}
 
+URI URI::parse(opentracing::string_view uriStr)
+{
+    const auto view = URIView::parse(uriStr);
+    URI uri;
+    uri._scheme.assign(view._scheme.data(), view._scheme.size());
+    uri._host.assign(view._host.data(), view._host.size());
+    uri._port = view.port();
+    uri._path.assign(view._path.data(), view._path.size());
+    uri._query.assign(view._query.data(), view._query.size());
     return uri;
 }
 
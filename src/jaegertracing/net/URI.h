@@ -23,13 +23,30 @@
 #include <string>
 #include <unordered_map>
 
+#include <opentracing/string_view.h>
+
 namespace jaegertracing {
 namespace net {
 
+// URI components pointing into the parsed string, which must outlive the
+// view.
+struct URIView {
+    static URIView parse(opentracing::string_view uriStr);
+
+    // Port number, or zero if the URI has none.
+    int port() const;
+
+    opentracing::string_view _scheme;
+    opentracing::string_view _host;
+    opentracing::string_view _port;
+    opentracing::string_view _path;
+    opentracing::string_view _query;
+};
+
 struct URI {
     using QueryValueMap = std::unordered_multimap<std::string, std::string>;
 
-    static URI parse(const std::string& uriStr);
+    static URI parse(opentracing::string_view uriStr);
 
     static std::string queryEscape(const std::string& input);
 
@@ -15,9 +15,13 @@
  */
 
 #include "jaegertracing/net/URI.h"
+#include <chrono>
 #include <gtest/gtest.h>
 #include <iosfwd>
+#include <iostream>
 #include <iterator>
+#include <regex>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -31,6 +35,83 @@ TEST(URI, testMatch)
     ASSERT_EQ(80, URI::parse("http://localhost:80")._port);
 }
 
+TEST(URI, testParse)
+{
+    struct Expected {
+        const char* _uri;
+        const char* _scheme;
+        const char* _host;
+        int _port;
+        const char* _path;
+        const char* _query;
+    };
+    for (auto&& expected : {
+             Expected{ "http://localhost:5778/sampling?service=test#top",
+                       "http",
+                       "localhost",
+                       5778,
+                       "/sampling",
+                       "service=test" },
+             Expected{ "localhost", "", "", 0, "localhost", "" },
+             Expected{ "127.0.0.1:5778", "127.0.0.1", "", 0, "5778", "" },
+             Expected{ "//host/path", "", "host", 0, "/path", "" },
+             Expected{ "http://host:/path", "http", "host", 0, "/path", "" },
+             Expected{ "?query", "", "", 0, "", "query" },
+             Expected{ "", "", "", 0, "", "" } }) {
+        const auto uri = URI::parse(expected._uri);
+        ASSERT_EQ(expected._scheme, uri._scheme) << expected._uri;
+        ASSERT_EQ(expected._host, uri._host) << expected._uri;
+        ASSERT_EQ(expected._port, uri._port) << expected._uri;
+        ASSERT_EQ(expected._path, uri._path) << expected._uri;
+        ASSERT_EQ(expected._query, uri._query) << expected._uri;
+    }
+
+    const std::string uriStr("http://localhost:5778/sampling?service=test");
+    const auto view = URIView::parse(uriStr);
+    ASSERT_EQ("http", std::string(view._scheme));
+    ASSERT_EQ("localhost", std::string(view._host));
+    ASSERT_EQ(5778, view.port());
+    ASSERT_EQ("/sampling", std::string(view._path));
+    ASSERT_EQ("service=test", std::string(view._query));
+}
+
+// Benchmark against the regular expression URI::parse replaced, run with
+// --gtest_also_run_disabled_tests.
+TEST(URI, DISABLED_testParsePerformance)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr auto kNumIterations = 10000;
+    const std::string uriStr("http://localhost:5778/sampling?service=test");
+
+    const auto regexStart = Clock::now();
+    for (auto i = 0; i < kNumIterations; ++i) {
+        std::regex uriRegex(
+            "^(([^:/?#]+):)?(//([^/?#]*))?([^?#]*)(\\?([^#]*))?(#(.*))?",
+            std::regex::extended);
+        std::smatch match;
+        ASSERT_TRUE(std::regex_match(uriStr, match, uriRegex));
+        const auto authority = match[4].str();
+        const auto colonPos = authority.find(':');
+        auto port = 0;
+        std::istringstream(authority.substr(colonPos + 1)) >> port;
+        ASSERT_EQ(5778, port);
+    }
+    const auto regexTime = Clock::now() - regexStart;
+
+    const auto parseStart = Clock::now();
+    for (auto i = 0; i < kNumIterations; ++i) {
+        ASSERT_EQ(5778, URI::parse(uriStr)._port);
+    }
+    const auto parseTime = Clock::now() - parseStart;
+
+    using std::chrono::microseconds;
+    std::cout << "Parsed " << kNumIterations << " URIs: regex "
+              << std::chrono::duration_cast<microseconds>(regexTime).count()
+              << "us, URI::parse "
+              << std::chrono::duration_cast<microseconds>(parseTime).count()
+              << "us\n";
+}
+
 TEST(URI, testAuthority)
 {
     ASSERT_EQ("localhost", URI::parse("http://localhost").authority());
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/net/http/Client.h"
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <system_error>
+
+#include "jaegertracing/Constants.h"
+#include "jaegertracing/net/http/ResponseParser.h"
+
+namespace jaegertracing {
+namespace net {
+namespace http {
+namespace {
+
+constexpr auto kReadSize = 4096;
+constexpr auto kDefaultPort = 80;
+
+#ifdef MSG_NOSIGNAL
+constexpr auto kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr auto kSendFlags = 0;
+#endif
+
+bool equalsIgnoreCase(const std::string& lhs, const std::string& rhs)
+{
+    return lhs.size() == rhs.size() &&
+           std::equal(std::begin(lhs),
+                      std::end(lhs),
+                      std::begin(rhs),
+                      [](char a, char b) {
+                          return std::tolower(a) == std::tolower(b);
+                      });
+}
+
+const Header* findHeader(const std::vector<Header>& headers,
+                         const std::string& key)
+{
+    for (auto&& header : headers) {
+        if (equalsIgnoreCase(header.key(), key)) {
+            return &header;
+        }
+    }
+    return nullptr;
+}
+
+// Thrown when a reused connection turns out to have been closed by the
+// server before it sent anything back.
+struct StaleConnection {
+};
+
+}  // anonymous namespace
+
+Client::Client(const Clock::duration& timeout)
+    : _timeout(timeout)
+    , _socket()
+    , _connected(false)
+    , _authority()
+    , _address()
+    , _readBuffer()
+{
+}
+
+Response Client::request(const char* method,
+                         const URI& uri,
+                         const std::vector<Header>& headers,
+                         const std::string& body)
+{
+    std::ostringstream oss;
+    oss << method << ' ' << uri.target() << " HTTP/1.1\r\n"
+        << "Host: " << uri.authority() << "\r\n"
+        << "User-Agent: jaegertracing/" << kJaegerClientVersion << "\r\n";
+    for (auto&& header : headers) {
+        oss << header.key() << ": " << header.value() << "\r\n";
+    }
+    if (!body.empty() || std::string(method) == "POST") {
+        oss << "Content-Length: " << body.size() << "\r\n";
+    }
+    oss << "\r\n";
+    auto requestStr = oss.str();
+    requestStr.append(body);
+
+    const auto reused = _connected && _authority == uri.authority();
+    if (reused) {
+        try {
+            return exchange(requestStr, true);
+        } catch (const StaleConnection&) {
+            // The server dropped the idle connection before it saw the
+            // request, retry once on a new one.
+        }
+    }
+    connect(uri);
+    return exchange(requestStr, false);
+}
+
+Response Client::exchange(const std::string& request, bool reused)
+{
+    try {
+        writeAll(request);
+    } catch (const std::system_error& ex) {
+        close();
+        // The server never got the whole request, so it is safe to resend.
+        if (reused && (ex.code() == std::errc::broken_pipe ||
+                       ex.code() == std::errc::connection_reset)) {
+            throw StaleConnection();
+        }
+        throw;
+    } catch (...) {
+        close();
+        throw;
+    }
+
+    try {
+        return readResponse();
+    } catch (const StaleConnection&) {
+        close();
+        if (reused) {
+            throw;
+        }
+        throw std::runtime_error("Connection closed before response");
+    } catch (...) {
+        // Do not resend a request the server may already be handling.
+        close();
+        throw;
+    }
+}
+
+void Client::connect(const URI& uri)
+{
+    close();
+    const auto authority = uri.authority();
+    if (_authority == authority) {
+        try {
+            connect(_address);
+            return;
+        } catch (const std::exception&) {
+            // The cached address may be stale, resolve it again below.
+            close();
+        }
+    }
+
+    _authority.clear();
+    const auto port = (uri._port != 0) ? uri._port : kDefaultPort;
+    const auto result = resolveAddress(uri._host, port, AF_INET);
+    for (const auto* itr = result.get(); itr; itr = itr->ai_next) {
+        const IPAddress address(*itr->ai_addr, itr->ai_addrlen);
+        try {
+            connect(address);
+            _authority = authority;
+            _address = address;
+            return;
+        } catch (const std::exception&) {
+            close();
+        }
+    }
+    std::ostringstream oss;
+    oss << "Cannot connect socket to remote address " << uri;
+    throw std::runtime_error(oss.str());
+}
+
+void Client::connect(const IPAddress& address)
+{
+    _socket.open(AF_INET, SOCK_STREAM);
+    const auto micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(_timeout)
+            .count();
+    ::timeval timeout;
+    timeout.tv_sec = micros / 1000000;
+    timeout.tv_usec = micros % 1000000;
+    // On Linux the send timeout also bounds connect.
+    ::setsockopt(_socket.handle(),
+                 SOL_SOCKET,
+                 SO_RCVTIMEO,
+                 &timeout,
+                 sizeof(timeout));
+    ::setsockopt(_socket.handle(),
+                 SOL_SOCKET,
+                 SO_SNDTIMEO,
+                 &timeout,
+                 sizeof(timeout));
+    _socket.connect(address);
+    _connected = true;
+}
+
+void Client::writeAll(const std::string& data)
+{
+    auto offset = static_cast<std::size_t>(0);
+    while (offset < data.size()) {
+        const auto numWritten = ::send(_socket.handle(),
+                                       data.data() + offset,
+                                       data.size() - offset,
+                                       kSendFlags);
+        if (numWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                throw std::system_error(
+                    std::make_error_code(std::errc::timed_out),
+                    "Timed out writing HTTP request");
+            }
+            throw std::system_error(
+                errno, std::system_category(), "Failed to write HTTP request");
+        }
+        offset += numWritten;
+    }
+}
+
+std::size_t Client::read(char* buffer, std::size_t size)
+{
+    while (true) {
+        const auto numRead = ::recv(_socket.handle(), buffer, size, 0);
+        if (numRead >= 0) {
+            return numRead;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            throw std::system_error(
+                std::make_error_code(std::errc::timed_out),
+                "Timed out reading HTTP response");
+        }
+        if (errno != EINTR) {
+            throw std::system_error(
+                errno, std::system_category(), "Failed to read HTTP response");
+        }
+    }
+}
+
+Response Client::readResponse()
+{
+    ResponseParser parser;
+    const auto numBuffered =
+        parser.parse(_readBuffer.data(), _readBuffer.size());
+    _readBuffer.erase(0, numBuffered);
+
+    char buffer[kReadSize];
+    while (!parser.done()) {
+        const auto numRead = read(buffer, sizeof(buffer));
+        if (numRead == 0) {
+            if (!parser.started()) {
+                throw StaleConnection();
+            }
+            parser.finish();
+            break;
+        }
+        const auto numParsed = parser.parse(buffer, numRead);
+        // Keep anything past the end of the response.
+        _readBuffer.append(buffer + numParsed, numRead - numParsed);
+    }
+
+    const auto* connection =
+        findHeader(parser.response().headers(), "Connection");
+    if (parser.closeDelimited() ||
+        (connection && equalsIgnoreCase(connection->value(), "close"))) {
+        close();
+    }
+    return std::move(parser.response());
+}
+
+}  // namespace http
+}  // namespace net
+}  // namespace jaegertracing
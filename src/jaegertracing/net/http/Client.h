@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_NET_HTTP_CLIENT_H
+#define JAEGERTRACING_NET_HTTP_CLIENT_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "jaegertracing/net/IPAddress.h"
+#include "jaegertracing/net/Socket.h"
+#include "jaegertracing/net/URI.h"
+#include "jaegertracing/net/http/Header.h"
+#include "jaegertracing/net/http/Response.h"
+
+namespace jaegertracing {
+namespace net {
+namespace http {
+
+// HTTP/1.1 client that keeps its connection open between requests. A
+// request to a different authority than the previous one, or a response
+// with "Connection: close", opens a new connection. The address of the
+// authority is resolved once and reused until connecting to it fails.
+// Not thread-safe.
+class Client {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static Clock::duration defaultTimeout() { return std::chrono::seconds(5); }
+
+    // `timeout` bounds connecting and each individual socket read or write.
+    explicit Client(const Clock::duration& timeout = defaultTimeout());
+
+    Client(const Client&) = delete;
+
+    Client& operator=(const Client&) = delete;
+
+    ~Client() { close(); }
+
+    Response get(const URI& uri,
+                 const std::vector<Header>& headers = std::vector<Header>())
+    {
+        return request("GET", uri, headers, std::string());
+    }
+
+    Response post(const URI& uri,
+                  const std::vector<Header>& headers,
+                  const std::string& body)
+    {
+        return request("POST", uri, headers, body);
+    }
+
+    void close() noexcept
+    {
+        _socket.close();
+        _connected = false;
+        _readBuffer.clear();
+    }
+
+  private:
+    Response request(const char* method,
+                     const URI& uri,
+                     const std::vector<Header>& headers,
+                     const std::string& body);
+
+    void connect(const URI& uri);
+
+    void connect(const IPAddress& address);
+
+    // Writes `request` and reads the response. On a `reused` connection,
+    // failures that show the server closed it before getting the whole
+    // request throw StaleConnection, which the caller retries.
+    Response exchange(const std::string& request, bool reused);
+
+    void writeAll(const std::string& data);
+
+    // Reads into `buffer`. Returns zero at end of stream.
+    std::size_t read(char* buffer, std::size_t size);
+
+    Response readResponse();
+
+    Clock::duration _timeout;
+    Socket _socket;
+    bool _connected;
+    // Authority of the current connection, and of the cached address.
+    std::string _authority;
+    IPAddress _address;
+    // Bytes read from the socket past the end of the last response.
+    std::string _readBuffer;
+};
+
+}  // namespace http
+}  // namespace net
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_NET_HTTP_CLIENT_H
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/net/IPAddress.h"
+#include "jaegertracing/net/Socket.h"
+#include "jaegertracing/net/URI.h"
+#include "jaegertracing/net/http/Client.h"
+#include <atomic>
+#include <functional>
+#include <gtest/gtest.h>
+#include <string>
+#include <sys/socket.h>
+#include <system_error>
+#include <thread>
+
+namespace jaegertracing {
+namespace net {
+namespace http {
+namespace {
+
+// Reads one request head from `socket`, ignoring any body.
+bool readRequest(Socket& socket)
+{
+    std::string request;
+    char buffer[256];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        const auto numRead = ::recv(socket.handle(), buffer, sizeof(buffer), 0);
+        if (numRead <= 0) {
+            return false;
+        }
+        request.append(buffer, numRead);
+    }
+    return true;
+}
+
+void writeResponse(Socket& socket, const std::string& response)
+{
+    ::send(socket.handle(), response.data(), response.size(), 0);
+}
+
+// Accepts `numConnections` connections in turn and passes each one to
+// `handler`.
+class TestServer {
+  public:
+    using Handler = std::function<void(Socket&)>;
+
+    TestServer(int numConnections, Handler handler)
+        : _numAccepted(0)
+    {
+        _socket.open(AF_INET, SOCK_STREAM);
+        _socket.bind(IPAddress::v4("127.0.0.1", 0));
+        _socket.listen();
+        ::sockaddr_storage addrStorage;
+        ::socklen_t addrLen = sizeof(addrStorage);
+        ::getsockname(_socket.handle(),
+                      reinterpret_cast<::sockaddr*>(&addrStorage),
+                      &addrLen);
+        _address = IPAddress(addrStorage, addrLen);
+        _thread = std::thread([this, numConnections, handler]() {
+            for (auto i = 0; i < numConnections; ++i) {
+                auto clientSocket = _socket.accept();
+                ++_numAccepted;
+                handler(clientSocket);
+            }
+        });
+    }
+
+    ~TestServer() { join(); }
+
+    void join()
+    {
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    URI uri() const { return URI::parse("http://" + _address.authority()); }
+
+    int numAccepted() const { return _numAccepted; }
+
+  private:
+    Socket _socket;
+    IPAddress _address;
+    std::atomic<int> _numAccepted;
+    std::thread _thread;
+};
+
+}  // anonymous namespace
+
+TEST(Client, testReusesConnection)
+{
+    constexpr auto kNumRequests = 3;
+    TestServer server(1, [](Socket& socket) {
+        for (auto i = 0; i < kNumRequests; ++i) {
+            ASSERT_TRUE(readRequest(socket));
+            writeResponse(socket,
+                          "HTTP/1.1 200 OK\r\nContent-Length: " +
+                              std::to_string(i + 1) + "\r\n\r\n" +
+                              std::string(i + 1, 'x'));
+        }
+    });
+
+    Client client;
+    for (auto i = 0; i < kNumRequests; ++i) {
+        const auto response = client.get(server.uri());
+        ASSERT_EQ(200, response.statusCode());
+        ASSERT_EQ(std::string(i + 1, 'x'), response.body());
+    }
+    client.close();
+    server.join();
+    ASSERT_EQ(1, server.numAccepted());
+}
+
+TEST(Client, testChunkedBody)
+{
+    TestServer server(1, [](Socket& socket) {
+        ASSERT_TRUE(readRequest(socket));
+        writeResponse(socket,
+                      "HTTP/1.1 200 OK\r\n"
+                      "Transfer-Encoding: chunked\r\n\r\n"
+                      "5\r\nhello\r\n"
+                      "7;ext=1\r\n, world\r\n"
+                      "0\r\n"
+                      "Trailer: value\r\n\r\n");
+        // Response is complete, so the same connection serves another.
+        ASSERT_TRUE(readRequest(socket));
+        writeResponse(socket, "HTTP/1.1 204 No Content\r\n\r\n");
+    });
+
+    Client client;
+    ASSERT_EQ("hello, world", client.get(server.uri()).body());
+    ASSERT_EQ(204, client.get(server.uri()).statusCode());
+    client.close();
+    server.join();
+    ASSERT_EQ(1, server.numAccepted());
+}
+
+TEST(Client, testReconnects)
+{
+    std::atomic<bool> closed(false);
+    TestServer server(2, [&closed](Socket& socket) {
+        ASSERT_TRUE(readRequest(socket));
+        writeResponse(socket, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+        // Close while the client holds the connection idle.
+        socket.close();
+        closed = true;
+    });
+
+    Client client;
+    ASSERT_EQ("ok", client.get(server.uri()).body());
+    // A request racing the close may be reset after it was sent, which is
+    // not retried.
+    while (!closed) {
+        std::this_thread::yield();
+    }
+    ASSERT_EQ("ok", client.get(server.uri()).body());
+    server.join();
+    ASSERT_EQ(2, server.numAccepted());
+}
+
+TEST(Client, testTimeout)
+{
+    std::atomic<bool> done(false);
+    TestServer server(1, [&done](Socket& socket) {
+        readRequest(socket);
+        while (!done) {
+            std::this_thread::yield();
+        }
+    });
+
+    Client client(std::chrono::milliseconds(100));
+    try {
+        client.get(server.uri());
+        FAIL() << "Expected timeout";
+    } catch (const std::system_error& ex) {
+        ASSERT_EQ(std::make_error_code(std::errc::timed_out), ex.code());
+    }
+    done = true;
+}
+
+TEST(Client, testNoRetryAfterReset)
+{
+    TestServer server(1, [](Socket& socket) {
+        ASSERT_TRUE(readRequest(socket));
+        writeResponse(socket, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+        // Reset the connection once the second request arrived, so the
+        // client cannot tell whether it was handled.
+        ASSERT_TRUE(readRequest(socket));
+        ::linger lingerOption;
+        lingerOption.l_onoff = 1;
+        lingerOption.l_linger = 0;
+        ::setsockopt(socket.handle(),
+                     SOL_SOCKET,
+                     SO_LINGER,
+                     &lingerOption,
+                     sizeof(lingerOption));
+        socket.close();
+    });
+
+    Client client(std::chrono::milliseconds(500));
+    ASSERT_EQ("ok", client.get(server.uri()).body());
+    try {
+        client.get(server.uri());
+        FAIL() << "Expected connection reset";
+    } catch (const std::system_error& ex) {
+        ASSERT_TRUE(ex.code() == std::errc::connection_reset);
+    }
+    server.join();
+    ASSERT_EQ(1, server.numAccepted());
+}
+
+TEST(Client, testWriteTimeout)
+{
+    std::atomic<bool> done(false);
+    TestServer server(1, [&done](Socket&) {
+        // Never read, so the client fills the socket buffers.
+        while (!done) {
+            std::this_thread::yield();
+        }
+    });
+
+    constexpr auto kBodySize = 64 * 1024 * 1024;
+    Client client(std::chrono::milliseconds(100));
+    try {
+        client.post(server.uri(), {}, std::string(kBodySize, 'x'));
+        FAIL() << "Expected timeout";
+    } catch (const std::system_error& ex) {
+        ASSERT_EQ(std::make_error_code(std::errc::timed_out), ex.code());
+    }
+    done = true;
+}
+
+}  // namespace http
+}  // namespace net
+}  // namespace jaegertracing
@@ -18,8 +18,10 @@
 #define JAEGERTRACING_NET_HTTP_HEADER_H
 
 #include <cassert>
-#include <regex>
+#include <istream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "jaegertracing/net/http/Error.h"
 
@@ -49,45 +51,51 @@ class Header {
 inline std::istream& readLineCRLF(std::istream& in, std::string& line)
 {
     line.clear();
-    auto ch = '\0';
-    auto sawCR = false;
-    while (in.get(ch)) {
-        if (sawCR) {
-            if (ch == '\n') {
-                break;
-            }
-            else {
-                line.push_back('\r');
-                line.push_back(ch);
-                sawCR = false;
-            }
+    std::string segment;
+    while (std::getline(in, segment)) {
+        if (!segment.empty() && segment.back() == '\r') {
+            segment.pop_back();
+            line.append(segment);
+            break;
         }
-        else {
-            if (ch == '\r') {
-                sawCR = true;
-            }
-            else {
-                line.push_back(ch);
-            }
+        if (in.eof()) {
+            // Incomplete line at end of stream.
+            line.append(segment);
+            in.setstate(std::ios::failbit);
+            break;
         }
+        // A lone LF does not end the line.
+        line.append(segment);
+        line.push_back('\n');
     }
-
     return in;
 }
 
+// Parses a "key: value" header line. Returns false if it is malformed.
+inline bool parseHeader(const std::string& line, Header& header)
+{
+    const auto colonPos = line.find(':');
+    if (colonPos == 0 || colonPos == std::string::npos ||
+        colonPos + 2 >= line.size() || line[colonPos + 1] != ' ' ||
+        line.find_first_of("\r\n", colonPos + 2) != std::string::npos) {
+        return false;
+    }
+    header = Header(line.substr(0, colonPos), line.substr(colonPos + 2));
+    return true;
+}
+
 inline void readHeaders(std::istream& in, std::vector<Header>& headers)
 {
-    const std::regex headerPattern("([^:]+): (.+)$");
     std::string line;
-    std::smatch match;
+    Header header;
     while (readLineCRLF(in, line)) {
         if (line.empty()) {
             break;
         }
-        if (!std::regex_match(line, match, headerPattern) || match.size() < 3) {
+        if (!parseHeader(line, header)) {
             throw ParseError::make("header", line);
         }
-        headers.emplace_back(Header(match[1], match[2]));
+        headers.emplace_back(std::move(header));
     }
 }
 
@@ -16,34 +16,56 @@
 
 #include "jaegertracing/net/http/Response.h"
 
-#include <unistd.h>
-
+#include <cctype>
 #include <iostream>
-#include <regex>
+#include <iterator>
 #include <sstream>
 #include <stdexcept>
 
-#include "jaegertracing/Constants.h"
-#include "jaegertracing/net/Socket.h"
+#include "jaegertracing/net/http/Client.h"
 
 namespace jaegertracing {
 namespace net {
 namespace http {
 
+bool Response::parseStatusLine(const std::string& line, Response& response)
+{
+    constexpr auto kPrefix = "HTTP/";
+    constexpr auto kPrefixLength = 5;
+    // "HTTP/" digit '.' digit ' '
+    constexpr auto kCodeOffset = kPrefixLength + 4;
+    if (line.size() <= kCodeOffset ||
+        line.compare(0, kPrefixLength, kPrefix) != 0 ||
+        !std::isdigit(line[kPrefixLength]) || line[kPrefixLength + 1] != '.' ||
+        !std::isdigit(line[kPrefixLength + 2]) ||
+        line[kPrefixLength + 3] != ' ') {
+        return false;
+    }
+
+    auto pos = static_cast<std::size_t>(kCodeOffset);
+    auto statusCode = 0;
+    while (pos < line.size() && std::isdigit(line[pos])) {
+        statusCode = statusCode * 10 + (line[pos] - '0');
+        ++pos;
+    }
+    if (pos == kCodeOffset || pos + 1 >= line.size() || line[pos] != ' ' ||
+        line.find_first_of("\r\n", pos + 1) != std::string::npos) {
+        return false;
+    }
+
+    response._version = line.substr(kPrefixLength, 3);
+    response._statusCode = statusCode;
+    response._reason = line.substr(pos + 1);
+    return true;
+}
+
 Response Response::parse(std::istream& in)
 {
-    const std::regex statusLinePattern("HTTP/([0-9]\\.[0-9]) ([0-9]+) (.+)$");
     std::string line;
-    std::smatch match;
-    if (!readLineCRLF(in, line) ||
-        !std::regex_match(line, match, statusLinePattern) || match.size() < 4) {
+    Response response;
+    if (!readLineCRLF(in, line) || !parseStatusLine(line, response)) {
         throw ParseError::make("status line", line);
     }
-    Response response;
-    response._version = match[1];
-    std::istringstream iss(match[2]);
-    iss >> response._statusCode;
-    response._reason = match[3];
 
     readHeaders(in, response._headers);
 
@@ -55,38 +77,8 @@ Response Response::parse(std::istream& in)
 
 Response get(const URI& uri)
 {
-    Socket socket;
-    socket.open(AF_INET, SOCK_STREAM);
-    socket.connect(uri);
-    std::ostringstream requestStream;
-    requestStream << "GET " << uri.target() << " HTTP/1.1\r\n"
-                  << "Host: " << uri.authority()
-                  << "\r\n"
-                     "User-Agent: jaegertracing/"
-                  << kJaegerClientVersion << "\r\n\r\n";
-    const auto request = requestStream.str();
-    const auto numWritten =
-        ::write(socket.handle(), request.c_str(), request.size());
-    if (numWritten != static_cast<int>(request.size())) {
-        std::ostringstream oss;
-        oss << "Failed to write entire HTTP request"
-            << ", uri=" << uri << ", request=" << request;
-        throw std::system_error(errno, std::system_category(), oss.str());
-    }
-
-    constexpr auto kBufferSize = 256;
-    std::array<char, kBufferSize> buffer;
-    auto numRead = ::read(socket.handle(), &buffer[0], buffer.size());
-    std::string response;
-    while (numRead > 0) {
-        response.append(&buffer[0], numRead);
-        if (numRead < static_cast<int>(buffer.size())) {
-            break;
-        }
-        numRead = ::read(socket.handle(), &buffer[0], buffer.size());
-    }
-    std::istringstream responseStream(response);
-    return Response::parse(responseStream);
+    Client client;
+    return client.get(uri);
 }
 
 }  // namespace http
@@ -48,6 +48,12 @@ class Response {
     const std::string& body() const { return _body; }
 
   private:
+    friend class ResponseParser;
+
+    // Parses "HTTP/<version> <status code> <reason>". Returns false if the
+    // line is malformed.
+    static bool parseStatusLine(const std::string& line, Response& response);
+
     std::string _version;
     int _statusCode;
     std::string _reason;
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/net/http/ResponseParser.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace jaegertracing {
+namespace net {
+namespace http {
+namespace {
+
+bool equalsIgnoreCase(const std::string& lhs, const char* rhs)
+{
+    const auto size = std::strlen(rhs);
+    if (lhs.size() != size) {
+        return false;
+    }
+    for (auto i = static_cast<std::size_t>(0); i < size; ++i) {
+        if (std::tolower(lhs[i]) != std::tolower(rhs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool hasNoBody(int statusCode)
+{
+    return (statusCode >= 100 && statusCode < 200) || statusCode == 204 ||
+           statusCode == 304;
+}
+
+}  // anonymous namespace
+
+constexpr int ResponseParser::kMaxLineLength;
+
+ResponseParser::ResponseParser()
+    : _state(State::kStatusLine)
+    , _response()
+    , _line()
+    , _lineComplete(false)
+    , _remaining(0)
+    , _started(false)
+    , _closeDelimited(false)
+{
+}
+
+std::size_t ResponseParser::parse(const char* data, std::size_t size)
+{
+    const auto* itr = data;
+    const auto* const end = data + size;
+    _started = _started || size > 0;
+    while (itr != end && _state != State::kDone) {
+        switch (_state) {
+        case State::kStatusLine: {
+            if (readLine(itr, end)) {
+                if (!Response::parseStatusLine(_line, _response)) {
+                    throw ParseError::make("status line", _line);
+                }
+                _state = State::kHeaders;
+            }
+        } break;
+        case State::kHeaders: {
+            if (readLine(itr, end)) {
+                if (_line.empty()) {
+                    startBody();
+                }
+                else {
+                    Header header;
+                    if (!parseHeader(_line, header)) {
+                        throw ParseError::make("header", _line);
+                    }
+                    _response._headers.emplace_back(std::move(header));
+                }
+            }
+        } break;
+        case State::kBody:
+        case State::kChunkData: {
+            const auto numBytes = std::min<std::size_t>(_remaining, end - itr);
+            _response._body.append(itr, numBytes);
+            itr += numBytes;
+            _remaining -= numBytes;
+            if (_remaining == 0) {
+                _state = (_state == State::kBody) ? State::kDone
+                                                  : State::kChunkDataEnd;
+            }
+        } break;
+        case State::kBodyUntilClose: {
+            _response._body.append(itr, end);
+            itr = end;
+        } break;
+        case State::kChunkSize: {
+            if (readLine(itr, end)) {
+                // Chunk extensions after the size are ignored.
+                char* sizeEnd = nullptr;
+                _remaining = static_cast<std::size_t>(
+                    std::strtoull(_line.c_str(), &sizeEnd, 16));
+                if (sizeEnd == _line.c_str()) {
+                    throw ParseError::make("chunk size", _line);
+                }
+                _state = (_remaining == 0) ? State::kTrailers
+                                           : State::kChunkData;
+            }
+        } break;
+        case State::kChunkDataEnd: {
+            if (readLine(itr, end)) {
+                if (!_line.empty()) {
+                    throw ParseError::make("CRLF after chunk", _line);
+                }
+                _state = State::kChunkSize;
+            }
+        } break;
+        default: {
+            assert(_state == State::kTrailers);
+            if (readLine(itr, end) && _line.empty()) {
+                _state = State::kDone;
+            }
+        } break;
+        }
+    }
+    return itr - data;
+}
+
+void ResponseParser::finish()
+{
+    if (_state == State::kBodyUntilClose) {
+        _state = State::kDone;
+    }
+    if (_state != State::kDone) {
+        throw ParseError("Connection closed before end of HTTP response");
+    }
+}
+
+bool ResponseParser::readLine(const char*& itr, const char* end)
+{
+    if (_lineComplete) {
+        _line.clear();
+        _lineComplete = false;
+    }
+    while (itr != end) {
+        const auto* newline =
+            static_cast<const char*>(std::memchr(itr, '\n', end - itr));
+        const auto* lineEnd = newline ? newline + 1 : end;
+        _line.append(itr, lineEnd);
+        itr = lineEnd;
+        if (_line.size() > static_cast<std::size_t>(kMaxLineLength)) {
+            throw ParseError::make("shorter line", _line.substr(0, 64));
+        }
+        // A lone LF does not end the line.
+        if (newline && _line.size() >= 2 && _line[_line.size() - 2] == '\r') {
+            _line.resize(_line.size() - 2);
+            _lineComplete = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ResponseParser::startBody()
+{
+    const Header* contentLength = nullptr;
+    const Header* transferEncoding = nullptr;
+    for (auto&& header : _response._headers) {
+        if (equalsIgnoreCase(header.key(), "Content-Length")) {
+            contentLength = &header;
+        }
+        else if (equalsIgnoreCase(header.key(), "Transfer-Encoding")) {
+            transferEncoding = &header;
+        }
+    }
+
+    if (hasNoBody(_response.statusCode())) {
+        _state = State::kDone;
+    }
+    else if (transferEncoding &&
+             !equalsIgnoreCase(transferEncoding->value(), "identity")) {
+        _state = State::kChunkSize;
+    }
+    else if (contentLength) {
+        _remaining = static_cast<std::size_t>(
+            std::strtoull(contentLength->value().c_str(), nullptr, 10));
+        _state = (_remaining == 0) ? State::kDone : State::kBody;
+    }
+    else {
+        _state = State::kBodyUntilClose;
+        _closeDelimited = true;
+    }
+}
+
+}  // namespace http
+}  // namespace net
+}  // namespace jaegertracing
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_NET_HTTP_RESPONSEPARSER_H
+#define JAEGERTRACING_NET_HTTP_RESPONSEPARSER_H
+
+#include <cstddef>
+#include <string>
+
+#include "jaegertracing/net/http/Error.h"
+#include "jaegertracing/net/http/Response.h"
+
+namespace jaegertracing {
+namespace net {
+namespace http {
+
+// Incremental parser for one HTTP/1.1 response. Feed it data as it is read
+// from the socket; it handles Content-Length, chunked and close-delimited
+// bodies without needing the whole response in one buffer.
+class ResponseParser {
+  public:
+    // Longest status, header or chunk size line accepted.
+    static constexpr auto kMaxLineLength = 64 * 1024;
+
+    ResponseParser();
+
+    // Consumes data up to the end of the response and returns how much was
+    // consumed. Bytes past the end of the response are left for the caller.
+    // Throws ParseError on malformed input.
+    std::size_t parse(const char* data, std::size_t size);
+
+    // Signals that the connection was closed. Completes a close-delimited
+    // body, otherwise throws ParseError if the response is incomplete.
+    void finish();
+
+    bool done() const { return _state == State::kDone; }
+
+    // True once any data has been consumed.
+    bool started() const { return _started; }
+
+    // True if the body ends when the connection closes, in which case the
+    // connection cannot be used for another request.
+    bool closeDelimited() const { return _closeDelimited; }
+
+    const Response& response() const { return _response; }
+
+    Response& response() { return _response; }
+
+  private:
+    enum class State {
+        kStatusLine,
+        kHeaders,
+        kBody,
+        kBodyUntilClose,
+        kChunkSize,
+        kChunkData,
+        kChunkDataEnd,
+        kTrailers,
+        kDone
+    };
+
+    // Appends to _line until CRLF. Returns true once _line holds a whole
+    // line, without the CRLF.
+    bool readLine(const char*& itr, const char* end);
+
+    void startBody();
+
+    State _state;
+    Response _response;
+    std::string _line;
+    bool _lineComplete;
+    // Bytes left in the Content-Length body or current chunk.
+    std::size_t _remaining;
+    bool _started;
+    bool _closeDelimited;
+};
+
+}  // namespace http
+}  // namespace net
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_NET_HTTP_RESPONSEPARSER_H
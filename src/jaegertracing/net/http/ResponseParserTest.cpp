@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/net/http/ResponseParser.h"
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <iterator>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace jaegertracing {
+namespace net {
+namespace http {
+namespace {
+
+constexpr auto kResponse = "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: application/json\r\n"
+                           "Content-Length: 59\r\n"
+                           "\r\n"
+                           "{\"strategyType\":\"PROBABILISTIC\","
+                           "\"probabilisticSampling\":{}}";
+
+// Feeds `input` to `parser` `chunkSize` bytes at a time.
+std::size_t parseInChunks(ResponseParser& parser,
+                          const std::string& input,
+                          std::size_t chunkSize)
+{
+    auto offset = static_cast<std::size_t>(0);
+    while (offset < input.size() && !parser.done()) {
+        const auto size = std::min(chunkSize, input.size() - offset);
+        offset += parser.parse(input.data() + offset, size);
+    }
+    return offset;
+}
+
+}  // anonymous namespace
+
+TEST(ResponseParser, testContentLength)
+{
+    const std::string input(kResponse);
+    // Byte by byte exercises every state split across reads.
+    for (auto chunkSize : { 1, 7, 4096 }) {
+        ResponseParser parser;
+        ASSERT_EQ(input.size(), parseInChunks(parser, input, chunkSize));
+        ASSERT_TRUE(parser.done());
+        ASSERT_FALSE(parser.closeDelimited());
+        const auto& response = parser.response();
+        ASSERT_EQ(200, response.statusCode());
+        ASSERT_EQ("OK", response.reason());
+        ASSERT_EQ(2U, response.headers().size());
+        ASSERT_EQ("Content-Type", response.headers()[0].key());
+        ASSERT_EQ("application/json", response.headers()[0].value());
+        ASSERT_EQ("Content-Length", response.headers()[1].key());
+        ASSERT_EQ("59", response.headers()[1].value());
+        ASSERT_EQ(59U, response.body().size());
+    }
+}
+
+TEST(ResponseParser, testLeavesNextResponse)
+{
+    const std::string first("HTTP/1.1 204 No Content\r\n\r\n");
+    const auto input = first + kResponse;
+    ResponseParser parser;
+    ASSERT_EQ(first.size(), parser.parse(input.data(), input.size()));
+    ASSERT_TRUE(parser.done());
+    ASSERT_EQ(204, parser.response().statusCode());
+    ASSERT_TRUE(parser.response().body().empty());
+}
+
+TEST(ResponseParser, testChunked)
+{
+    const std::string input("HTTP/1.1 200 OK\r\n"
+                            "transfer-encoding: chunked\r\n\r\n"
+                            "5\r\nhello\r\n"
+                            "7;ext=1\r\n, world\r\n"
+                            "0\r\n"
+                            "Trailer: value\r\n\r\n");
+    for (auto chunkSize : { 1, 3, 4096 }) {
+        ResponseParser parser;
+        ASSERT_EQ(input.size(), parseInChunks(parser, input, chunkSize));
+        ASSERT_TRUE(parser.done());
+        ASSERT_EQ("hello, world", parser.response().body());
+    }
+}
+
+TEST(ResponseParser, testCloseDelimited)
+{
+    const std::string input("HTTP/1.0 200 OK\r\n\r\nbody");
+    ResponseParser parser;
+    ASSERT_EQ(input.size(), parser.parse(input.data(), input.size()));
+    ASSERT_FALSE(parser.done());
+    ASSERT_TRUE(parser.closeDelimited());
+    parser.finish();
+    ASSERT_TRUE(parser.done());
+    ASSERT_EQ("body", parser.response().body());
+}
+
+TEST(ResponseParser, testErrors)
+{
+    {
+        const std::string input("HTTP/1.1 OK\r\n");
+        ResponseParser parser;
+        ASSERT_THROW(parser.parse(input.data(), input.size()), ParseError);
+    }
+    {
+        const std::string input("HTTP/1.1 200 OK\r\nBad Header\r\n");
+        ResponseParser parser;
+        ASSERT_THROW(parser.parse(input.data(), input.size()), ParseError);
+    }
+    {
+        const std::string input("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n"
+                                "\r\nshort");
+        ResponseParser parser;
+        parser.parse(input.data(), input.size());
+        ASSERT_THROW(parser.finish(), ParseError);
+    }
+}
+
+// Benchmark against the regular expression parsing ResponseParser replaced,
+// run with --gtest_also_run_disabled_tests.
+TEST(ResponseParser, DISABLED_testParsePerformance)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr auto kNumIterations = 10000;
+    const std::string input(kResponse);
+
+    const auto regexStart = Clock::now();
+    for (auto i = 0; i < kNumIterations; ++i) {
+        const std::regex statusLinePattern(
+            "HTTP/([0-9]\\.[0-9]) ([0-9]+) (.+)$");
+        const std::regex headerPattern("([^:]+): (.+)$");
+        std::istringstream in(input);
+        std::string line;
+        std::smatch match;
+        ASSERT_TRUE(readLineCRLF(in, line));
+        ASSERT_TRUE(std::regex_match(line, match, statusLinePattern));
+        std::vector<Header> headers;
+        while (readLineCRLF(in, line) && !line.empty()) {
+            ASSERT_TRUE(std::regex_match(line, match, headerPattern));
+            headers.emplace_back(match[1], match[2]);
+        }
+        const std::string body(std::istreambuf_iterator<char>(in),
+                               std::istreambuf_iterator<char>{});
+        ASSERT_EQ(59U, body.size());
+    }
+    const auto regexTime = Clock::now() - regexStart;
+
+    const auto parserStart = Clock::now();
+    for (auto i = 0; i < kNumIterations; ++i) {
+        ResponseParser parser;
+        parser.parse(input.data(), input.size());
+        ASSERT_TRUE(parser.done());
+    }
+    const auto parserTime = Clock::now() - parserStart;
+
+    using std::chrono::microseconds;
+    std::cout << "Parsed " << kNumIterations << " responses: regex "
+              << std::chrono::duration_cast<microseconds>(regexTime).count()
+              << "us, ResponseParser "
+              << std::chrono::duration_cast<microseconds>(parserTime).count()
+              << "us\n";
+}
+
+}  // namespace http
+}  // namespace net
+}  // namespace jaegertracing
@@ -37,9 +37,11 @@ TEST(Response, get)
     IPAddress serverAddress;
     std::promise<void> started;
 
-    std::thread clientThread([&serverAddress, &started]() {
+    Response clientResponse;
+    std::thread clientThread([&serverAddress, &started, &clientResponse]() {
         started.get_future().wait();
-        get(URI::parse("http://" + serverAddress.authority()));
+        clientResponse =
+            get(URI::parse("http://" + serverAddress.authority()));
     });
 
     Socket socket;
@@ -76,8 +78,12 @@ TEST(Response, get)
     const auto numWritten =
         ::write(clientSocket.handle(), response.c_str(), response.size());
     ASSERT_EQ(response.size(), numWritten);
+    // Without Content-Length the body ends when the server closes.
+    clientSocket.close();
 
     clientThread.join();
+    ASSERT_EQ(200, clientResponse.statusCode());
+    ASSERT_EQ(buffer.size() * 2, clientResponse.body().size());
 }
 
 }  // namespace http
@@ -60,7 +60,7 @@ class Propagator : public Extractor<ReaderType>, public Injector<WriterType> {
     SpanContext extract(const Reader& reader) const override
     {
         SpanContext ctx;
-        StrMap baggage;
+        Baggage baggage;
         std::string debugID;
         const auto result = reader.ForeachKey(
             [this, &ctx, &debugID, &baggage](const std::string& rawKey,
@@ -79,7 +79,7 @@ class Propagator : public Extractor<ReaderType>, public Injector<WriterType> {
                 }
                 else if (key == _headerKeys.jaegerBaggageHeader()) {
                     for (auto&& pair : parseCommaSeparatedMap(value)) {
-                        baggage[pair.first] = pair.second;
+                        baggage.set(pair.first, pair.second);
                     }
                 }
                 else {
@@ -88,7 +88,7 @@ class Propagator : public Extractor<ReaderType>, public Injector<WriterType> {
                         key.substr(0, prefix.size()) == prefix) {
                         const auto safeKey = removeBaggageKeyPrefix(key);
                         const auto safeValue = decodeValue(value);
-                        baggage[safeKey] = safeValue;
+                        baggage.set(safeKey, safeValue);
                     }
                 }
                 return opentracing::make_expected();
@@ -232,15 +232,15 @@ class BinaryPropagator : public Extractor<std::istream&>,
         out.put(ctx.flags());
 
         writeBinary(out, static_cast<uint32_t>(ctx.baggage().size()));
-        for (auto&& pair : ctx.baggage()) {
-            auto&& key = pair.first;
-            writeBinary(out, static_cast<uint32_t>(key.size()));
-            out.write(key.c_str(), key.size());
-
-            auto&& value = pair.second;
-            writeBinary(out, static_cast<uint32_t>(value.size()));
-            out.write(value.c_str(), value.size());
-        }
+        ctx.forEachBaggageItem(
+            [&out](const std::string& key, const std::string& value) {
+                writeBinary(out, static_cast<uint32_t>(key.size()));
+                out.write(key.c_str(), key.size());
+
+                writeBinary(out, static_cast<uint32_t>(value.size()));
+                out.write(value.c_str(), value.size());
+                return true;
+            });
     }
 
     SpanContext extract(std::istream& in) const override
@@ -256,8 +256,7 @@ class BinaryPropagator : public Extractor<std::istream&>,
         const auto flags = static_cast<unsigned char>(ch);
 
         const auto numBaggageItems = readBinary<uint32_t>(in);
-        StrMap baggage;
-        baggage.reserve(numBaggageItems);
+        Baggage baggage;
         for (auto i = static_cast<uint32_t>(0); i < numBaggageItems; ++i) {
             const auto keyLength = readBinary<uint32_t>(in);
             std::string key(keyLength, '\0');
@@ -273,7 +272,7 @@ class BinaryPropagator : public Extractor<std::istream&>,
                 return SpanContext();
             }
 
-            baggage[key] = value;
+            baggage.set(key, value);
         }
 
         SpanContext ctx(traceID, spanID, parentID, flags, baggage);
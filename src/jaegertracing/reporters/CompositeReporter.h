@@ -24,7 +24,7 @@
 #include <vector>
 
 namespace jaegertracing {
-class Span;
+class FinishedSpan;
 }  // namespace jaegertracing
 
 namespace jaegertracing {
@@ -41,7 +41,7 @@ class CompositeReporter : public Reporter {
 
     ~CompositeReporter() { close(); }
 
-    void report(const Span& span) noexcept override
+    void report(std::shared_ptr<const FinishedSpan> span) noexcept override
     {
         std::for_each(
             std::begin(_reporters),
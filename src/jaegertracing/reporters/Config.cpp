@@ -21,6 +21,8 @@ namespace reporters {
 
 constexpr int Config::kDefaultQueueSize;
 constexpr const char* Config::kDefaultLocalAgentHostPort;
+constexpr const char* Config::kUnixSocketPrefix;
+constexpr const char* Config::kSharedMemoryPrefix;
 
 }  // namespace reporters
 }  // namespace jaegertracing
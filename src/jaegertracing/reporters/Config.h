@@ -21,8 +21,11 @@
 #include <memory>
 #include <string>
 
+#include "jaegertracing/HTTPTransport.h"
 #include "jaegertracing/Logging.h"
+#include "jaegertracing/ShmRingTransport.h"
 #include "jaegertracing/UDPTransport.h"
+#include "jaegertracing/UnixDatagramTransport.h"
 #include "jaegertracing/metrics/Metrics.h"
 #include "jaegertracing/reporters/CompositeReporter.h"
 #include "jaegertracing/reporters/LoggingReporter.h"
@@ -39,6 +42,13 @@ class Config {
 
     static constexpr auto kDefaultQueueSize = 100;
     static constexpr auto kDefaultLocalAgentHostPort = "127.0.0.1:6831";
+    // Prefix of a localAgentHostPort that is the path of the agent's Unix
+    // datagram socket, e.g. "unix:///var/run/jaeger-agent.sock".
+    static constexpr auto kUnixSocketPrefix = "unix://";
+    // Prefix of a localAgentHostPort that is the path of the Unix socket on
+    // which the agent accepts shared memory rings, e.g.
+    // "shm:///var/run/jaeger-agent-rings.sock".
+    static constexpr auto kSharedMemoryPrefix = "shm://";
 
     static Clock::duration defaultBufferFlushInterval()
     {
@@ -62,8 +72,22 @@ class Config {
             utils::yaml::findOrDefault<bool>(configYAML, "logSpans", false);
         const auto localAgentHostPort = utils::yaml::findOrDefault<std::string>(
             configYAML, "localAgentHostPort", "");
-        return Config(
-            queueSize, bufferFlushInterval, logSpans, localAgentHostPort);
+        const auto endpoint =
+            utils::yaml::findOrDefault<std::string>(configYAML, "endpoint", "");
+        const auto maxBatchBytes =
+            utils::yaml::findOrDefault<int>(configYAML, "maxBatchBytes", 0);
+        const auto gzip =
+            utils::yaml::findOrDefault<bool>(configYAML, "gzip", false);
+        const auto ioUring =
+            utils::yaml::findOrDefault<bool>(configYAML, "ioUring", false);
+        return Config(queueSize,
+                      bufferFlushInterval,
+                      logSpans,
+                      localAgentHostPort,
+                      endpoint,
+                      maxBatchBytes,
+                      gzip,
+                      ioUring);
     }
 
 #endif  // JAEGERTRACING_WITH_YAML_CPP
@@ -73,7 +97,11 @@ class Config {
         const Clock::duration& bufferFlushInterval =
             defaultBufferFlushInterval(),
         bool logSpans = false,
-        const std::string& localAgentHostPort = kDefaultLocalAgentHostPort)
+        const std::string& localAgentHostPort = kDefaultLocalAgentHostPort,
+        const std::string& endpoint = "",
+        int maxBatchBytes = 0,
+        bool gzip = false,
+        bool ioUring = false)
         : _queueSize(queueSize > 0 ? queueSize : kDefaultQueueSize)
         , _bufferFlushInterval(bufferFlushInterval.count() > 0
                                    ? bufferFlushInterval
@@ -82,6 +110,12 @@ class Config {
         , _localAgentHostPort(localAgentHostPort.empty()
                                   ? kDefaultLocalAgentHostPort
                                   : localAgentHostPort)
+        , _endpoint(endpoint)
+        , _maxBatchBytes(maxBatchBytes > 0
+                             ? maxBatchBytes
+                             : HTTPTransport::kDefaultMaxBatchBytes)
+        , _gzip(gzip)
+        , _ioUring(ioUring)
     {
     }
 
@@ -89,8 +123,31 @@ class Config {
                                            logging::Logger& logger,
                                            metrics::Metrics& metrics) const
     {
-        std::unique_ptr<UDPTransport> sender(
-            new UDPTransport(net::IPAddress::v4(_localAgentHostPort), 0));
+        std::unique_ptr<Transport> sender;
+        if (_endpoint.empty()) {
+            const auto unixPath = unixSocketPath();
+            const auto ringPath = sharedMemorySocketPath();
+            if (!ringPath.empty()) {
+                sender.reset(new ShmRingTransport(ringPath, 0));
+            }
+            else if (!unixPath.empty()) {
+                sender.reset(new UnixDatagramTransport(unixPath, 0));
+            }
+            else {
+                std::unique_ptr<UDPTransport> udpSender(new UDPTransport(
+                    net::IPAddress::v4(_localAgentHostPort), 0));
+                if (_ioUring && !udpSender->useIOUring()) {
+                    logger.info("io_uring unavailable, sending spans to the "
+                                "agent with plain system calls");
+                }
+                sender = std::move(udpSender);
+            }
+        }
+        else {
+            logger.info("Reporting spans to collector endpoint " + _endpoint);
+            sender.reset(new HTTPTransport(
+                net::URI::parse(_endpoint), _maxBatchBytes, _gzip));
+        }
         std::unique_ptr<RemoteReporter> remoteReporter(
             new RemoteReporter(_bufferFlushInterval,
                                _queueSize,
@@ -120,11 +177,49 @@ class Config {
         return _localAgentHostPort;
     }
 
+    // Path of the agent's Unix datagram socket, empty if the agent is
+    // reached over UDP.
+    std::string unixSocketPath() const
+    {
+        return localAgentPath(kUnixSocketPrefix);
+    }
+
+    // Path of the Unix socket on which the agent accepts shared memory
+    // rings, empty if spans are not sent through shared memory.
+    std::string sharedMemorySocketPath() const
+    {
+        return localAgentPath(kSharedMemoryPrefix);
+    }
+
+    // Collector HTTP endpoint. When set, spans are sent there directly
+    // instead of to the agent.
+    const std::string& endpoint() const { return _endpoint; }
+
+    int maxBatchBytes() const { return _maxBatchBytes; }
+
+    bool gzip() const { return _gzip; }
+
+    // Send UDP packets to the agent through io_uring where the kernel
+    // supports it.
+    bool ioUring() const { return _ioUring; }
+
   private:
+    std::string localAgentPath(const std::string& prefix) const
+    {
+        if (_localAgentHostPort.compare(0, prefix.size(), prefix) != 0) {
+            return std::string();
+        }
+        return _localAgentHostPort.substr(prefix.size());
+    }
+
     int _queueSize;
     Clock::duration _bufferFlushInterval;
     bool _logSpans;
     std::string _localAgentHostPort;
+    std::string _endpoint;
+    int _maxBatchBytes;
+    bool _gzip;
+    bool _ioUring;
 };
 
 }  // namespace reporters
@@ -17,10 +17,11 @@
 #ifndef JAEGERTRACING_REPORTERS_INMEMORYREPORTER_H
 #define JAEGERTRACING_REPORTERS_INMEMORYREPORTER_H
 
+#include <memory>
 #include <mutex>
 #include <vector>
 
-#include "jaegertracing/Span.h"
+#include "jaegertracing/FinishedSpan.h"
 #include "jaegertracing/reporters/Reporter.h"
 
 namespace jaegertracing {
@@ -36,10 +37,10 @@ class InMemoryReporter : public Reporter {
         _spans.reserve(kInitialCapacity);
     }
 
-    void report(const Span& span) noexcept override
+    void report(std::shared_ptr<const FinishedSpan> span) noexcept override
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        _spans.push_back(span);
+        _spans.push_back(std::move(span));
     }
 
     void close() noexcept override {}
@@ -50,7 +51,7 @@ class InMemoryReporter : public Reporter {
         return _spans.size();
     }
 
-    std::vector<Span> spans() const noexcept
+    std::vector<std::shared_ptr<const FinishedSpan>> spans() const noexcept
     {
         std::lock_guard<std::mutex> lock(_mutex);
         return _spans;
@@ -63,7 +64,7 @@ class InMemoryReporter : public Reporter {
     }
 
   private:
-    std::vector<Span> _spans;
+    std::vector<std::shared_ptr<const FinishedSpan>> _spans;
     mutable std::mutex _mutex;
 };
 
@@ -15,17 +15,17 @@
  */
 
 #include "jaegertracing/reporters/LoggingReporter.h"
+#include "jaegertracing/FinishedSpan.h"
 #include "jaegertracing/Logging.h"
-#include "jaegertracing/Span.h"
 #include <sstream>
 
 namespace jaegertracing {
 namespace reporters {
 
-void LoggingReporter::report(const Span& span) noexcept
+void LoggingReporter::report(std::shared_ptr<const FinishedSpan> span) noexcept
 {
     std::ostringstream oss;
-    oss << "Reporting span " << span;
+    oss << "Reporting span " << *span;
     _logger.info(oss.str());
 }
 
@@ -30,7 +30,7 @@ class LoggingReporter : public Reporter {
     {
     }
 
-    void report(const Span& span) noexcept override;
+    void report(std::shared_ptr<const FinishedSpan> span) noexcept override;
 
     void close() noexcept override {}
 
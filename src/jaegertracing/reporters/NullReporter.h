@@ -18,9 +18,10 @@
 #define JAEGERTRACING_REPORTERS_NULLREPORTER_H
 
 #include "jaegertracing/reporters/Reporter.h"
+#include <memory>
 
 namespace jaegertracing {
-class Span;
+class FinishedSpan;
 }  // namespace jaegertracing
 
 namespace jaegertracing {
@@ -28,7 +29,7 @@ namespace reporters {
 
 class NullReporter : public Reporter {
   public:
-    void report(const Span&) noexcept override {}
+    void report(std::shared_ptr<const FinishedSpan>) noexcept override {}
 
     void close() noexcept override {}
 };
@@ -16,6 +16,7 @@
 
 #include "jaegertracing/reporters/RemoteReporter.h"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -34,8 +35,10 @@ RemoteReporter::RemoteReporter(const Clock::duration& bufferFlushInterval,
     , _sender(std::move(sender))
     , _logger(logger)
     , _metrics(metrics)
-    , _queue()
+    , _queue(fixedQueueSize > 0 ? fixedQueueSize : 1)
     , _queueLength(0)
+    , _wakeThreshold(std::max(1, fixedQueueSize / 2))
+    , _sleeping(false)
     , _running(true)
     , _lastFlush(Clock::now())
     , _cv()
@@ -45,18 +48,19 @@ RemoteReporter::RemoteReporter(const Clock::duration& bufferFlushInterval,
     _thread = std::thread([this]() { sweepQueue(); });
 }
 
-void RemoteReporter::report(const Span& span) noexcept
+void RemoteReporter::report(std::shared_ptr<const FinishedSpan> span) noexcept
 {
-    std::unique_lock<std::mutex> lock(_mutex);
-    const auto pushed = (static_cast<int>(_queue.size()) < _fixedQueueSize);
-    if (pushed) {
-        _queue.push_back(span);
-        lock.unlock();
-        _cv.notify_one();
-        ++_queueLength;
-    }
-    else {
+    QueuedSpan queuedSpan = { std::move(span), Clock::now() };
+    if (!_queue.tryPush(std::move(queuedSpan))) {
         _metrics.reporterDropped().inc(1);
+        return;
+    }
+    const auto queueLength = ++_queueLength;
+    // Only notify if the sweeper is actually waiting. Taking the lock here
+    // orders the notification after the sweeper has started waiting.
+    if (queueLength >= _wakeThreshold && _sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cv.notify_one();
     }
 }
 
@@ -80,24 +84,30 @@ void RemoteReporter::close() noexcept
 
 void RemoteReporter::sweepQueue() noexcept
 {
+    std::vector<QueuedSpan> batch;
+    batch.reserve(_queue.capacity());
     while (true) {
         try {
-            std::unique_lock<std::mutex> lock(_mutex);
-            _cv.wait_until(lock, _lastFlush + _bufferFlushInterval, [this]() {
-                return !_running || !_queue.empty();
-            });
+            auto running = true;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _sleeping = true;
+                _cv.wait_until(
+                    lock, _lastFlush + _bufferFlushInterval, [this]() {
+                        return !_running || _queueLength >= _wakeThreshold;
+                    });
+                _sleeping = false;
+                running = _running;
+            }
+
+            drainQueue(batch);
+            sendBatch(batch);
 
-            if (!_running && _queue.empty()) {
+            if (!running) {
                 return;
             }
 
-            if (!_queue.empty()) {
-                const auto span = _queue.front();
-                _queue.pop_front();
-                --_queueLength;
-                sendSpan(span);
-            }
-            else if (bufferFlushIntervalExpired()) {
+            if (bufferFlushIntervalExpired()) {
                 flush();
             }
         } catch (...) {
@@ -107,7 +117,36 @@ void RemoteReporter::sweepQueue() noexcept
     }
 }
 
-void RemoteReporter::sendSpan(const Span& span) noexcept
+void RemoteReporter::drainQueue(std::vector<QueuedSpan>& batch) noexcept
+{
+    // Take only what is queued right now so producers cannot keep the
+    // sweeper from flushing.
+    const auto queueLength = _queueLength.load();
+    QueuedSpan queuedSpan;
+    for (auto i = 0; i < queueLength && _queue.tryPop(queuedSpan); ++i) {
+        batch.push_back(std::move(queuedSpan));
+    }
+    _queueLength -= static_cast<int>(batch.size());
+}
+
+void RemoteReporter::sendBatch(std::vector<QueuedSpan>& batch) noexcept
+{
+    if (batch.empty()) {
+        return;
+    }
+    _metrics.reporterBatchSize().update(batch.size());
+    const auto now = Clock::now();
+    for (auto&& queuedSpan : batch) {
+        _metrics.reporterQueueWait().record(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                now - queuedSpan._enqueueTime)
+                .count());
+        sendSpan(*queuedSpan._span);
+    }
+    batch.clear();
+}
+
+void RemoteReporter::sendSpan(const FinishedSpan& span) noexcept
 {
     try {
         const auto flushed = _sender->append(span);
@@ -116,7 +155,9 @@ void RemoteReporter::sendSpan(const Span& span) noexcept
             _metrics.reporterQueueLength().update(_queueLength);
         }
     } catch (const Transport::Exception& ex) {
+        _metrics.reporterSuccess().inc(ex.numSent());
         _metrics.reporterFailure().inc(ex.numFailed());
+        _metrics.reporterDropped().inc(ex.numDropped());
         std::ostringstream oss;
         oss << "error reporting span " << span.operationName() << ": "
             << ex.what();
@@ -132,7 +173,9 @@ void RemoteReporter::flush() noexcept
             _metrics.reporterSuccess().inc(flushed);
         }
     } catch (const Transport::Exception& ex) {
+        _metrics.reporterSuccess().inc(ex.numSent());
         _metrics.reporterFailure().inc(ex.numFailed());
+        _metrics.reporterDropped().inc(ex.numDropped());
         _logger.error(ex.what());
     }
 
@@ -19,15 +19,17 @@
 
 #include <atomic>
 #include <condition_variable>
-#include <deque>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
+#include "jaegertracing/FinishedSpan.h"
 #include "jaegertracing/Logging.h"
-#include "jaegertracing/Span.h"
 #include "jaegertracing/Transport.h"
 #include "jaegertracing/metrics/Metrics.h"
 #include "jaegertracing/reporters/Reporter.h"
+#include "jaegertracing/utils/MPSCQueue.h"
 
 namespace jaegertracing {
 namespace reporters {
@@ -44,14 +46,23 @@ class RemoteReporter : public Reporter {
 
     ~RemoteReporter() { close(); }
 
-    void report(const Span& span) noexcept override;
+    void report(std::shared_ptr<const FinishedSpan> span) noexcept override;
 
     void close() noexcept override;
 
   private:
+    struct QueuedSpan {
+        std::shared_ptr<const FinishedSpan> _span;
+        Clock::time_point _enqueueTime;
+    };
+
     void sweepQueue() noexcept;
 
-    void sendSpan(const Span& span) noexcept;
+    void drainQueue(std::vector<QueuedSpan>& batch) noexcept;
+
+    void sendBatch(std::vector<QueuedSpan>& batch) noexcept;
+
+    void sendSpan(const FinishedSpan& span) noexcept;
 
     void flush() noexcept;
 
@@ -65,8 +76,12 @@ class RemoteReporter : public Reporter {
     std::unique_ptr<Transport> _sender;
     logging::Logger& _logger;
     metrics::Metrics& _metrics;
-    std::deque<Span> _queue;
+    utils::MPSCQueue<QueuedSpan> _queue;
     std::atomic<int> _queueLength;
+    // Producers only wake the sweeper once this many spans are queued, so a
+    // burst of reports costs one wakeup instead of one per span.
+    int _wakeThreshold;
+    std::atomic<bool> _sleeping;
     bool _running;
     Clock::time_point _lastFlush;
     std::condition_variable _cv;
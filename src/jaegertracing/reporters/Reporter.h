@@ -17,9 +17,11 @@
 #ifndef JAEGERTRACING_REPORTERS_REPORTER_H
 #define JAEGERTRACING_REPORTERS_REPORTER_H
 
+#include <memory>
+
 namespace jaegertracing {
 
-class Span;
+class FinishedSpan;
 
 namespace reporters {
 
@@ -27,7 +29,7 @@ class Reporter {
   public:
     virtual ~Reporter() = default;
 
-    virtual void report(const Span& span) noexcept = 0;
+    virtual void report(std::shared_ptr<const FinishedSpan> span) noexcept = 0;
 
     virtual void close() noexcept = 0;
 };
@@ -16,9 +16,11 @@
 
 #include <gtest/gtest.h>
 
+#include "jaegertracing/FinishedSpan.h"
 #include "jaegertracing/Logging.h"
 #include "jaegertracing/Tracer.h"
 #include "jaegertracing/Transport.h"
+#include "jaegertracing/metrics/InMemoryStatsReporter.h"
 #include "jaegertracing/reporters/CompositeReporter.h"
 #include "jaegertracing/reporters/InMemoryReporter.h"
 #include "jaegertracing/reporters/LoggingReporter.h"
@@ -32,16 +34,16 @@ namespace {
 
 class FakeTransport : public Transport {
   public:
-    FakeTransport(std::vector<Span>& spans, std::mutex& mutex)
+    FakeTransport(std::vector<std::string>& spans, std::mutex& mutex)
         : _spans(spans)
         , _mutex(mutex)
     {
     }
 
-    int append(const Span& span) override
+    int append(const FinishedSpan& span) override
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        _spans.push_back(span);
+        _spans.push_back(span.operationName());
         return 1;
     }
 
@@ -50,17 +52,27 @@ class FakeTransport : public Transport {
     void close() override {}
 
   private:
-    std::vector<Span>& _spans;
+    std::vector<std::string>& _spans;
     std::mutex& _mutex;
 };
 
-const Span span;
+// Fails every flush, part of the spans dropped for a full send buffer.
+class FailingTransport : public Transport {
+  public:
+    int append(const FinishedSpan& span) override { return 0; }
+
+    int flush() override { throw Exception("send buffer full", 1, 2, 3); }
+
+    void close() override {}
+};
+
+const auto span = std::make_shared<const FinishedSpan>();
 
 }  // anonymous namespace
 
 TEST(Reporter, testRemoteReporter)
 {
-    std::vector<Span> spans;
+    std::vector<std::string> spans;
     std::mutex mutex;
     auto logger = logging::nullLogger();
     auto metrics = metrics::Metrics::makeNullMetrics();
@@ -81,6 +93,82 @@ TEST(Reporter, testRemoteReporter)
     ASSERT_EQ(spans.size(), kNumReports);
 }
 
+TEST(Reporter, testRemoteReporterConcurrentProducers)
+{
+    constexpr auto kNumThreads = 4;
+    constexpr auto kNumReports = 1000;
+    std::vector<std::string> spans;
+    std::mutex mutex;
+    auto logger = logging::nullLogger();
+    auto metrics = metrics::Metrics::makeNullMetrics();
+    RemoteReporter reporter(
+        std::chrono::milliseconds(1),
+        kNumThreads * kNumReports,
+        std::unique_ptr<Transport>(new FakeTransport(spans, mutex)),
+        *logger,
+        *metrics);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&reporter]() {
+            for (auto j = 0; j < kNumReports; ++j) {
+                reporter.report(span);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    reporter.close();
+    ASSERT_EQ(kNumThreads * kNumReports, spans.size());
+}
+
+TEST(Reporter, testRemoteReporterBatchMetrics)
+{
+    constexpr auto kNumReports = 10;
+    std::vector<std::string> spans;
+    std::mutex mutex;
+    auto logger = logging::nullLogger();
+    metrics::InMemoryStatsReporter statsReporter;
+    auto metrics = metrics::Metrics::fromStatsReporter(statsReporter);
+    RemoteReporter reporter(
+        std::chrono::hours(1),
+        kNumReports,
+        std::unique_ptr<Transport>(new FakeTransport(spans, mutex)),
+        *logger,
+        *metrics);
+    for (auto i = 0; i < kNumReports; ++i) {
+        reporter.report(span);
+    }
+    reporter.close();
+    ASSERT_EQ(kNumReports, spans.size());
+
+    const auto& gauges = statsReporter.gauges();
+    const auto batchSizeItr = gauges.find("jaeger.reporter-batch-size");
+    ASSERT_NE(std::end(gauges), batchSizeItr);
+    ASSERT_LT(0, batchSizeItr->second);
+    ASSERT_GE(kNumReports, batchSizeItr->second);
+    const auto& timers = statsReporter.timers();
+    ASSERT_NE(std::end(timers), timers.find("jaeger.reporter-queue-wait"));
+}
+
+TEST(Reporter, testRemoteReporterDroppedMetrics)
+{
+    auto logger = logging::nullLogger();
+    metrics::InMemoryStatsReporter statsReporter;
+    auto metrics = metrics::Metrics::fromStatsReporter(statsReporter);
+    RemoteReporter reporter(std::chrono::hours(1),
+                            1,
+                            std::unique_ptr<Transport>(new FailingTransport()),
+                            *logger,
+                            *metrics);
+    reporter.close();
+
+    const auto& counters = statsReporter.counters();
+    ASSERT_EQ(1, counters.at("jaeger.reporter-spans.state=failure"));
+    ASSERT_EQ(2, counters.at("jaeger.reporter-spans.state=success"));
+    ASSERT_EQ(3, counters.at("jaeger.reporter-spans.state=dropped"));
+}
+
 TEST(Reporter, testNullReporter)
 {
     NullReporter reporter;
@@ -129,6 +217,15 @@ TEST(Reporter, testCompositeReporter)
     ASSERT_EQ(1,
               std::static_pointer_cast<InMemoryReporter>(reporters[1])
                   ->spansSubmitted());
+    // Reporters share the finished span rather than copying it.
+    ASSERT_EQ(span,
+              std::static_pointer_cast<InMemoryReporter>(reporters[0])
+                  ->spans()
+                  .front());
+    ASSERT_EQ(span,
+              std::static_pointer_cast<InMemoryReporter>(reporters[1])
+                  ->spans()
+                  .front());
 }
 
 }  // namespace reporters
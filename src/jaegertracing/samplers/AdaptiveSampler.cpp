@@ -17,9 +17,7 @@
 #include "jaegertracing/samplers/AdaptiveSampler.h"
 #include "jaegertracing/samplers/GuaranteedThroughputProbabilisticSampler.h"
 #include <cassert>
-#include <iterator>
 #include <memory>
-#include <utility>
 
 namespace jaegertracing {
 class TraceID;
@@ -27,77 +25,93 @@ class TraceID;
 
 namespace jaegertracing {
 namespace samplers {
-namespace {
-
-AdaptiveSampler::SamplerMap samplersFromStrategies(
-    const sampling_manager::thrift::PerOperationSamplingStrategies& strategies)
-{
-    AdaptiveSampler::SamplerMap samplers;
-    for (auto&& strategy : strategies.perOperationStrategies) {
-        samplers[strategy.operation] =
-            std::make_shared<GuaranteedThroughputProbabilisticSampler>(
-                strategies.defaultLowerBoundTracesPerSecond,
-                strategy.probabilisticSampling.samplingRate);
-    }
-    return samplers;
-}
-
-}  // anonymous namespace
 
 AdaptiveSampler::AdaptiveSampler(
     const sampling_manager::thrift::PerOperationSamplingStrategies& strategies,
     size_t maxOperations)
-    : _samplers(samplersFromStrategies(strategies))
+    : _samplers()
     , _defaultSampler(strategies.defaultSamplingProbability)
     , _lowerBound(strategies.defaultLowerBoundTracesPerSecond)
     , _maxOperations(maxOperations)
-    , _mutex()
 {
+    update(strategies);
 }
 
 SamplingStatus AdaptiveSampler::isSampled(const TraceID& id,
-                                          const std::string& operation)
+                                          const std::string& operation,
+                                          size_t hash)
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto samplerItr = _samplers.find(operation);
-    if (samplerItr != std::end(_samplers)) {
-        return samplerItr->second->isSampled(id, operation);
+    auto* entry = _samplers.find(operation, hash);
+    if (!entry) {
+        entry = insert(operation, hash);
+        if (!entry) {
+            return _defaultSampler.isSampled(id, operation);
+        }
     }
-    if (_samplers.size() >= _maxOperations) {
-        return _defaultSampler.isSampled(id, operation);
+    return entry->sampler()->isSampled(id, operation);
+}
+
+SamplingStatus AdaptiveSampler::isOperationSampled(const TraceID& id,
+                                                   const Operation& operation)
+{
+    auto* entry = _samplers.find(operation);
+    if (!entry) {
+        entry = insert(operation.name(), operation.hash());
+        if (!entry) {
+            return _defaultSampler.isSampled(id, operation.name());
+        }
     }
+    return entry->sampler()->isSampled(id, operation.name());
+}
 
-    auto newSampler =
+OperationSamplerTable::Entry*
+AdaptiveSampler::insert(const std::string& operation, size_t hash)
+{
+    if (_samplers.size() >= _maxOperations) {
+        return nullptr;
+    }
+    // Built before taking the table's lock. If another thread inserts the
+    // operation first, its sampler is used and this one dropped.
+    return _samplers.insert(
+        operation,
+        hash,
         std::make_shared<GuaranteedThroughputProbabilisticSampler>(
-            _lowerBound, _defaultSampler.samplingRate());
-    _samplers[operation] = newSampler;
-    return newSampler->isSampled(id, operation);
+            _lowerBound, _defaultSampler.samplingRate()),
+        _maxOperations);
 }
 
 void AdaptiveSampler::close()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    for (auto&& pair : _samplers) {
-        pair.second->close();
-    }
+    _samplers.forEach([](const OperationSamplerTable::Entry& entry) {
+        entry.sampler()->close();
+    });
 }
 
 void AdaptiveSampler::update(const PerOperationSamplingStrategies& strategies)
 {
     const auto lowerBound = strategies.defaultLowerBoundTracesPerSecond;
-    std::lock_guard<std::mutex> lock(_mutex);
     for (auto&& strategy : strategies.perOperationStrategies) {
-        auto& sampler = _samplers[strategy.operation];
+        const auto& operation = strategy.operation;
+        const auto hash = OperationSamplerTable::hash(operation);
         const auto samplingRate = strategy.probabilisticSampling.samplingRate;
-        if (sampler) {
+        auto* entry = _samplers.find(operation, hash);
+        if (entry) {
+            // Samplers may be in use by other threads, so update a copy and
+            // publish that.
+            const auto sampler =
+                std::make_shared<GuaranteedThroughputProbabilisticSampler>(
+                    *entry->sampler());
             sampler->update(lowerBound, samplingRate);
+            entry->setSampler(sampler);
         }
         else {
-            sampler =
+            entry = _samplers.insert(
+                operation,
+                hash,
                 std::make_shared<GuaranteedThroughputProbabilisticSampler>(
-                    lowerBound, samplingRate);
+                    lowerBound, samplingRate));
         }
-        assert(sampler);
+        assert(entry);
     }
 }
 
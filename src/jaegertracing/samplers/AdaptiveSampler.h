@@ -17,12 +17,11 @@
 #ifndef JAEGERTRACING_SAMPLERS_ADAPTIVESAMPLER_H
 #define JAEGERTRACING_SAMPLERS_ADAPTIVESAMPLER_H
 
-#include <mutex>
 #include <string>
-#include <unordered_map>
 
 #include "jaegertracing/Constants.h"
 #include "jaegertracing/samplers/GuaranteedThroughputProbabilisticSampler.h"
+#include "jaegertracing/samplers/OperationSamplerTable.h"
 #include "jaegertracing/samplers/ProbabilisticSampler.h"
 #include "jaegertracing/samplers/Sampler.h"
 #include "jaegertracing/thrift-gen/sampling_types.h"
@@ -34,9 +33,6 @@ class AdaptiveSampler : public Sampler {
   public:
     using PerOperationSamplingStrategies =
         sampling_manager::thrift::PerOperationSamplingStrategies;
-    using SamplerMap = std::unordered_map<
-        std::string,
-        std::shared_ptr<GuaranteedThroughputProbabilisticSampler>>;
 
     AdaptiveSampler(const PerOperationSamplingStrategies& strategies,
                     size_t maxOperations);
@@ -44,7 +40,13 @@ class AdaptiveSampler : public Sampler {
     ~AdaptiveSampler() { close(); }
 
     SamplingStatus isSampled(const TraceID& id,
-                             const std::string& operation) override;
+                             const std::string& operation) override
+    {
+        return isSampled(id, operation, OperationSamplerTable::hash(operation));
+    }
+
+    SamplingStatus isOperationSampled(const TraceID& id,
+                                      const Operation& operation) override;
 
     void close() override;
 
@@ -53,11 +55,18 @@ class AdaptiveSampler : public Sampler {
     Type type() const override { return Type::kAdaptiveSampler; }
 
   private:
-    SamplerMap _samplers;
+    SamplingStatus
+    isSampled(const TraceID& id, const std::string& operation, size_t hash);
+
+    // Inserts a sampler for an operation not in the table yet. Returns
+    // nullptr if there are too many operations.
+    OperationSamplerTable::Entry* insert(const std::string& operation,
+                                         size_t hash);
+
+    OperationSamplerTable _samplers;
     ProbabilisticSampler _defaultSampler;
     double _lowerBound;
     size_t _maxOperations;
-    std::mutex _mutex;
 };
 
 }  // namespace samplers
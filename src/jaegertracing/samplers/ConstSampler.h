@@ -35,8 +35,9 @@ class ConstSampler : public Sampler {
   public:
     explicit ConstSampler(bool sample)
         : _decision(sample)
-        , _tags({ { kSamplerTypeTagKey, kSamplerTypeConst },
-                  { kSamplerParamTagKey, _decision } })
+        , _tags(SamplingStatus::makeTags(
+              { { kSamplerTypeTagKey, kSamplerTypeConst },
+                { kSamplerParamTagKey, _decision } }))
     {
     }
 
@@ -52,7 +53,7 @@ class ConstSampler : public Sampler {
 
   private:
     bool _decision;
-    std::vector<Tag> _tags;
+    SamplingStatus::Tags _tags;
 };
 
 }  // namespace samplers
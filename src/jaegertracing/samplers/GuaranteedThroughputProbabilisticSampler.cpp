@@ -25,8 +25,9 @@ void GuaranteedThroughputProbabilisticSampler::update(double lowerBound,
     if (_samplingRate != samplingRate) {
         _probabilisticSampler = ProbabilisticSampler(samplingRate);
         _samplingRate = _probabilisticSampler.samplingRate();
-        _tags = { { kSamplerTypeTagKey, kSamplerTypeLowerBound },
-                  { kSamplerParamTagKey, _samplingRate } };
+        _tags = SamplingStatus::makeTags(
+            { { kSamplerTypeTagKey, kSamplerTypeLowerBound },
+              { kSamplerParamTagKey, _samplingRate } });
     }
 
     if (_lowerBound != lowerBound) {
@@ -42,8 +42,9 @@ class GuaranteedThroughputProbabilisticSampler : public Sampler {
         , _samplingRate(_probabilisticSampler.samplingRate())
         , _lowerBoundSampler(new RateLimitingSampler(lowerBound))
         , _lowerBound(lowerBound)
-        , _tags({ { kSamplerTypeTagKey, kSamplerTypeLowerBound },
-                  { kSamplerParamTagKey, _samplingRate } })
+        , _tags(SamplingStatus::makeTags(
+              { { kSamplerTypeTagKey, kSamplerTypeLowerBound },
+                { kSamplerParamTagKey, _samplingRate } }))
     {
     }
 
@@ -81,9 +82,11 @@ class GuaranteedThroughputProbabilisticSampler : public Sampler {
   private:
     ProbabilisticSampler _probabilisticSampler;
     double _samplingRate;
-    std::unique_ptr<RateLimitingSampler> _lowerBoundSampler;
+    // Shared by copies, so a copy made to apply an update keeps the rate
+    // limiter's balance.
+    std::shared_ptr<RateLimitingSampler> _lowerBoundSampler;
     double _lowerBound;
-    std::vector<Tag> _tags;
+    SamplingStatus::Tags _tags;
 };
 
 }  // namespace samplers
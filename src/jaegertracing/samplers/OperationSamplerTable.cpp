@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/samplers/OperationSamplerTable.h"
+
+#include <cassert>
+
+namespace jaegertracing {
+namespace samplers {
+namespace {
+
+constexpr auto kInitialCapacity = 16;
+
+std::atomic<uint64_t> nextTableID(1);
+
+}  // anonymous namespace
+
+OperationSamplerTable::Table::Table(std::size_t capacity)
+    : _mask(capacity - 1)
+    , _slots(new std::atomic<Entry*>[capacity])
+{
+    assert((capacity & _mask) == 0);
+    for (auto i = static_cast<std::size_t>(0); i < capacity; ++i) {
+        _slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+OperationSamplerTable::Entry*
+OperationSamplerTable::Table::find(const std::string& operation,
+                                   std::size_t hash) const
+{
+    // The table is never full, so probing always reaches an empty slot.
+    for (auto i = hash & _mask;; i = (i + 1) & _mask) {
+        auto* entry = _slots[i].load(std::memory_order_acquire);
+        if (!entry) {
+            return nullptr;
+        }
+        if (entry->hash() == hash && entry->operation() == operation) {
+            return entry;
+        }
+    }
+}
+
+void OperationSamplerTable::Table::insert(Entry* entry)
+{
+    auto i = entry->hash() & _mask;
+    while (_slots[i].load(std::memory_order_relaxed)) {
+        i = (i + 1) & _mask;
+    }
+    _slots[i].store(entry, std::memory_order_release);
+}
+
+OperationSamplerTable::OperationSamplerTable()
+    : _entries()
+    , _tables()
+    , _table(nullptr)
+    , _size(0)
+    , _mutex()
+    , _id(nextTableID++)
+{
+    _tables.emplace_back(new Table(kInitialCapacity));
+    _table.store(_tables.back().get());
+}
+
+OperationSamplerTable::Entry*
+OperationSamplerTable::find(const std::string& operation,
+                            std::size_t hash) const
+{
+    return _table.load(std::memory_order_acquire)->find(operation, hash);
+}
+
+OperationSamplerTable::Entry*
+OperationSamplerTable::find(const Operation& operation) const
+{
+    auto* entry = static_cast<Entry*>(operation.samplerSlot(_id));
+    if (entry) {
+        return entry;
+    }
+    entry = find(operation.name(), operation.hash());
+    if (entry) {
+        operation.setSamplerSlot(_id, entry);
+    }
+    return entry;
+}
+
+OperationSamplerTable::Entry*
+OperationSamplerTable::insert(const std::string& operation,
+                              std::size_t hash,
+                              const SamplerPtr& sampler,
+                              std::size_t maxSize)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto* table = _table.load(std::memory_order_relaxed);
+    auto* entry = table->find(operation, hash);
+    if (entry) {
+        return entry;
+    }
+    if (_entries.size() >= maxSize) {
+        return nullptr;
+    }
+
+    // Keep the load factor at most one half so probe sequences stay short.
+    if ((_entries.size() + 1) * 2 > table->capacity()) {
+        std::unique_ptr<Table> newTable(new Table(table->capacity() * 2));
+        for (auto&& existing : _entries) {
+            newTable->insert(existing.get());
+        }
+        table = newTable.get();
+        _tables.emplace_back(std::move(newTable));
+        _table.store(table, std::memory_order_release);
+    }
+
+    _entries.emplace_back(new Entry(hash, operation, sampler));
+    entry = _entries.back().get();
+    table->insert(entry);
+    _size.store(_entries.size());
+    return entry;
+}
+
+}  // namespace samplers
+}  // namespace jaegertracing
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_SAMPLERS_OPERATIONSAMPLERTABLE_H
+#define JAEGERTRACING_SAMPLERS_OPERATIONSAMPLERTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "jaegertracing/Operation.h"
+#include "jaegertracing/samplers/GuaranteedThroughputProbabilisticSampler.h"
+
+namespace jaegertracing {
+namespace samplers {
+
+// Maps operation names to their samplers. Lookups never lock: they probe an
+// open addressing table of entry pointers. Inserts are serialized by a mutex.
+// Entries are never removed, and a table outgrown by inserts stays allocated
+// until destruction, so a reader never sees freed memory. Registered
+// operations cache their entry, so looking them up again skips the probe.
+class OperationSamplerTable {
+  public:
+    using SamplerPtr =
+        std::shared_ptr<GuaranteedThroughputProbabilisticSampler>;
+
+    class Entry {
+      public:
+        Entry(std::size_t hash,
+              const std::string& operation,
+              const SamplerPtr& sampler)
+            : _hash(hash)
+            , _operation(operation)
+            , _sampler(sampler)
+        {
+        }
+
+        std::size_t hash() const { return _hash; }
+
+        const std::string& operation() const { return _operation; }
+
+        SamplerPtr sampler() const { return std::atomic_load(&_sampler); }
+
+        void setSampler(const SamplerPtr& sampler)
+        {
+            std::atomic_store(&_sampler, sampler);
+        }
+
+      private:
+        const std::size_t _hash;
+        const std::string _operation;
+        SamplerPtr _sampler;
+    };
+
+    static std::size_t hash(const std::string& operation)
+    {
+        return Operation::hash(operation);
+    }
+
+    OperationSamplerTable();
+
+    // Returns the entry for `operation`, or nullptr if there is none. `hash`
+    // must be hash(operation).
+    Entry* find(const std::string& operation, std::size_t hash) const;
+
+    Entry* find(const std::string& operation) const
+    {
+        return find(operation, hash(operation));
+    }
+
+    // Returns the entry for a registered operation, or nullptr if there is
+    // none. The entry is cached in `operation`, unless another table did so
+    // first.
+    Entry* find(const Operation& operation) const;
+
+    // Returns the entry for `operation`, inserting one holding `sampler` if
+    // there is none and the table has fewer than `maxSize` entries. Returns
+    // nullptr if the table is full.
+    Entry*
+    insert(const std::string& operation,
+           std::size_t hash,
+           const SamplerPtr& sampler,
+           std::size_t maxSize = std::numeric_limits<std::size_t>::max());
+
+    std::size_t size() const { return _size.load(); }
+
+    // Calls `function` with each entry, blocking inserts meanwhile.
+    template <typename Function>
+    void forEach(Function function) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto&& entry : _entries) {
+            function(*entry);
+        }
+    }
+
+  private:
+    class Table {
+      public:
+        explicit Table(std::size_t capacity);
+
+        std::size_t capacity() const { return _mask + 1; }
+
+        Entry* find(const std::string& operation, std::size_t hash) const;
+
+        // Only called with the owning table's mutex held, for an operation
+        // that is not in the table yet.
+        void insert(Entry* entry);
+
+      private:
+        const std::size_t _mask;
+        std::unique_ptr<std::atomic<Entry*>[]> _slots;
+    };
+
+    std::vector<std::unique_ptr<Entry>> _entries;
+    std::vector<std::unique_ptr<Table>> _tables;
+    std::atomic<Table*> _table;
+    std::atomic<std::size_t> _size;
+    mutable std::mutex _mutex;
+    // Unique among all tables, so a cached entry is only used by its table.
+    const uint64_t _id;
+};
+
+}  // namespace samplers
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_SAMPLERS_OPERATIONSAMPLERTABLE_H
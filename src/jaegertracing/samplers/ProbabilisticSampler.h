@@ -36,8 +36,9 @@ class ProbabilisticSampler : public Sampler {
     explicit ProbabilisticSampler(double samplingRate)
         : _samplingRate(std::max(0.0, std::min(samplingRate, 1.0)))
         , _samplingBoundary(computeSamplingBoundary(_samplingRate))
-        , _tags({ { kSamplerTypeTagKey, kSamplerTypeProbabilistic },
-                  { kSamplerParamTagKey, _samplingRate } })
+        , _tags(SamplingStatus::makeTags(
+              { { kSamplerTypeTagKey, kSamplerTypeProbabilistic },
+                { kSamplerParamTagKey, _samplingRate } }))
     {
     }
 
@@ -59,7 +60,7 @@ class ProbabilisticSampler : public Sampler {
 
     double _samplingRate;
     uint64_t _samplingBoundary;
-    std::vector<Tag> _tags;
+    SamplingStatus::Tags _tags;
 
     static uint64_t computeSamplingBoundary(long double samplingRate)
     {
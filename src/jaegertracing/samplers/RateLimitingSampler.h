@@ -38,8 +38,9 @@ class RateLimitingSampler : public Sampler {
     explicit RateLimitingSampler(double maxTracesPerSecond)
         : _maxTracesPerSecond(maxTracesPerSecond)
         , _rateLimiter(_maxTracesPerSecond, std::max(_maxTracesPerSecond, 1.0))
-        , _tags({ { kSamplerTypeTagKey, kSamplerTypeRateLimiting },
-                  { kSamplerParamTagKey, maxTracesPerSecond } })
+        , _tags(SamplingStatus::makeTags(
+              { { kSamplerTypeTagKey, kSamplerTypeRateLimiting },
+                { kSamplerParamTagKey, maxTracesPerSecond } }))
     {
     }
 
@@ -56,7 +57,7 @@ class RateLimitingSampler : public Sampler {
   private:
     double _maxTracesPerSecond;
     utils::RateLimiter<> _rateLimiter;
-    std::vector<Tag> _tags;
+    SamplingStatus::Tags _tags;
 };
 
 }  // namespace samplers
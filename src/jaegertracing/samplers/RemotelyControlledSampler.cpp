@@ -21,10 +21,8 @@
 
 #include "jaegertracing/metrics/Counter.h"
 #include "jaegertracing/metrics/Gauge.h"
-#include "jaegertracing/net/IPAddress.h"
-#include "jaegertracing/net/Socket.h"
 #include "jaegertracing/net/URI.h"
-#include "jaegertracing/net/http/Response.h"
+#include "jaegertracing/net/http/Client.h"
 #include "jaegertracing/samplers/AdaptiveSampler.h"
 #include "jaegertracing/samplers/RemoteSamplingJSON.h"
 #include "jaegertracing/utils/ErrorUtil.h"
@@ -41,25 +39,17 @@ class HTTPSamplingManager : public sampling_manager::thrift::SamplingManagerIf {
     HTTPSamplingManager(const std::string& serverURL, logging::Logger& logger)
         : _serverURI(net::URI::parse(serverURL))
         , _logger(logger)
+        , _client()
     {
-        try {
-            net::Socket socket;
-            socket.open(AF_INET, SOCK_STREAM);
-            _serverAddr = socket.connect(serverURL);
-        } catch (...) {
-            utils::ErrorUtil::logError(_logger, "cannot connect to socket");
-        }
     }
 
+    // Only called from the sampler's polling thread.
     void getSamplingStrategy(SamplingStrategyResponse& result,
                              const std::string& serviceName) override
     {
-        if (_serverAddr == net::IPAddress()) {
-            return;
-        }
         auto uri = _serverURI;
         uri._query = "service=" + net::URI::queryEscape(serviceName);
-        const auto responseHTTP = net::http::get(uri);
+        const auto responseHTTP = _client.get(uri);
         if (responseHTTP.statusCode() != 200) {
             std::ostringstream oss;
             oss << "Received HTTP error response"
@@ -75,8 +65,8 @@ class HTTPSamplingManager : public sampling_manager::thrift::SamplingManagerIf {
 
   private:
     net::URI _serverURI;
-    net::IPAddress _serverAddr;
     logging::Logger& _logger;
+    net::http::Client _client;
 };
 
 }  // anonymous namespace
@@ -110,9 +100,18 @@ SamplingStatus
 RemotelyControlledSampler::isSampled(const TraceID& id,
                                      const std::string& operation)
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-    assert(_sampler);
-    return _sampler->isSampled(id, operation);
+    const auto sampler = std::atomic_load(&_sampler);
+    assert(sampler);
+    return sampler->isSampled(id, operation);
+}
+
+SamplingStatus
+RemotelyControlledSampler::isOperationSampled(const TraceID& id,
+                                              const Operation& operation)
+{
+    const auto sampler = std::atomic_load(&_sampler);
+    assert(sampler);
+    return sampler->isOperationSampled(id, operation);
 }
 
 void RemotelyControlledSampler::close()
@@ -154,7 +153,6 @@ void RemotelyControlledSampler::updateSampler()
         return;
     }
 
-    std::lock_guard<std::mutex> lock(_mutex);
     _metrics.samplerRetrieved().inc(1);
 
     if (response.__isset.operationSampling) {
@@ -177,14 +175,16 @@ void RemotelyControlledSampler::updateSampler()
 void RemotelyControlledSampler::updateAdaptiveSampler(
     const PerOperationSamplingStrategies& strategies)
 {
-    auto sampler = _sampler;
+    auto sampler = std::atomic_load(&_sampler);
     assert(sampler);
     if (sampler->type() == Type::kAdaptiveSampler) {
         static_cast<AdaptiveSampler&>(*sampler).update(strategies);
     }
     else {
-        _sampler =
-            std::make_shared<AdaptiveSampler>(strategies, _maxOperations);
+        std::atomic_store(
+            &_sampler,
+            std::static_pointer_cast<Sampler>(
+                std::make_shared<AdaptiveSampler>(strategies, _maxOperations)));
     }
 }
 
@@ -205,7 +205,7 @@ void RemotelyControlledSampler::updateRateLimitingOrProbabilisticSampler(
         oss << "Unsupported sampling strategy type " << response.strategyType;
         throw std::runtime_error(oss.str());
     }
-    _sampler = sampler;
+    std::atomic_store(&_sampler, sampler);
 }
 
 }  // namespace samplers
@@ -19,6 +19,7 @@
 
 #include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -49,6 +50,9 @@ class RemotelyControlledSampler : public Sampler {
     SamplingStatus isSampled(const TraceID& id,
                              const std::string& operation) override;
 
+    SamplingStatus isOperationSampled(const TraceID& id,
+                                      const Operation& operation) override;
+
     void close() override;
 
     Type type() const override { return Type::kRemotelyControlledSampler; }
@@ -71,6 +75,9 @@ class RemotelyControlledSampler : public Sampler {
 
     std::string _serviceName;
     std::string _samplingServerURL;
+    // Only accessed through std::atomic_load and std::atomic_store, so
+    // isSampled never waits for the poll thread. A replaced sampler is
+    // destroyed once the last isSampled call using it returns.
     std::shared_ptr<Sampler> _sampler;
     int _maxOperations;
     Clock::duration _samplingRefreshInterval;
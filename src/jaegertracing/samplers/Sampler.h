@@ -17,6 +17,7 @@
 #ifndef JAEGERTRACING_SAMPLERS_SAMPLER_H
 #define JAEGERTRACING_SAMPLERS_SAMPLER_H
 
+#include "jaegertracing/Operation.h"
 #include "jaegertracing/TraceID.h"
 #include "jaegertracing/samplers/SamplingStatus.h"
 
@@ -39,6 +40,14 @@ class Sampler {
     virtual SamplingStatus isSampled(const TraceID& id,
                                      const std::string& operation) = 0;
 
+    // Same as isSampled(id, operation.name()). Samplers that look up
+    // operations override it to use the precomputed hash.
+    virtual SamplingStatus isOperationSampled(const TraceID& id,
+                                              const Operation& operation)
+    {
+        return isSampled(id, operation.name());
+    }
+
     virtual void close() = 0;
 
     virtual Type type() const = 0;
@@ -14,15 +14,21 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <memory>
 #include <random>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "jaegertracing/Constants.h"
+#include "jaegertracing/Operation.h"
 #include "jaegertracing/Tag.h"
 #include "jaegertracing/samplers/AdaptiveSampler.h"
 #include "jaegertracing/samplers/ConstSampler.h"
 #include "jaegertracing/samplers/GuaranteedThroughputProbabilisticSampler.h"
+#include "jaegertracing/samplers/OperationSamplerTable.h"
 #include "jaegertracing/samplers/ProbabilisticSampler.h"
 #include "jaegertracing/samplers/RateLimitingSampler.h"
 #include "jaegertracing/samplers/RemotelyControlledSampler.h"
@@ -300,6 +306,133 @@ TEST(Sampler, testAdaptiveSamplerUpdate)
     sampler.update(newStrategies);
 }
 
+TEST(Sampler, testAdaptiveSamplerMaxOperations)
+{
+    sampling_manager::thrift::PerOperationSamplingStrategies strategies;
+    strategies.__set_defaultSamplingProbability(1.0);
+    strategies.__set_defaultLowerBoundTracesPerSecond(1.0);
+    AdaptiveSampler sampler(strategies, kTestDefaultMaxOperations);
+
+    // Every operation, including those past the limit that fall back to
+    // the default sampler, is sampled by a probabilistic sampler.
+    const Tag expectedTags[] = { { "sampler.type", "probabilistic" },
+                                 { "sampler.param", 1.0 } };
+    for (auto i = 0; i < kTestDefaultMaxOperations * 2; ++i) {
+        const auto operation = "op" + std::to_string(i);
+        const auto result = sampler.isSampled(TraceID(0, 1), operation);
+        ASSERT_TRUE(result.isSampled());
+        CMP_TAGS(expectedTags, result.tags());
+    }
+}
+
+TEST(Sampler, testOperationSamplerTable)
+{
+    constexpr auto kNumOperations = 1000;
+    OperationSamplerTable table;
+    const auto sampler =
+        std::make_shared<GuaranteedThroughputProbabilisticSampler>(1.0, 0.5);
+    for (auto i = 0; i < kNumOperations; ++i) {
+        const auto operation = "op" + std::to_string(i);
+        const auto hash = OperationSamplerTable::hash(operation);
+        ASSERT_EQ(nullptr, table.find(operation, hash));
+        auto* entry = table.insert(operation, hash, sampler);
+        ASSERT_NE(nullptr, entry);
+        ASSERT_EQ(entry, table.insert(operation, hash, nullptr));
+    }
+    ASSERT_EQ(static_cast<size_t>(kNumOperations), table.size());
+    for (auto i = 0; i < kNumOperations; ++i) {
+        const auto operation = "op" + std::to_string(i);
+        const auto* entry = table.find(operation);
+        ASSERT_NE(nullptr, entry);
+        ASSERT_EQ(operation, entry->operation());
+        ASSERT_EQ(sampler, entry->sampler());
+    }
+    ASSERT_EQ(nullptr, table.insert("new", 0, sampler, kNumOperations));
+}
+
+TEST(Sampler, testOperationSamplerTableCachesEntry)
+{
+    const Operation operation("op", {});
+    const auto sampler =
+        std::make_shared<GuaranteedThroughputProbabilisticSampler>(1.0, 0.5);
+    std::unique_ptr<OperationSamplerTable> table(new OperationSamplerTable());
+    ASSERT_EQ(nullptr, table->find(operation));
+    auto* entry = table->insert(operation.name(), operation.hash(), sampler);
+    ASSERT_EQ(entry, table->find(operation));
+
+    // Another table never sees the cached entry, even once the first one
+    // is gone.
+    OperationSamplerTable otherTable;
+    ASSERT_EQ(nullptr, otherTable.find(operation));
+    table.reset();
+    ASSERT_EQ(nullptr, otherTable.find(operation));
+    auto* otherEntry =
+        otherTable.insert(operation.name(), operation.hash(), sampler);
+    ASSERT_EQ(otherEntry, otherTable.find(operation));
+}
+
+TEST(Sampler, testOperationSamplerSlotOwnerChanges)
+{
+    const Operation operation("op", {});
+    auto first = 1;
+    auto second = 2;
+    operation.setSamplerSlot(1, &first);
+    ASSERT_EQ(&first, operation.samplerSlot(1));
+    ASSERT_EQ(nullptr, operation.samplerSlot(2));
+
+    // A sampler replacing the first one takes over the slot.
+    operation.setSamplerSlot(2, &second);
+    ASSERT_EQ(nullptr, operation.samplerSlot(1));
+    ASSERT_EQ(&second, operation.samplerSlot(2));
+
+    // Owners racing for the slot never see each other's.
+    constexpr auto kNumThreads = 4;
+    constexpr auto kNumIterations = 10000;
+    std::vector<int> slots(kNumThreads);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&operation, &slots, i]() {
+            const auto owner = static_cast<uint64_t>(i + 10);
+            for (auto j = 0; j < kNumIterations; ++j) {
+                operation.setSamplerSlot(owner, &slots[i]);
+                auto* slot = operation.samplerSlot(owner);
+                ASSERT_TRUE(slot == nullptr || slot == &slots[i]);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+}
+
+TEST(Sampler, testOperationSamplerTableConcurrentInsert)
+{
+    constexpr auto kNumThreads = 4;
+    constexpr auto kNumOperations = 500;
+    constexpr auto kMaxOperations = 400;
+    OperationSamplerTable table;
+    const auto sampler =
+        std::make_shared<GuaranteedThroughputProbabilisticSampler>(1.0, 0.5);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&table, &sampler]() {
+            for (auto j = 0; j < kNumOperations; ++j) {
+                const auto operation = "op" + std::to_string(j);
+                const auto hash = OperationSamplerTable::hash(operation);
+                if (!table.find(operation, hash)) {
+                    table.insert(operation, hash, sampler, kMaxOperations);
+                }
+                const auto* entry = table.find(operation, hash);
+                ASSERT_EQ(j < kMaxOperations, entry != nullptr);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(static_cast<size_t>(kMaxOperations), table.size());
+}
+
 TEST(Sampler, testRemotelyControlledSampler)
 {
     const auto mockAgent = testutils::MockAgent::make();
@@ -328,5 +461,53 @@ TEST(Sampler, testRemotelyControlledSampler)
     sampler.close();
 }
 
+TEST(Sampler, testRemotelyControlledSamplerConcurrentUpdate)
+{
+    constexpr auto kNumThreads = 4;
+    const auto mockAgent = testutils::MockAgent::make();
+    mockAgent->start();
+    sampling_manager::thrift::ProbabilisticSamplingStrategy probabilistic;
+    probabilistic.__set_samplingRate(1.0);
+    sampling_manager::thrift::SamplingStrategyResponse response;
+    response.__set_strategyType(
+        sampling_manager::thrift::SamplingStrategyType::PROBABILISTIC);
+    response.__set_probabilisticSampling(probabilistic);
+    mockAgent->addSamplingStrategy("test-service", response);
+
+    const auto logger = logging::nullLogger();
+    const auto metrics = metrics::Metrics::makeNullMetrics();
+    RemotelyControlledSampler sampler(
+        "test-service",
+        "http://" + mockAgent->samplingServerAddress().authority(),
+        std::make_shared<ConstSampler>(false),
+        kTestDefaultMaxOperations,
+        std::chrono::milliseconds(10),
+        *logger,
+        *metrics);
+
+    // Every thread keeps sampling while the poll thread swaps in the new
+    // sampler, and must eventually see it.
+    std::atomic<int> numUpdated(0);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&sampler, &numUpdated]() {
+            const auto startTime = RemotelyControlledSampler::Clock::now();
+            while (RemotelyControlledSampler::Clock::now() - startTime <
+                   std::chrono::seconds(5)) {
+                if (sampler.isSampled(TraceID(1, 1), kTestOperationName)
+                        .isSampled()) {
+                    ++numUpdated;
+                    return;
+                }
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    sampler.close();
+    ASSERT_EQ(kNumThreads, numUpdated);
+}
+
 }  // namespace samplers
 }  // namespace jaegertracing
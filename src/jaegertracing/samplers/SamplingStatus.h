@@ -17,6 +17,7 @@
 #ifndef JAEGERTRACING_SAMPLERS_SAMPLINGSTATUS_H
 #define JAEGERTRACING_SAMPLERS_SAMPLINGSTATUS_H
 
+#include <memory>
 #include <vector>
 
 #include "jaegertracing/Tag.h"
@@ -26,19 +27,36 @@ namespace samplers {
 
 class SamplingStatus {
   public:
+    // Samplers build their tags once and share them with every status they
+    // return, instead of copying the vector per sampled trace.
+    using Tags = std::shared_ptr<const std::vector<Tag>>;
+
+    static Tags makeTags(std::vector<Tag> tags)
+    {
+        return std::make_shared<const std::vector<Tag>>(std::move(tags));
+    }
+
     SamplingStatus(bool isSampled, const std::vector<Tag>& tags)
         : _isSampled(isSampled)
-        , _tags(tags)
+        , _tags(makeTags(tags))
+    {
+    }
+
+    SamplingStatus(bool isSampled, Tags tags)
+        : _isSampled(isSampled)
+        , _tags(std::move(tags))
     {
     }
 
     bool isSampled() const { return _isSampled; }
 
-    const std::vector<Tag>& tags() const { return _tags; }
+    const std::vector<Tag>& tags() const { return *_tags; }
+
+    const Tags& sharedTags() const { return _tags; }
 
   private:
     bool _isSampled;
-    std::vector<Tag> _tags;
+    Tags _tags;
 };
 
 }  // namespace samplers
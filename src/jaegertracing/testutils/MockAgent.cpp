@@ -16,9 +16,14 @@
 
 #include "jaegertracing/testutils/MockAgent.h"
 
+#include <cstring>
 #include <regex>
 #include <thread>
 
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
 #include <thrift/protocol/TCompactProtocol.h>
 #include <thrift/transport/TBufferTransports.h>
 
@@ -29,6 +34,7 @@
 #include "jaegertracing/net/http/Response.h"
 #include "jaegertracing/samplers/RemoteSamplingJSON.h"
 #include "jaegertracing/utils/ErrorUtil.h"
+#include "jaegertracing/utils/ShmRing.h"
 #include "jaegertracing/utils/UDPClient.h"
 
 namespace jaegertracing {
@@ -43,6 +49,71 @@ bool startsWith(const std::string& str, const std::string& prefix)
     return std::equal(std::begin(prefix), std::end(prefix), std::begin(str));
 }
 
+void bindUnixSocket(net::Socket& socket, const std::string& path)
+{
+    const auto addr = utils::UnixDatagramClient::address(path);
+    ::unlink(path.c_str());
+    socket.open(AF_UNIX, SOCK_DGRAM);
+    if (::bind(socket.handle(),
+               reinterpret_cast<const ::sockaddr*>(&addr),
+               sizeof(addr)) != 0) {
+        throw std::system_error(
+            errno, std::system_category(), "Failed to bind socket to " + path);
+    }
+}
+
+// Receives a ring registered by utils::ShmRingClient and adds it to `rings`
+// unless it is there already.
+void receiveRing(int socketFD, std::vector<utils::ShmRing>& rings)
+{
+    constexpr auto kNumFDs = 2;
+    uint32_t magic = 0;
+    ::iovec payload;
+    payload.iov_base = &magic;
+    payload.iov_len = sizeof(magic);
+    union {
+        char _buffer[CMSG_SPACE(kNumFDs * sizeof(int))];
+        ::cmsghdr _align;
+    } control;
+    ::msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &payload;
+    message.msg_iovlen = 1;
+    message.msg_control = control._buffer;
+    message.msg_controllen = sizeof(control._buffer);
+    if (::recvmsg(socketFD, &message, 0) <= 0) {
+        return;
+    }
+
+    int fds[kNumFDs] = { -1, -1 };
+    const auto* header = CMSG_FIRSTHDR(&message);
+    if (header && header->cmsg_level == SOL_SOCKET &&
+        header->cmsg_type == SCM_RIGHTS &&
+        header->cmsg_len == CMSG_LEN(sizeof(fds))) {
+        std::memcpy(fds, CMSG_DATA(header), sizeof(fds));
+    }
+    struct ::stat status;
+    auto known = (magic != utils::ShmRing::kMagic || fds[0] < 0 ||
+                  ::fstat(fds[0], &status) != 0);
+    for (auto&& ring : rings) {
+        struct ::stat ringStatus;
+        if (!known && ::fstat(ring.memoryFD(), &ringStatus) == 0 &&
+            ringStatus.st_dev == status.st_dev &&
+            ringStatus.st_ino == status.st_ino) {
+            known = true;
+        }
+    }
+    if (known) {
+        for (auto fd : fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        return;
+    }
+    rings.emplace_back(utils::ShmRing::attach(fds[0], fds[1]));
+}
+
 }  // anonymous namespace
 
 MockAgent::~MockAgent() { close(); }
@@ -56,6 +127,22 @@ void MockAgent::start()
         std::thread([this, &startedHTTP]() { serveHTTP(startedHTTP); });
     startedUDP.get_future().wait();
     startedHTTP.get_future().wait();
+
+    if (!_unixPath.empty()) {
+        bindUnixSocket(_unixSocket, _unixPath);
+        std::promise<void> startedUnix;
+        _unixThread =
+            std::thread([this, &startedUnix]() { serveUnix(startedUnix); });
+        startedUnix.get_future().wait();
+    }
+
+    if (!_ringPath.empty()) {
+        bindUnixSocket(_ringSocket, _ringPath);
+        std::promise<void> startedRing;
+        _ringThread =
+            std::thread([this, &startedRing]() { serveRing(startedRing); });
+        startedRing.get_future().wait();
+    }
 }
 
 void MockAgent::close()
@@ -70,6 +157,23 @@ void MockAgent::close()
         _servingHTTP = false;
         _httpThread.join();
     }
+
+    if (_servingUnix) {
+        _servingUnix = false;
+        // Unlike close, shutdown wakes the blocked receive.
+        ::shutdown(_unixSocket.handle(), SHUT_RDWR);
+        _unixThread.join();
+        _unixSocket.close();
+        ::unlink(_unixPath.c_str());
+    }
+
+    if (_servingRing) {
+        _servingRing = false;
+        ::shutdown(_ringSocket.handle(), SHUT_RDWR);
+        _ringThread.join();
+        _ringSocket.close();
+        ::unlink(_ringPath.c_str());
+    }
 }
 
 void MockAgent::emitBatch(const thrift::Batch& batch)
@@ -81,6 +185,9 @@ void MockAgent::emitBatch(const thrift::Batch& batch)
 MockAgent::MockAgent()
     : _transport(net::IPAddress::v4("127.0.0.1", 0))
     , _servingUDP(false)
+    , _servingHTTP(false)
+    , _servingUnix(false)
+    , _servingRing(false)
 {
 }
 
@@ -116,6 +223,98 @@ void MockAgent::serveUDP(std::promise<void>& started)
     }
 }
 
+void MockAgent::serveUnix(std::promise<void>& started)
+{
+    using TCompactProtocolFactory =
+        apache::thrift::protocol::TCompactProtocolFactory;
+    using TMemoryBuffer = apache::thrift::transport::TMemoryBuffer;
+
+    auto iface = shared_from_this();
+    agent::thrift::AgentProcessor handler(iface);
+    TCompactProtocolFactory protocolFactory;
+    std::shared_ptr<TMemoryBuffer> trans(
+        new TMemoryBuffer(net::kUnixDatagramMaxLength));
+
+    _servingUnix = true;
+    started.set_value();
+
+    std::vector<uint8_t> buffer(net::kUnixDatagramMaxLength);
+    while (isServingUnix()) {
+        const auto numRead =
+            ::recv(_unixSocket.handle(), &buffer[0], buffer.size(), 0);
+        if (numRead <= 0) {
+            continue;
+        }
+        try {
+            trans->write(&buffer[0], numRead);
+            auto protocol = protocolFactory.getProtocol(trans);
+            handler.process(protocol, protocol, nullptr);
+        } catch (...) {
+            auto logger = logging::consoleLogger();
+            utils::ErrorUtil::logError(
+                *logger, "An error occurred in MockAgent::serveUnix");
+        }
+    }
+}
+
+void MockAgent::serveRing(std::promise<void>& started)
+{
+    using TCompactProtocolFactory =
+        apache::thrift::protocol::TCompactProtocolFactory;
+    using TMemoryBuffer = apache::thrift::transport::TMemoryBuffer;
+
+    auto iface = shared_from_this();
+    agent::thrift::AgentProcessor handler(iface);
+    TCompactProtocolFactory protocolFactory;
+    std::shared_ptr<TMemoryBuffer> trans(
+        new TMemoryBuffer(net::kUnixDatagramMaxLength));
+
+    _servingRing = true;
+    started.set_value();
+
+    std::vector<utils::ShmRing> rings;
+    std::vector<::pollfd> pollFDs;
+    std::string message;
+    while (isServingRing()) {
+        try {
+            auto wait = true;
+            for (auto&& ring : rings) {
+                while (ring.tryRead(message)) {
+                    trans->write(
+                        reinterpret_cast<const uint8_t*>(message.data()),
+                        message.size());
+                    auto protocol = protocolFactory.getProtocol(trans);
+                    handler.process(protocol, protocol, nullptr);
+                }
+                wait = ring.prepareWait() && wait;
+            }
+
+            // Sleep until a ring is rung or another one is registered.
+            pollFDs.resize(rings.size() + 1);
+            pollFDs[0].fd = _ringSocket.handle();
+            for (auto i = static_cast<std::size_t>(0); i < rings.size();
+                 ++i) {
+                pollFDs[i + 1].fd = rings[i].doorbellFD();
+            }
+            for (auto&& pollFD : pollFDs) {
+                pollFD.events = POLLIN;
+                pollFD.revents = 0;
+            }
+            ::poll(&pollFDs[0], pollFDs.size(), wait ? -1 : 0);
+            for (auto&& ring : rings) {
+                ring.finishWait();
+            }
+            if ((pollFDs[0].revents & POLLIN) != 0 && isServingRing()) {
+                receiveRing(_ringSocket.handle(), rings);
+            }
+        } catch (...) {
+            auto logger = logging::consoleLogger();
+            utils::ErrorUtil::logError(
+                *logger, "An error occurred in MockAgent::serveRing");
+        }
+    }
+}
+
 void MockAgent::serveHTTP(std::promise<void>& started)
 {
     net::Socket socket;
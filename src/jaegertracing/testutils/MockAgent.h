@@ -23,7 +23,9 @@
 #include "jaegertracing/testutils/TUDPTransport.h"
 #include "jaegertracing/thrift-gen/Agent.h"
 #include "jaegertracing/thrift-gen/jaeger_types.h"
+#include "jaegertracing/utils/ShmRingClient.h"
 #include "jaegertracing/utils/UDPClient.h"
+#include "jaegertracing/utils/UnixDatagramClient.h"
 #include <atomic>
 #include <future>
 #include <memory>
@@ -70,6 +72,14 @@ class MockAgent : public agent::thrift::AgentIf,
 
     void close();
 
+    // Also receive spans as Unix datagrams on a socket bound to `path` when
+    // started. The socket file is removed on close.
+    void listenUnix(const std::string& path) { _unixPath = path; }
+
+    // Also drain shared memory rings registered on a Unix socket bound to
+    // `path` when started. The socket file is removed on close.
+    void listenRing(const std::string& path) { _ringPath = path; }
+
     void
     emitZipkinBatch(const std::vector<twitter::zipkin::thrift::Span>&) override
     {
@@ -82,6 +92,10 @@ class MockAgent : public agent::thrift::AgentIf,
 
     bool isServingHTTP() const { return _servingHTTP; }
 
+    bool isServingUnix() const { return _servingUnix; }
+
+    bool isServingRing() const { return _servingRing; }
+
     template <typename... Args>
     void addSamplingStrategy(Args&&... args)
     {
@@ -108,6 +122,22 @@ class MockAgent : public agent::thrift::AgentIf,
             new utils::UDPClient(spanServerAddress(), 0));
     }
 
+    const std::string& spanServerUnixPath() const { return _unixPath; }
+
+    std::unique_ptr<agent::thrift::AgentIf> spanServerUnixClient()
+    {
+        return std::unique_ptr<agent::thrift::AgentIf>(
+            new utils::UnixDatagramClient(spanServerUnixPath(), 0));
+    }
+
+    const std::string& spanServerRingPath() const { return _ringPath; }
+
+    std::unique_ptr<agent::thrift::AgentIf> spanServerRingClient()
+    {
+        return std::unique_ptr<agent::thrift::AgentIf>(
+            new utils::ShmRingClient(spanServerRingPath(), 0));
+    }
+
     net::IPAddress samplingServerAddress() const { return _httpAddress; }
 
     void resetBatches()
@@ -123,16 +153,28 @@ class MockAgent : public agent::thrift::AgentIf,
 
     void serveHTTP(std::promise<void>& started);
 
+    void serveUnix(std::promise<void>& started);
+
+    void serveRing(std::promise<void>& started);
+
     TUDPTransport _transport;
     std::vector<thrift::Batch> _batches;
     std::atomic<bool> _servingUDP;
     std::atomic<bool> _servingHTTP;
+    std::atomic<bool> _servingUnix;
+    std::atomic<bool> _servingRing;
     SamplingManager _samplingMgr;
     KeyRestrictionMap _restrictions;
     mutable std::mutex _mutex;
     std::thread _udpThread;
     std::thread _httpThread;
+    std::thread _unixThread;
+    std::thread _ringThread;
     net::IPAddress _httpAddress;
+    std::string _unixPath;
+    net::Socket _unixSocket;
+    std::string _ringPath;
+    net::Socket _ringSocket;
 };
 
 }  // namespace testutils
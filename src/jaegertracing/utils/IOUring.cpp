@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/IOUring.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "jaegertracing/Constants.h"
+
+#if defined(JAEGERTRACING_WITH_IO_URING) && defined(__NR_io_uring_setup)
+#define JAEGERTRACING_IO_URING_SYSCALLS
+#include <linux/io_uring.h>
+#endif
+
+namespace jaegertracing {
+namespace utils {
+
+#ifdef JAEGERTRACING_IO_URING_SYSCALLS
+
+namespace {
+
+int setup(unsigned numEntries, ::io_uring_params& params)
+{
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_setup, numEntries, &params));
+}
+
+int enter(int fd, unsigned toSubmit, unsigned minComplete)
+{
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_enter,
+                  fd,
+                  toSubmit,
+                  minComplete,
+                  minComplete > 0 ? IORING_ENTER_GETEVENTS : 0U,
+                  nullptr,
+                  0));
+}
+
+void* mapRing(int fd, std::size_t size, off_t offset)
+{
+    return ::mmap(nullptr,
+                  size,
+                  PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE,
+                  fd,
+                  offset);
+}
+
+template <typename T>
+T* at(void* ring, unsigned offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+}  // anonymous namespace
+
+std::unique_ptr<IOUring> IOUring::make(unsigned numEntries)
+{
+    ::io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    const auto fd = setup(numEntries, params);
+    if (fd < 0) {
+        return std::unique_ptr<IOUring>();
+    }
+
+    std::unique_ptr<IOUring> ring(new IOUring());
+    ring->_fd = fd;
+    ring->_sqRingSize =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->_sqRing = mapRing(fd, ring->_sqRingSize, IORING_OFF_SQ_RING);
+    ring->_sqesSize = params.sq_entries * sizeof(::io_uring_sqe);
+    auto* sqes = mapRing(fd, ring->_sqesSize, IORING_OFF_SQES);
+    ring->_cqRingSize =
+        params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+    ring->_cqRing = mapRing(fd, ring->_cqRingSize, IORING_OFF_CQ_RING);
+    if (ring->_sqRing == MAP_FAILED || sqes == MAP_FAILED ||
+        ring->_cqRing == MAP_FAILED) {
+        // The destructor unmaps whatever did map.
+        if (sqes != MAP_FAILED) {
+            ring->_sqes = static_cast<::io_uring_sqe*>(sqes);
+        }
+        return std::unique_ptr<IOUring>();
+    }
+
+    ring->_sqHead = at<unsigned>(ring->_sqRing, params.sq_off.head);
+    ring->_sqTail = at<unsigned>(ring->_sqRing, params.sq_off.tail);
+    ring->_sqMask = *at<unsigned>(ring->_sqRing, params.sq_off.ring_mask);
+    ring->_sqEntries = params.sq_entries;
+    ring->_sqArray = at<unsigned>(ring->_sqRing, params.sq_off.array);
+    ring->_sqes = static_cast<::io_uring_sqe*>(sqes);
+    ring->_cqHead = at<unsigned>(ring->_cqRing, params.cq_off.head);
+    ring->_cqTail = at<unsigned>(ring->_cqRing, params.cq_off.tail);
+    ring->_cqMask = *at<unsigned>(ring->_cqRing, params.cq_off.ring_mask);
+    ring->_cqes = at<::io_uring_cqe>(ring->_cqRing, params.cq_off.cqes);
+    return ring;
+}
+
+IOUring::~IOUring()
+{
+    if (_sqes) {
+        ::munmap(_sqes, _sqesSize);
+    }
+    if (_sqRing && _sqRing != MAP_FAILED) {
+        ::munmap(_sqRing, _sqRingSize);
+    }
+    if (_cqRing && _cqRing != MAP_FAILED) {
+        ::munmap(_cqRing, _cqRingSize);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+}
+
+bool IOUring::registerBuffers(const ::iovec* buffers, unsigned numBuffers)
+{
+    return ::syscall(__NR_io_uring_register,
+                     _fd,
+                     IORING_REGISTER_BUFFERS,
+                     buffers,
+                     numBuffers) == 0;
+}
+
+bool IOUring::prepareWrite(int fd,
+                           const void* data,
+                           unsigned size,
+                           int bufferIndex,
+                           uint64_t userData)
+{
+    // Only this thread moves the tail, the kernel moves the head.
+    const auto tail = *_sqTail;
+    if (tail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) >= _sqEntries) {
+        return false;
+    }
+    const auto index = tail & _sqMask;
+    auto& sqe = _sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_WRITE_FIXED;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(data);
+    sqe.len = size;
+    sqe.buf_index = static_cast<uint16_t>(bufferIndex);
+    sqe.user_data = userData;
+    _sqArray[index] = index;
+    __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++_numQueued;
+    return true;
+}
+
+void IOUring::submit(unsigned minComplete)
+{
+    while (_numQueued > 0 || minComplete > 0) {
+        const auto result = enter(_fd, _numQueued, minComplete);
+        if (result >= 0) {
+            _numQueued -= static_cast<unsigned>(result);
+            return;
+        }
+        if (errno != EINTR) {
+            throw std::system_error(
+                errno, std::system_category(), "Failed to submit to io_uring");
+        }
+    }
+}
+
+bool IOUring::tryReap(uint64_t& userData, int& result)
+{
+    // Only this thread moves the head, the kernel moves the tail.
+    const auto head = *_cqHead;
+    if (head == __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    const auto& cqe = _cqes[head & _cqMask];
+    userData = cqe.user_data;
+    result = cqe.res;
+    __atomic_store_n(_cqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#else
+
+std::unique_ptr<IOUring> IOUring::make(unsigned)
+{
+    return std::unique_ptr<IOUring>();
+}
+
+IOUring::~IOUring() {}
+
+bool IOUring::registerBuffers(const ::iovec*, unsigned) { return false; }
+
+bool IOUring::prepareWrite(int, const void*, unsigned, int, uint64_t)
+{
+    return false;
+}
+
+void IOUring::submit(unsigned) {}
+
+bool IOUring::tryReap(uint64_t&, int&) { return false; }
+
+#endif  // JAEGERTRACING_IO_URING_SYSCALLS
+
+IOUring::IOUring()
+    : _fd(-1)
+    , _numQueued(0)
+    , _sqRing(nullptr)
+    , _sqRingSize(0)
+    , _sqHead(nullptr)
+    , _sqTail(nullptr)
+    , _sqMask(0)
+    , _sqEntries(0)
+    , _sqArray(nullptr)
+    , _sqes(nullptr)
+    , _sqesSize(0)
+    , _cqRing(nullptr)
+    , _cqRingSize(0)
+    , _cqHead(nullptr)
+    , _cqTail(nullptr)
+    , _cqMask(0)
+    , _cqes(nullptr)
+{
+}
+
+std::unique_ptr<IOUringSender>
+IOUringSender::make(int fd, std::size_t maxMessageSize, int numBuffers)
+{
+    auto ring = IOUring::make(static_cast<unsigned>(numBuffers));
+    if (!ring) {
+        return std::unique_ptr<IOUringSender>();
+    }
+    std::unique_ptr<IOUringSender> sender(new IOUringSender(
+        std::move(ring), fd, maxMessageSize, numBuffers));
+    std::vector<::iovec> buffers(numBuffers);
+    for (auto i = 0; i < numBuffers; ++i) {
+        buffers[i].iov_base = sender->buffer(i);
+        buffers[i].iov_len = maxMessageSize;
+    }
+    if (!sender->_ring->registerBuffers(&buffers[0],
+                                        static_cast<unsigned>(numBuffers))) {
+        return std::unique_ptr<IOUringSender>();
+    }
+    return sender;
+}
+
+IOUringSender::IOUringSender(std::unique_ptr<IOUring>&& ring,
+                             int fd,
+                             std::size_t maxMessageSize,
+                             int numBuffers)
+    : _ring(std::move(ring))
+    , _fd(fd)
+    , _maxMessageSize(maxMessageSize)
+    , _buffers(new char[maxMessageSize * numBuffers])
+    , _freeBuffers()
+    , _numBuffers(numBuffers)
+    , _numWouldBlock(0)
+{
+    for (auto i = numBuffers - 1; i >= 0; --i) {
+        _freeBuffers.push_back(i);
+    }
+}
+
+IOUringSender::~IOUringSender()
+{
+    // The kernel may still read the buffers of writes in flight.
+    try {
+        auto numLost = 0;
+        auto numDropped = 0;
+        waitAll(numLost, numDropped);
+    } catch (...) {
+    }
+}
+
+int IOUringSender::sendMany(const ::iovec* messages,
+                            const int* weights,
+                            int numMessages,
+                            int& numLost,
+                            int& numDropped)
+{
+    for (auto i = 0; i < numMessages; ++i) {
+        if (messages[i].iov_len > _maxMessageSize) {
+            throw std::system_error(
+                EMSGSIZE, std::system_category(), "Message too long");
+        }
+    }
+
+    auto numSent = 0;
+    reap(numSent, numLost, numDropped);
+    for (auto i = 0; i < numMessages; ++i) {
+        const auto& message = messages[i];
+        while (_freeBuffers.empty()) {
+            // Sends to a socket complete almost at once, so this is short.
+            _ring->submit(1);
+            reap(numSent, numLost, numDropped);
+        }
+        const auto bufferIndex = _freeBuffers.back();
+        _freeBuffers.pop_back();
+        std::memcpy(buffer(bufferIndex), message.iov_base, message.iov_len);
+        // The completion carries the weight in the upper half of its user
+        // data and the buffer in the lower half.
+        const auto weight = weights ? weights[i] : 1;
+        const auto userData =
+            (static_cast<uint64_t>(static_cast<uint32_t>(weight)) << 32) |
+            static_cast<uint32_t>(bufferIndex);
+        // Every buffer has a queue entry, so there is always room.
+        const auto queued =
+            _ring->prepareWrite(_fd,
+                                buffer(bufferIndex),
+                                static_cast<unsigned>(message.iov_len),
+                                bufferIndex,
+                                userData);
+        assert(queued);
+        (void)queued;
+    }
+    _ring->submit(0);
+    return numSent;
+}
+
+int IOUringSender::waitAll(int& numLost, int& numDropped)
+{
+    auto numSent = 0;
+    reap(numSent, numLost, numDropped);
+    while (static_cast<int>(_freeBuffers.size()) < _numBuffers) {
+        _ring->submit(1);
+        reap(numSent, numLost, numDropped);
+    }
+    return numSent;
+}
+
+void IOUringSender::reap(int& numSent, int& numLost, int& numDropped)
+{
+    uint64_t userData = 0;
+    auto result = 0;
+    while (_ring->tryReap(userData, result)) {
+        _freeBuffers.push_back(static_cast<int>(userData & 0xffffffff));
+        const auto weight = static_cast<int>(userData >> 32);
+        if (result >= 0) {
+            numSent += weight;
+            continue;
+        }
+        if (result == -EAGAIN || result == -EWOULDBLOCK) {
+            numDropped += weight;
+            ++_numWouldBlock;
+        }
+        else {
+            numLost += weight;
+        }
+    }
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UTILS_IOURING_H
+#define JAEGERTRACING_UTILS_IOURING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <sys/uio.h>
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace jaegertracing {
+namespace utils {
+
+// Minimal Linux io_uring: a submission and a completion queue shared with
+// the kernel, driven with raw system calls so liburing is not needed. Not
+// thread-safe.
+class IOUring {
+  public:
+    // Returns null if io_uring is unavailable: the kernel is older than
+    // 5.1, it is disabled or filtered out, or the build lacks it.
+    static std::unique_ptr<IOUring> make(unsigned numEntries);
+
+    IOUring(const IOUring&) = delete;
+
+    IOUring& operator=(const IOUring&) = delete;
+
+    ~IOUring();
+
+    // Registers buffers once, so writes from them skip mapping the pages on
+    // every request. Returns false if the kernel refuses, e.g. over
+    // RLIMIT_MEMLOCK.
+    bool registerBuffers(const ::iovec* buffers, unsigned numBuffers);
+
+    // Queues a write of `size` bytes at `data`, inside the registered
+    // buffer `bufferIndex`, to `fd`. The data must stay unchanged until the
+    // completion is reaped. Returns false if the submission queue is full.
+    bool prepareWrite(int fd,
+                      const void* data,
+                      unsigned size,
+                      int bufferIndex,
+                      uint64_t userData);
+
+    // Submits the queued writes and waits for `minComplete` completions,
+    // in one system call. Throws std::system_error on failure.
+    void submit(unsigned minComplete);
+
+    // Takes one completion, without a system call. `result` is what the
+    // write returned, or minus the error number.
+    bool tryReap(uint64_t& userData, int& result);
+
+  private:
+    IOUring();
+
+    int _fd;
+    unsigned _numQueued;
+    // Submission queue ring.
+    void* _sqRing;
+    std::size_t _sqRingSize;
+    unsigned* _sqHead;
+    unsigned* _sqTail;
+    unsigned _sqMask;
+    unsigned _sqEntries;
+    unsigned* _sqArray;
+    ::io_uring_sqe* _sqes;
+    std::size_t _sqesSize;
+    // Completion queue ring.
+    void* _cqRing;
+    std::size_t _cqRingSize;
+    unsigned* _cqHead;
+    unsigned* _cqTail;
+    unsigned _cqMask;
+    ::io_uring_cqe* _cqes;
+};
+
+// Sends datagrams on a connected socket through io_uring. Messages are
+// copied into buffers registered once, submitted together in one system
+// call, and reaped on a later send without one. So a flush never waits for
+// the kernel to finish sending, and learns how earlier messages fared
+// instead.
+class IOUringSender {
+  public:
+    // Returns null if io_uring is unavailable or the buffers cannot be
+    // registered.
+    static std::unique_ptr<IOUringSender>
+    make(int fd, std::size_t maxMessageSize, int numBuffers);
+
+    IOUringSender(const IOUringSender&) = delete;
+
+    IOUringSender& operator=(const IOUringSender&) = delete;
+
+    ~IOUringSender();
+
+    // Submits the messages. Each counts for its weight, e.g. the number of
+    // spans in it, or for one if `weights` is null. Whether a message was
+    // sent is only known once it is reaped, by this or a later call. Returns
+    // the weights of messages reaped as sent, adds those of messages reaped
+    // because the socket send buffer was full to `numDropped`, and those of
+    // messages reaped as otherwise failed to `numLost`. Throws
+    // std::system_error, before submitting anything, if a message is too
+    // long.
+    int sendMany(const ::iovec* messages,
+                 const int* weights,
+                 int numMessages,
+                 int& numLost,
+                 int& numDropped);
+
+    // Waits for all messages in flight, and reports them like sendMany.
+    int waitAll(int& numLost, int& numDropped);
+
+    // Messages that failed because the socket send buffer was full.
+    int64_t numWouldBlock() const { return _numWouldBlock; }
+
+  private:
+    IOUringSender(std::unique_ptr<IOUring>&& ring,
+                  int fd,
+                  std::size_t maxMessageSize,
+                  int numBuffers);
+
+    char* buffer(int index) { return &_buffers[index * _maxMessageSize]; }
+
+    // Frees the buffers of completed writes, adding their weights to
+    // `numSent`, `numLost` or `numDropped`.
+    void reap(int& numSent, int& numLost, int& numDropped);
+
+    std::unique_ptr<IOUring> _ring;
+    int _fd;
+    std::size_t _maxMessageSize;
+    std::unique_ptr<char[]> _buffers;
+    std::vector<int> _freeBuffers;
+    int _numBuffers;
+    int64_t _numWouldBlock;
+};
+
+}  // namespace utils
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UTILS_IOURING_H
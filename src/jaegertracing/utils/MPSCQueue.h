@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UTILS_MPSCQUEUE_H
+#define JAEGERTRACING_UTILS_MPSCQUEUE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace jaegertracing {
+namespace utils {
+
+// Bounded multi-producer/single-consumer queue with pre-allocated slots.
+// Producers claim a slot with a single CAS and never block; a full queue
+// makes tryPush fail instead. Based on Dmitry Vyukov's bounded MPMC queue,
+// with the consumer side simplified for a single thread.
+template <typename T>
+class MPSCQueue {
+  public:
+    explicit MPSCQueue(std::size_t capacity)
+        : _capacity(capacity)
+        , _slots(new Slot[capacity])
+        , _headPadding()
+        , _head(0)
+        , _tailPadding()
+        , _tail(0)
+    {
+        assert(_capacity > 0);
+        for (auto i = static_cast<std::size_t>(0); i < _capacity; ++i) {
+            _slots[i]._sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    std::size_t capacity() const { return _capacity; }
+
+    // Safe to call from any number of threads.
+    bool tryPush(T&& value)
+    {
+        auto pos = _tail.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = _slots[pos % _capacity];
+            const auto sequence =
+                slot._sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (_tail.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    slot._value = std::move(value);
+                    slot._sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                // Slot still holds a value from the previous lap.
+                return false;
+            }
+            else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Must only be called from the consumer thread.
+    bool tryPop(T& value)
+    {
+        auto& slot = _slots[_head % _capacity];
+        const auto sequence = slot._sequence.load(std::memory_order_acquire);
+        if (sequence != _head + 1) {
+            return false;
+        }
+        value = std::move(slot._value);
+        slot._value = T();
+        slot._sequence.store(_head + _capacity, std::memory_order_release);
+        ++_head;
+        return true;
+    }
+
+  private:
+    struct Slot {
+        std::atomic<std::size_t> _sequence;
+        T _value;
+    };
+
+    const std::size_t _capacity;
+    std::unique_ptr<Slot[]> _slots;
+    // Padding keeps the consumer and producer cursors on separate cache
+    // lines. alignas would need over-aligned new, which C++11 lacks.
+    char _headPadding[64];
+    std::size_t _head;
+    char _tailPadding[64];
+    std::atomic<std::size_t> _tail;
+};
+
+}  // namespace utils
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UTILS_MPSCQUEUE_H
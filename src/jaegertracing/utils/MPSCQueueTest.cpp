@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/MPSCQueue.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace jaegertracing {
+namespace utils {
+
+TEST(MPSCQueue, testBounded)
+{
+    constexpr auto kCapacity = 3;
+    MPSCQueue<int> queue(kCapacity);
+    ASSERT_EQ(kCapacity, queue.capacity());
+    for (auto i = 0; i < kCapacity; ++i) {
+        ASSERT_TRUE(queue.tryPush(int(i)));
+    }
+    ASSERT_FALSE(queue.tryPush(int(kCapacity)));
+
+    auto value = -1;
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(0, value);
+    ASSERT_TRUE(queue.tryPush(int(kCapacity)));
+    for (auto i = 1; i <= kCapacity; ++i) {
+        ASSERT_TRUE(queue.tryPop(value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(queue.tryPop(value));
+}
+
+TEST(MPSCQueue, testMultipleProducers)
+{
+    constexpr auto kNumThreads = 4;
+    constexpr auto kNumValues = 10000;
+
+    MPSCQueue<int> queue(64);
+    std::atomic<int> numDone(0);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&queue, &numDone, i]() {
+            for (auto j = 0; j < kNumValues; ++j) {
+                while (!queue.tryPush(i * kNumValues + j)) {
+                    std::this_thread::yield();
+                }
+            }
+            ++numDone;
+        });
+    }
+
+    // Values from each producer must arrive in order and exactly once.
+    std::vector<int> next(kNumThreads, 0);
+    auto numPopped = 0;
+    auto value = 0;
+    while (numPopped < kNumThreads * kNumValues) {
+        if (!queue.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const auto producer = value / kNumValues;
+        ASSERT_EQ(next[producer], value % kNumValues);
+        ++next[producer];
+        ++numPopped;
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(kNumThreads, numDone);
+    ASSERT_FALSE(queue.tryPop(value));
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
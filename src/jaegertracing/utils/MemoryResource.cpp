@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/MemoryResource.h"
+
+#include "jaegertracing/utils/ObjectPool.h"
+
+namespace jaegertracing {
+namespace utils {
+namespace {
+
+constexpr auto kTagSize = alignof(std::max_align_t);
+
+using ResourcePtr = std::shared_ptr<MemoryResource>;
+
+static_assert(kTagSize >= sizeof(ResourcePtr) &&
+                  kTagSize % alignof(ResourcePtr) == 0,
+              "no room for the resource before the object");
+
+class HeapResource : public MemoryResource {
+  protected:
+    void* doAllocate(std::size_t size) override
+    {
+        return ::operator new(size);
+    }
+
+    void doDeallocate(void* ptr, std::size_t) noexcept override
+    {
+        ::operator delete(ptr);
+    }
+};
+
+template <std::size_t Size>
+struct PoolBlock {
+    alignas(std::max_align_t) unsigned char _bytes[Size];
+};
+
+// Calls `f` with a null pointer to the pool block type for `size`, which
+// must be at most MemoryResource::kMaxPoolBlockSize. The largest classes
+// fit a span's record and a finished span, see Span.h and Span.cpp.
+template <typename Function>
+auto withPoolBlock(std::size_t size, Function f)
+    -> decltype(f(static_cast<PoolBlock<64>*>(nullptr)))
+{
+    if (size <= 64) {
+        return f(static_cast<PoolBlock<64>*>(nullptr));
+    }
+    if (size <= 128) {
+        return f(static_cast<PoolBlock<128>*>(nullptr));
+    }
+    if (size <= 256) {
+        return f(static_cast<PoolBlock<256>*>(nullptr));
+    }
+    if (size <= 512) {
+        return f(static_cast<PoolBlock<512>*>(nullptr));
+    }
+    return f(static_cast<PoolBlock<MemoryResource::kMaxPoolBlockSize>*>(
+        nullptr));
+}
+
+struct PoolAllocate {
+    template <typename Block>
+    void* operator()(Block*) const
+    {
+        ObjectPool<Block>::enable();
+        return ObjectPool<Block>::allocate(sizeof(Block));
+    }
+};
+
+struct PoolDeallocate {
+    template <typename Block>
+    void operator()(Block*) const
+    {
+        ObjectPool<Block>::deallocate(_ptr, sizeof(Block));
+    }
+
+    void* _ptr;
+};
+
+struct PoolSize {
+    template <typename Block>
+    std::size_t operator()(Block*) const
+    {
+        return ObjectPool<Block>::size();
+    }
+};
+
+class PoolResource : public MemoryResource {
+  protected:
+    void* doAllocate(std::size_t size) override
+    {
+        if (size > kMaxPoolBlockSize) {
+            return ::operator new(size);
+        }
+        return withPoolBlock(size, PoolAllocate());
+    }
+
+    void doDeallocate(void* ptr, std::size_t size) noexcept override
+    {
+        if (size > kMaxPoolBlockSize) {
+            ::operator delete(ptr);
+            return;
+        }
+        withPoolBlock(size, PoolDeallocate{ ptr });
+    }
+};
+
+}  // anonymous namespace
+
+constexpr std::size_t MemoryResource::kMaxPoolBlockSize;
+
+MemoryResource& MemoryResource::heap()
+{
+    // Never destroyed, as objects freed during static destruction may
+    // still use it.
+    static auto* resource = new HeapResource();
+    return *resource;
+}
+
+MemoryResource& MemoryResource::pool()
+{
+    static auto* resource = new PoolResource();
+    return *resource;
+}
+
+std::size_t MemoryResource::poolSize(std::size_t size)
+{
+    if (size > kMaxPoolBlockSize) {
+        return 0;
+    }
+    return withPoolBlock(size, PoolSize());
+}
+
+MemoryResource::~MemoryResource() = default;
+
+void* allocateTagged(std::size_t size, const ResourcePtr& resource)
+{
+    auto* block = static_cast<unsigned char*>(
+        resource->allocate(taggedSize(size)));
+    new (block) ResourcePtr(resource);
+    return block + kTagSize;
+}
+
+void deallocateTagged(void* ptr, std::size_t size) noexcept
+{
+    if (!ptr) {
+        return;
+    }
+    auto* block = static_cast<unsigned char*>(ptr) - kTagSize;
+    auto& tag = *reinterpret_cast<ResourcePtr*>(block);
+    // Keeps the resource alive until the block is back.
+    const auto resource = std::move(tag);
+    tag.~ResourcePtr();
+    resource->deallocate(block, taggedSize(size));
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
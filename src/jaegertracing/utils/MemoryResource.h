@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UTILS_MEMORYRESOURCE_H
+#define JAEGERTRACING_UTILS_MEMORYRESOURCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace jaegertracing {
+namespace utils {
+
+// Source of memory for the tracer, in the spirit of C++17's
+// std::pmr::memory_resource. Implementations only provide doAllocate and
+// doDeallocate; the base class keeps statistics. Memory must be suitably
+// aligned for any type. Allocator and allocateTagged share ownership of the
+// resource with everything they allocate, so it outlives its allocations.
+class MemoryResource {
+  public:
+    struct Stats {
+        uint64_t _allocations;
+        uint64_t _deallocations;
+        uint64_t _bytesAllocated;
+        uint64_t _bytesDeallocated;
+
+        uint64_t bytesInUse() const
+        {
+            return _bytesAllocated - _bytesDeallocated;
+        }
+    };
+
+    // Largest allocation pool() serves from its caches, larger ones go to
+    // the heap.
+    static constexpr std::size_t kMaxPoolBlockSize = 1024;
+
+    // Global heap, through operator new and delete.
+    static MemoryResource& heap();
+
+    // Per-thread caches of small blocks in front of the heap, see
+    // ObjectPool.
+    static MemoryResource& pool();
+
+    // Blocks the pool has cached on the calling thread for allocations of
+    // `size` bytes.
+    static std::size_t poolSize(std::size_t size);
+
+    MemoryResource()
+        : _allocations(0)
+        , _deallocations(0)
+        , _bytesAllocated(0)
+        , _bytesDeallocated(0)
+    {
+    }
+
+    MemoryResource(const MemoryResource&) = delete;
+
+    MemoryResource& operator=(const MemoryResource&) = delete;
+
+    virtual ~MemoryResource();
+
+    void* allocate(std::size_t size)
+    {
+        auto* ptr = doAllocate(size);
+        _allocations.fetch_add(1, std::memory_order_relaxed);
+        _bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    void deallocate(void* ptr, std::size_t size) noexcept
+    {
+        if (!ptr) {
+            return;
+        }
+        _deallocations.fetch_add(1, std::memory_order_relaxed);
+        _bytesDeallocated.fetch_add(size, std::memory_order_relaxed);
+        doDeallocate(ptr, size);
+    }
+
+    Stats stats() const
+    {
+        return { _allocations.load(std::memory_order_relaxed),
+                 _deallocations.load(std::memory_order_relaxed),
+                 _bytesAllocated.load(std::memory_order_relaxed),
+                 _bytesDeallocated.load(std::memory_order_relaxed) };
+    }
+
+  protected:
+    virtual void* doAllocate(std::size_t size) = 0;
+
+    virtual void doDeallocate(void* ptr, std::size_t size) noexcept = 0;
+
+  private:
+    std::atomic<uint64_t> _allocations;
+    std::atomic<uint64_t> _deallocations;
+    std::atomic<uint64_t> _bytesAllocated;
+    std::atomic<uint64_t> _bytesDeallocated;
+};
+
+// Shares a resource that is never destroyed, such as heap() and pool(),
+// without owning it. Copies do no reference counting.
+inline std::shared_ptr<MemoryResource> unownedResource(MemoryResource& resource)
+{
+    return std::shared_ptr<MemoryResource>(std::shared_ptr<MemoryResource>(),
+                                           &resource);
+}
+
+// Standard allocator over a MemoryResource, e.g. for std::allocate_shared.
+template <typename T>
+class Allocator {
+  public:
+    using value_type = T;
+
+    explicit Allocator(std::shared_ptr<MemoryResource> resource) noexcept
+        : _resource(std::move(resource))
+    {
+    }
+
+    template <typename U>
+    Allocator(const Allocator<U>& other) noexcept
+        : _resource(other.sharedResource())
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(_resource->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        _resource->deallocate(ptr, n * sizeof(T));
+    }
+
+    MemoryResource& resource() const noexcept { return *_resource; }
+
+    const std::shared_ptr<MemoryResource>& sharedResource() const noexcept
+    {
+        return _resource;
+    }
+
+  private:
+    std::shared_ptr<MemoryResource> _resource;
+};
+
+template <typename T, typename U>
+bool operator==(const Allocator<T>& lhs, const Allocator<U>& rhs) noexcept
+{
+    return &lhs.resource() == &rhs.resource();
+}
+
+template <typename T, typename U>
+bool operator!=(const Allocator<T>& lhs, const Allocator<U>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+// For class-specific operator new and delete: memory from `resource`,
+// preceded by a shared pointer to it so that it can be freed given only the
+// address and size of the object, even after its other owners let go.
+void* allocateTagged(std::size_t size,
+                     const std::shared_ptr<MemoryResource>& resource);
+
+void deallocateTagged(void* ptr, std::size_t size) noexcept;
+
+// Bytes allocateTagged takes from the resource for an object of `size`.
+constexpr std::size_t taggedSize(std::size_t size)
+{
+    return size + alignof(std::max_align_t);
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UTILS_MEMORYRESOURCE_H
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/MemoryResource.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+namespace jaegertracing {
+namespace utils {
+namespace {
+
+class TestResource : public MemoryResource {
+  protected:
+    void* doAllocate(std::size_t size) override
+    {
+        return MemoryResource::heap().allocate(size);
+    }
+
+    void doDeallocate(void* ptr, std::size_t size) noexcept override
+    {
+        MemoryResource::heap().deallocate(ptr, size);
+    }
+};
+
+struct Tagged {
+    static void* operator new(std::size_t size,
+                              const std::shared_ptr<MemoryResource>& resource)
+    {
+        return allocateTagged(size, resource);
+    }
+
+    static void operator delete(void* ptr, std::size_t size) noexcept
+    {
+        deallocateTagged(ptr, size);
+    }
+
+    static void operator delete(void* ptr,
+                                const std::shared_ptr<MemoryResource>&) noexcept
+    {
+        deallocateTagged(ptr, sizeof(Tagged));
+    }
+
+    long double _value;
+};
+
+}  // anonymous namespace
+
+TEST(MemoryResource, testStats)
+{
+    TestResource resource;
+    {
+        const auto value = std::allocate_shared<int>(
+            Allocator<int>(unownedResource(resource)), 42);
+        ASSERT_EQ(42, *value);
+        const auto stats = resource.stats();
+        ASSERT_EQ(1U, stats._allocations);
+        ASSERT_EQ(0U, stats._deallocations);
+        ASSERT_LT(0U, stats.bytesInUse());
+    }
+    const auto stats = resource.stats();
+    ASSERT_EQ(1U, stats._deallocations);
+    ASSERT_EQ(stats._bytesAllocated, stats._bytesDeallocated);
+    ASSERT_EQ(0U, stats.bytesInUse());
+}
+
+TEST(MemoryResource, testTagged)
+{
+    TestResource resource;
+    std::unique_ptr<Tagged> tagged(new (unownedResource(resource)) Tagged());
+    ASSERT_EQ(0U,
+              reinterpret_cast<std::uintptr_t>(tagged.get()) %
+                  alignof(long double));
+    ASSERT_EQ(taggedSize(sizeof(Tagged)), resource.stats()._bytesAllocated);
+    tagged.reset();
+    ASSERT_EQ(0U, resource.stats().bytesInUse());
+}
+
+TEST(MemoryResource, testOutlivesOwner)
+{
+    // Objects keep their resource alive after its owner let go of it.
+    auto resource = std::make_shared<TestResource>();
+    const std::weak_ptr<TestResource> weakResource(resource);
+    std::unique_ptr<Tagged> tagged(new (resource) Tagged());
+    const auto value = std::allocate_shared<int>(Allocator<int>(resource), 1);
+    resource.reset();
+    ASSERT_FALSE(weakResource.expired());
+    tagged.reset();
+    ASSERT_FALSE(weakResource.expired());
+    ASSERT_EQ(1U, weakResource.lock()->stats()._deallocations);
+}
+
+TEST(MemoryResource, testPool)
+{
+    std::thread thread([]() {
+        constexpr auto kSize = static_cast<std::size_t>(100);
+        auto& pool = MemoryResource::pool();
+        auto* first = pool.allocate(kSize);
+        pool.deallocate(first, kSize);
+        ASSERT_EQ(1U, MemoryResource::poolSize(kSize));
+        // Same size class.
+        auto* second = pool.allocate(kSize + 1);
+        ASSERT_EQ(first, second);
+        ASSERT_EQ(0U, MemoryResource::poolSize(kSize));
+        pool.deallocate(second, kSize + 1);
+
+        // Too large to pool.
+        constexpr auto kLargeSize = static_cast<std::size_t>(4096);
+        pool.deallocate(pool.allocate(kLargeSize), kLargeSize);
+        ASSERT_EQ(0U, MemoryResource::poolSize(kLargeSize));
+    });
+    thread.join();
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
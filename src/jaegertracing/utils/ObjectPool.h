@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UTILS_OBJECTPOOL_H
+#define JAEGERTRACING_UTILS_OBJECTPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace jaegertracing {
+namespace utils {
+
+// Per-thread cache of memory for objects of type T, meant for class-specific
+// operator new and delete. A thread only caches memory once it has called
+// enable(); until then allocate and deallocate go straight to the heap.
+// Memory goes back to the cache of the thread that allocated it: freed on
+// that thread it is cached directly, freed on another it is pushed onto a
+// lock-free list the owner takes over once its cache runs dry. So objects
+// handed to another thread to be freed, like finished spans to the
+// reporter, are still reused by the thread that makes them. At most
+// kMaxSize blocks are cached per type and thread, and they are returned to
+// the heap when the thread exits.
+template <typename T>
+class ObjectPool {
+  public:
+    static constexpr std::size_t kMaxSize = 256;
+
+    static void enable() noexcept
+    {
+        auto& freeList = cache();
+        if (freeList._owner || freeList._closed) {
+            return;
+        }
+        freeList._owner = Owner::acquire();
+        // Registers the cleanup.
+        static thread_local Drain drain;
+        (void)drain;
+    }
+
+    static bool enabled() noexcept { return cache()._owner != nullptr; }
+
+    // Blocks cached for the calling thread, including those other threads
+    // gave back since it last allocated.
+    static std::size_t size() noexcept
+    {
+        auto& freeList = cache();
+        if (freeList._owner) {
+            collectRemote(freeList);
+        }
+        return freeList._size;
+    }
+
+    static void* allocate(std::size_t size)
+    {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        auto& freeList = cache();
+        if (freeList._owner && !freeList._head) {
+            collectRemote(freeList);
+        }
+        if (freeList._head) {
+            auto* block = freeList._head;
+            freeList._head = block->_next;
+            --freeList._size;
+            return block->object();
+        }
+        auto* block = static_cast<Block*>(::operator new(sizeof(Block)));
+        block->_owner = freeList._owner;
+        return block->object();
+    }
+
+    static void deallocate(void* ptr, std::size_t size) noexcept
+    {
+        if (!ptr) {
+            return;
+        }
+        if (size != sizeof(T)) {
+            ::operator delete(ptr);
+            return;
+        }
+        auto* block = Block::fromObject(ptr);
+        auto* owner = block->_owner;
+        if (!owner) {
+            ::operator delete(block);
+            return;
+        }
+        auto& freeList = cache();
+        if (owner != freeList._owner) {
+            owner->pushRemote(block);
+            return;
+        }
+        if (freeList._size >= kMaxSize) {
+            ::operator delete(block);
+            return;
+        }
+        block->_next = freeList._head;
+        freeList._head = block;
+        ++freeList._size;
+    }
+
+  private:
+    struct Owner;
+
+    // The object follows a header naming the owner of the block. The
+    // header also links the block while it is free.
+    struct Block {
+        static Block* fromObject(void* ptr) noexcept
+        {
+            return reinterpret_cast<Block*>(static_cast<unsigned char*>(ptr) -
+                                            offsetof(Block, _object));
+        }
+
+        void* object() noexcept { return &_object; }
+
+        Owner* _owner;
+        Block* _next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type _object;
+    };
+
+    // Blocks of a thread's cache freed by other threads. Owners are never
+    // destroyed: when a thread exits, its owner is retired and handed to
+    // the next thread that enables the pool, along with blocks still in
+    // flight.
+    struct Owner {
+        static Owner* acquire()
+        {
+            auto& retired = Retired::instance();
+            std::lock_guard<std::mutex> lock(retired._mutex);
+            if (!retired._head) {
+                return new Owner();
+            }
+            auto* owner = retired._head;
+            retired._head = owner->_nextRetired;
+            return owner;
+        }
+
+        void retire()
+        {
+            auto& retired = Retired::instance();
+            std::lock_guard<std::mutex> lock(retired._mutex);
+            _nextRetired = retired._head;
+            retired._head = this;
+        }
+
+        void pushRemote(Block* block) noexcept
+        {
+            auto* head = _remote.load(std::memory_order_relaxed);
+            do {
+                block->_next = head;
+            } while (!_remote.compare_exchange_weak(head,
+                                                    block,
+                                                    std::memory_order_release,
+                                                    std::memory_order_relaxed));
+        }
+
+        // Only the owning thread takes the list, whole, so pushes need no
+        // protection against ABA.
+        Block* takeRemote() noexcept
+        {
+            return _remote.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        std::atomic<Block*> _remote{ nullptr };
+        Owner* _nextRetired = nullptr;
+    };
+
+    struct Retired {
+        static Retired& instance()
+        {
+            // Never destroyed, as threads may exit during static
+            // destruction.
+            static auto* retired = new Retired();
+            return *retired;
+        }
+
+        std::mutex _mutex;
+        Owner* _head = nullptr;
+    };
+
+    // Trivially destructible, so it stays usable while other thread-local
+    // objects are destroyed at thread exit.
+    struct FreeList {
+        Block* _head;
+        std::size_t _size;
+        Owner* _owner;
+        bool _closed;
+    };
+
+    struct Drain {
+        ~Drain()
+        {
+            auto& freeList = cache();
+            auto* owner = freeList._owner;
+            freeList._owner = nullptr;
+            freeList._closed = true;
+            freeBlocks(freeList._head);
+            freeList._head = nullptr;
+            freeList._size = 0;
+            freeBlocks(owner->takeRemote());
+            owner->retire();
+        }
+    };
+
+    // Moves blocks freed by other threads into the cache, up to kMaxSize.
+    static void collectRemote(FreeList& freeList) noexcept
+    {
+        auto* block = freeList._owner->takeRemote();
+        while (block) {
+            auto* next = block->_next;
+            if (freeList._size < kMaxSize) {
+                block->_next = freeList._head;
+                freeList._head = block;
+                ++freeList._size;
+            }
+            else {
+                ::operator delete(block);
+            }
+            block = next;
+        }
+    }
+
+    static void freeBlocks(Block* block) noexcept
+    {
+        while (block) {
+            auto* next = block->_next;
+            ::operator delete(block);
+            block = next;
+        }
+    }
+
+    static FreeList& cache() noexcept
+    {
+        static thread_local FreeList freeList = { nullptr, 0, nullptr, false };
+        return freeList;
+    }
+};
+
+template <typename T>
+constexpr std::size_t ObjectPool<T>::kMaxSize;
+
+}  // namespace utils
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UTILS_OBJECTPOOL_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/ObjectPool.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace jaegertracing {
+namespace utils {
+namespace {
+
+struct Pooled {
+    static void* operator new(std::size_t size)
+    {
+        return ObjectPool<Pooled>::allocate(size);
+    }
+
+    static void operator delete(void* ptr, std::size_t size) noexcept
+    {
+        ObjectPool<Pooled>::deallocate(ptr, size);
+    }
+
+    int _values[4];
+};
+
+}  // anonymous namespace
+
+TEST(ObjectPool, testDisabledByDefault)
+{
+    std::thread thread([]() {
+        delete new Pooled();
+        ASSERT_EQ(0U, ObjectPool<Pooled>::size());
+    });
+    thread.join();
+}
+
+TEST(ObjectPool, testReuse)
+{
+    std::thread thread([]() {
+        ObjectPool<Pooled>::enable();
+        auto* first = new Pooled();
+        delete first;
+        ASSERT_EQ(1U, ObjectPool<Pooled>::size());
+        auto* second = new Pooled();
+        ASSERT_EQ(first, second);
+        ASSERT_EQ(0U, ObjectPool<Pooled>::size());
+        delete second;
+    });
+    thread.join();
+}
+
+TEST(ObjectPool, testMaxSize)
+{
+    std::thread thread([]() {
+        ObjectPool<Pooled>::enable();
+        constexpr auto kNumObjects = ObjectPool<Pooled>::kMaxSize + 10;
+        std::vector<Pooled*> objects;
+        for (auto i = static_cast<std::size_t>(0); i < kNumObjects; ++i) {
+            objects.push_back(new Pooled());
+        }
+        for (auto* object : objects) {
+            delete object;
+        }
+        ASSERT_EQ(ObjectPool<Pooled>::kMaxSize, ObjectPool<Pooled>::size());
+    });
+    thread.join();
+}
+
+TEST(ObjectPool, testFreedOnOtherThread)
+{
+    std::thread producer([]() {
+        ObjectPool<Pooled>::enable();
+        auto* first = new Pooled();
+        std::thread consumer([first]() {
+            ObjectPool<Pooled>::enable();
+            delete first;
+            ASSERT_EQ(0U, ObjectPool<Pooled>::size());
+        });
+        consumer.join();
+        // Back to the thread that allocated it.
+        ASSERT_EQ(1U, ObjectPool<Pooled>::size());
+        auto* second = new Pooled();
+        ASSERT_EQ(first, second);
+        delete second;
+        ASSERT_EQ(1U, ObjectPool<Pooled>::size());
+    });
+    producer.join();
+}
+
+TEST(ObjectPool, testFreedAfterOwnerExited)
+{
+    Pooled* object = nullptr;
+    std::thread producer([&object]() {
+        ObjectPool<Pooled>::enable();
+        object = new Pooled();
+    });
+    producer.join();
+    std::thread consumer([object]() {
+        ObjectPool<Pooled>::enable();
+        delete object;
+        // Picked up by the next thread to take over the producer's pool.
+        auto* other = new Pooled();
+        delete other;
+    });
+    consumer.join();
+}
+
+TEST(ObjectPool, testNotPooledWhenAllocatedDisabled)
+{
+    Pooled* object = nullptr;
+    std::thread producer([&object]() { object = new Pooled(); });
+    producer.join();
+    std::thread consumer([object]() {
+        ObjectPool<Pooled>::enable();
+        delete object;
+        ASSERT_EQ(0U, ObjectPool<Pooled>::size());
+    });
+    consumer.join();
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
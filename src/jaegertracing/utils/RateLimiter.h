@@ -17,54 +17,126 @@
 #ifndef JAEGERTRACING_UTILS_RATELIMITER_H
 #define JAEGERTRACING_UTILS_RATELIMITER_H
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <mutex>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
 
 namespace jaegertracing {
 namespace utils {
 
+// Token bucket that is safe to share between threads without locking. The
+// balance is kept in fixed point so it can be updated with a single
+// compare-and-swap. Elapsed time is claimed with a separate one, so each
+// interval is credited to exactly one caller, though not atomically with
+// the balance, see checkCredit.
 template <typename ClockType = std::chrono::steady_clock>
 class RateLimiter {
   public:
     using Clock = ClockType;
 
+    static_assert(std::is_integral<typename Clock::rep>::value,
+                  "RateLimiter requires a clock with integral ticks");
+
     RateLimiter(double creditsPerSecond, double maxBalance)
-        : _creditsPerSecond(creditsPerSecond)
-        , _maxBalance(maxBalance)
+        : _unitsPerTick(creditsPerSecond * kFixedPointOne *
+                        std::chrono::duration_cast<Seconds>(
+                            typename Clock::duration(1))
+                            .count())
+        , _maxBalance(toFixedPoint(maxBalance))
         , _balance(_maxBalance)
-        , _lastTick(Clock::now())
+        , _lastTick(Clock::now().time_since_epoch().count())
     {
     }
 
     bool checkCredit(double itemCost)
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        const auto currentTime = Clock::now();
-        const auto elapsedTime =
-            std::chrono::duration<double>(currentTime - _lastTick);
-        _lastTick = currentTime;
-
-        _balance += elapsedTime.count() * _creditsPerSecond;
-        if (_balance > _maxBalance) {
-            _balance = _maxBalance;
+        const auto cost = static_cast<std::int64_t>(toFixedPoint(itemCost));
+        const auto currentTick = Clock::now().time_since_epoch().count();
+        // Claiming time and adding its credits to the balance are two
+        // steps, and a caller between them hides those credits from every
+        // other caller. So a caller may be denied credit that becomes
+        // visible an instant later. Loading the tick before the balance
+        // keeps other races to overestimates, which the update below
+        // corrects.
+        auto lastTick = _lastTick.load();
+        auto balance = _balance.load();
+        // Denials leave the state untouched; the time they saw is claimed
+        // by the next caller that does get credit.
+        if (std::min(balance + earnedCredits(currentTick, lastTick),
+                     _maxBalance) < cost) {
+            return false;
         }
 
-        if (_balance >= itemCost) {
-            _balance -= itemCost;
-            return true;
+        const auto credits = claimCredits(currentTick, lastTick);
+        while (true) {
+            auto newBalance = std::min(balance + credits, _maxBalance);
+            const auto hasCredit = (newBalance >= cost);
+            if (hasCredit) {
+                newBalance -= cost;
+            }
+            if (newBalance == balance ||
+                _balance.compare_exchange_weak(balance, newBalance)) {
+                return hasCredit;
+            }
         }
-
-        return false;
     }
 
   private:
-    double _creditsPerSecond;
-    double _maxBalance;
-    double _balance;
-    typename Clock::time_point _lastTick;
-    std::mutex _mutex;
+    using Tick = typename Clock::rep;
+    using Seconds = std::chrono::duration<double>;
+
+    // Units of credit per whole credit.
+    static constexpr double kFixedPointOne = 1 << 20;
+
+    static double toFixedPoint(double credits)
+    {
+        return std::round(credits * kFixedPointOne);
+    }
+
+    std::int64_t earnedCredits(Tick currentTick, Tick lastTick) const
+    {
+        if (currentTick <= lastTick) {
+            return 0;
+        }
+        return static_cast<std::int64_t>(std::min<double>(
+            std::floor((currentTick - lastTick) * _unitsPerTick),
+            _maxBalance));
+    }
+
+    // Advances _lastTick to currentTick and returns the credits earned in
+    // between. Only the time that earned whole units is consumed, so the
+    // fractional remainder carries over to the next claim.
+    std::int64_t claimCredits(Tick currentTick, Tick lastTick)
+    {
+        while (true) {
+            const auto credits = earnedCredits(currentTick, lastTick);
+            if (credits == 0) {
+                return 0;
+            }
+            auto newTick = currentTick;
+            if (credits < _maxBalance) {
+                const auto usedTicks =
+                    static_cast<Tick>(std::ceil(credits / _unitsPerTick));
+                newTick = std::min(lastTick + usedTicks, currentTick);
+            }
+            if (_lastTick.compare_exchange_weak(lastTick, newTick)) {
+                return credits;
+            }
+        }
+    }
+
+    const double _unitsPerTick;
+    const std::int64_t _maxBalance;
+    std::atomic<std::int64_t> _balance;
+    std::atomic<Tick> _lastTick;
 };
 
+template <typename ClockType>
+constexpr double RateLimiter<ClockType>::kFixedPointOne;
+
 }  // namespace utils
 }  // namespace jaegertracing
 
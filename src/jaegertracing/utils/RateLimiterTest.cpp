@@ -15,8 +15,12 @@
  */
 
 #include "jaegertracing/utils/RateLimiter.h"
+#include <atomic>
 #include <chrono>
 #include <gtest/gtest.h>
+#include <iostream>
+#include <thread>
+#include <vector>
 
 namespace jaegertracing {
 namespace utils {
@@ -36,6 +40,26 @@ class MockClock {
     static time_point now() { return currentTime; }
 };
 
+// Calls checkCredit from `numThreads` threads at once and returns the
+// elapsed time.
+std::chrono::steady_clock::duration
+runContended(RateLimiter<>& limiter, int numThreads, int numCallsPerThread)
+{
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&limiter, numCallsPerThread]() {
+            for (auto j = 0; j < numCallsPerThread; ++j) {
+                limiter.checkCredit(1);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+
 }  // anonymous namespace
 
 TEST(RateLimiter, testRateLimiter)
@@ -76,5 +100,66 @@ TEST(RateLimiter, testMaxBalance)
     ASSERT_FALSE(limiter.checkCredit(1.0));
 }
 
+TEST(RateLimiter, testFractionalCredits)
+{
+    const auto timestamp = std::chrono::steady_clock::now();
+    currentTime = timestamp;
+    RateLimiter<MockClock> limiter(1, 1);
+
+    ASSERT_TRUE(limiter.checkCredit(1));
+    // Each call earns slightly more than it spends; the remainders must
+    // add up rather than being rounded away.
+    constexpr auto kNumCalls = 1000000;
+    for (auto i = 1; i <= kNumCalls; ++i) {
+        currentTime = timestamp + std::chrono::microseconds(i);
+        ASSERT_TRUE(limiter.checkCredit(1.0 / kNumCalls));
+    }
+    ASSERT_TRUE(limiter.checkCredit(0.04));
+    ASSERT_FALSE(limiter.checkCredit(0.04));
+}
+
+TEST(RateLimiter, testConcurrentCheckCredit)
+{
+    constexpr auto kNumThreads = 8;
+    constexpr auto kNumCallsPerThread = 10000;
+    constexpr auto kMaxBalance = 100;
+    currentTime = std::chrono::steady_clock::now();
+    RateLimiter<MockClock> limiter(1, kMaxBalance);
+
+    std::atomic<int> numGranted(0);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&limiter, &numGranted]() {
+            for (auto j = 0; j < kNumCallsPerThread; ++j) {
+                if (limiter.checkCredit(1)) {
+                    ++numGranted;
+                }
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    // The clock does not move, so only the initial balance is spent.
+    ASSERT_EQ(kMaxBalance, numGranted);
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests.
+TEST(RateLimiter, DISABLED_testContentionPerformance)
+{
+    constexpr auto kNumCallsPerThread = 100000;
+    constexpr auto kCreditsPerSecond = 1000;
+    using std::chrono::microseconds;
+    for (auto numThreads : { 1, 2, 4, 8 }) {
+        RateLimiter<> limiter(kCreditsPerSecond, kCreditsPerSecond);
+        const auto time =
+            runContended(limiter, numThreads, kNumCallsPerThread);
+        std::cout << numThreads << " threads x " << kNumCallsPerThread
+                  << " calls: "
+                  << std::chrono::duration_cast<microseconds>(time).count()
+                  << "us\n";
+    }
+}
+
 }  // namespace utils
 }  // namespace jaegertracing
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/ShmRing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace jaegertracing {
+namespace utils {
+namespace {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "Atomics shared between processes must be lock-free");
+
+void throwSystemError(const std::string& message)
+{
+    throw std::system_error(errno, std::system_category(), message);
+}
+
+void closeQuietly(int fd)
+{
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+#ifdef __linux__
+
+// MFD_CLOEXEC, which older C libraries do not define.
+constexpr auto kMemfdCloseOnExec = 1U;
+
+int openSharedMemory()
+{
+#ifdef SYS_memfd_create
+    const auto memfd = static_cast<int>(
+        ::syscall(SYS_memfd_create, "jaeger-spans", kMemfdCloseOnExec));
+    if (memfd >= 0 || errno != ENOSYS) {
+        return memfd;
+    }
+#endif
+    // Kernels before 3.17 have no memfd, use a file in /dev/shm unlinked
+    // at once instead.
+    static std::atomic<int> counter(0);
+    std::ostringstream oss;
+    oss << "/dev/shm/jaeger-spans-" << ::getpid() << '-' << counter++;
+    const auto path = oss.str();
+    const auto fd = ::open(
+        path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd >= 0) {
+        ::unlink(path.c_str());
+    }
+    return fd;
+}
+
+#endif  // __linux__
+
+}  // anonymous namespace
+
+constexpr uint32_t ShmRing::kMagic;
+constexpr uint32_t ShmRing::kVersion;
+constexpr int ShmRing::kDataOffset;
+constexpr int ShmRing::kDefaultCapacity;
+constexpr std::size_t ShmRing::kLengthSize;
+
+ShmRing ShmRing::create(std::size_t capacity)
+{
+    static_assert(sizeof(Header) <= kDataOffset, "Header too large");
+#ifdef __linux__
+    auto roundedCapacity = static_cast<std::size_t>(kDataOffset);
+    while (roundedCapacity < capacity) {
+        roundedCapacity *= 2;
+    }
+
+    const auto memoryFD = openSharedMemory();
+    if (memoryFD < 0) {
+        throwSystemError("Failed to create shared memory");
+    }
+    if (::ftruncate(memoryFD, kDataOffset + roundedCapacity) != 0) {
+        const auto error = errno;
+        closeQuietly(memoryFD);
+        throw std::system_error(
+            error, std::system_category(), "Failed to size shared memory");
+    }
+    const auto doorbellFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (doorbellFD < 0) {
+        const auto error = errno;
+        closeQuietly(memoryFD);
+        throw std::system_error(
+            error, std::system_category(), "Failed to create eventfd");
+    }
+
+    ShmRing ring(memoryFD, doorbellFD, roundedCapacity);
+    // The memory is zeroed, so the positions already read zero.
+    ring._header->_magic = kMagic;
+    ring._header->_version = kVersion;
+    ring._header->_capacity = roundedCapacity;
+    return ring;
+#else
+    (void)capacity;
+    throw std::system_error(
+        std::make_error_code(std::errc::not_supported),
+        "Shared memory rings need memfd and eventfd");
+#endif  // __linux__
+}
+
+ShmRing ShmRing::attach(int memoryFD, int doorbellFD)
+{
+    struct ::stat status;
+    if (::fstat(memoryFD, &status) != 0) {
+        const auto error = errno;
+        closeQuietly(memoryFD);
+        closeQuietly(doorbellFD);
+        throw std::system_error(
+            error, std::system_category(), "Failed to stat shared memory");
+    }
+    if (status.st_size <= kDataOffset) {
+        closeQuietly(memoryFD);
+        closeQuietly(doorbellFD);
+        throw std::runtime_error("Shared memory too small for a ring");
+    }
+
+    const auto capacity =
+        static_cast<std::size_t>(status.st_size) - kDataOffset;
+    ShmRing ring(memoryFD, doorbellFD, capacity);
+    const auto& header = *ring._header;
+    if (header._magic != kMagic || header._version != kVersion ||
+        header._capacity != capacity || (capacity & (capacity - 1)) != 0) {
+        throw std::runtime_error("Shared memory does not hold a ring");
+    }
+    return ring;
+}
+
+ShmRing::ShmRing(int memoryFD, int doorbellFD, std::size_t capacity)
+    : _memoryFD(memoryFD)
+    , _doorbellFD(doorbellFD)
+    , _capacity(capacity)
+    , _header(nullptr)
+    , _data(nullptr)
+{
+    auto* memory = ::mmap(nullptr,
+                          kDataOffset + capacity,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          memoryFD,
+                          0);
+    if (memory == MAP_FAILED) {
+        const auto error = errno;
+        close();
+        throw std::system_error(
+            error, std::system_category(), "Failed to map shared memory");
+    }
+    _header = static_cast<Header*>(memory);
+    _data = static_cast<unsigned char*>(memory) + kDataOffset;
+}
+
+ShmRing::ShmRing(ShmRing&& ring)
+    : _memoryFD(ring._memoryFD)
+    , _doorbellFD(ring._doorbellFD)
+    , _capacity(ring._capacity)
+    , _header(ring._header)
+    , _data(ring._data)
+{
+    ring._memoryFD = -1;
+    ring._doorbellFD = -1;
+    ring._header = nullptr;
+    ring._data = nullptr;
+}
+
+ShmRing& ShmRing::operator=(ShmRing&& ring)
+{
+    if (this != &ring) {
+        close();
+        std::swap(_memoryFD, ring._memoryFD);
+        std::swap(_doorbellFD, ring._doorbellFD);
+        std::swap(_capacity, ring._capacity);
+        std::swap(_header, ring._header);
+        std::swap(_data, ring._data);
+    }
+    return *this;
+}
+
+bool ShmRing::tryWrite(const void* data, std::size_t size)
+{
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    const auto writePos = _header->_writePos.load(std::memory_order_relaxed);
+    const auto readPos = _header->_readPos.load(std::memory_order_acquire);
+    const auto used = writePos - readPos;
+    const auto needed = kLengthSize + size;
+    if (used > _capacity || needed > _capacity - used) {
+        return false;
+    }
+    const auto length = static_cast<uint32_t>(size);
+    copyIn(writePos, &length, kLengthSize);
+    copyIn(writePos + kLengthSize, data, size);
+    // Sequentially consistent with the load in notify, so either notify
+    // sees the consumer waiting or the consumer sees this message.
+    _header->_writePos.store(writePos + needed, std::memory_order_seq_cst);
+    return true;
+}
+
+void ShmRing::notify()
+{
+    if (_header->_consumerWaiting.load(std::memory_order_seq_cst) != 0) {
+        const uint64_t value = 1;
+        // Can only fail if the counter is about to overflow, in which case
+        // the consumer is woken anyway.
+        const auto numWritten = ::write(_doorbellFD, &value, sizeof(value));
+        (void)numWritten;
+    }
+}
+
+bool ShmRing::tryRead(std::string& message)
+{
+    const auto readPos = _header->_readPos.load(std::memory_order_relaxed);
+    const auto writePos = _header->_writePos.load(std::memory_order_acquire);
+    if (readPos == writePos) {
+        return false;
+    }
+    const auto available = writePos - readPos;
+    if (available < kLengthSize || available > _capacity) {
+        throw std::runtime_error("Corrupt shared memory ring positions");
+    }
+    uint32_t length = 0;
+    copyOut(readPos, &length, kLengthSize);
+    if (length > available - kLengthSize) {
+        throw std::runtime_error("Corrupt shared memory ring message");
+    }
+    message.resize(length);
+    copyOut(readPos + kLengthSize, &message[0], length);
+    _header->_readPos.store(readPos + kLengthSize + length,
+                            std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::prepareWait()
+{
+    _header->_consumerWaiting.store(1, std::memory_order_seq_cst);
+    if (_header->_writePos.load(std::memory_order_seq_cst) !=
+        _header->_readPos.load(std::memory_order_relaxed)) {
+        _header->_consumerWaiting.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void ShmRing::finishWait()
+{
+    _header->_consumerWaiting.store(0, std::memory_order_relaxed);
+    // Resets the doorbell. It is non-blocking, so this fails harmlessly if
+    // it was not rung.
+    uint64_t value = 0;
+    const auto numRead = ::read(_doorbellFD, &value, sizeof(value));
+    (void)numRead;
+}
+
+void ShmRing::close() noexcept
+{
+    if (_header) {
+        ::munmap(_header, kDataOffset + _capacity);
+        _header = nullptr;
+        _data = nullptr;
+    }
+    closeQuietly(_memoryFD);
+    _memoryFD = -1;
+    closeQuietly(_doorbellFD);
+    _doorbellFD = -1;
+}
+
+void ShmRing::copyIn(uint64_t pos, const void* data, std::size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    const auto offset = static_cast<std::size_t>(pos & (_capacity - 1));
+    const auto first = std::min(size, _capacity - offset);
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    std::memcpy(_data + offset, bytes, first);
+    if (first < size) {
+        std::memcpy(_data, bytes + first, size - first);
+    }
+}
+
+void ShmRing::copyOut(uint64_t pos, void* data, std::size_t size) const
+{
+    if (size == 0) {
+        return;
+    }
+    const auto offset = static_cast<std::size_t>(pos & (_capacity - 1));
+    const auto first = std::min(size, _capacity - offset);
+    auto* bytes = static_cast<unsigned char*>(data);
+    std::memcpy(bytes, _data + offset, first);
+    if (first < size) {
+        std::memcpy(bytes + first, _data, size - first);
+    }
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UTILS_SHMRING_H
+#define JAEGERTRACING_UTILS_SHMRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace jaegertracing {
+namespace utils {
+
+// Single-producer/single-consumer ring of messages in memory shared with
+// another process. The memory is a memfd (or an unlinked /dev/shm object)
+// and an eventfd is the doorbell; both are handed to the other process as
+// file descriptors. The producer only rings the doorbell, its one system
+// call, when the consumer has said it is about to sleep.
+//
+// The shared memory starts with a Header. Messages follow at kDataOffset
+// as a native-endian uint32_t length and the message bytes, wrapping
+// around the end of the data area. Positions only ever increase and are
+// taken modulo the capacity, which is a power of two.
+class ShmRing {
+  public:
+    static constexpr uint32_t kMagic = 0x4a524e47;  // "JRNG"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr auto kDataOffset = 4096;
+    static constexpr auto kDefaultCapacity = 4 * 1024 * 1024;
+
+    // Creates a ring holding at least `capacity` bytes of messages. Throws
+    // std::system_error on failure.
+    static ShmRing create(std::size_t capacity);
+
+    // Maps a ring made by create, usually in another process, and takes
+    // ownership of the descriptors. Throws std::system_error if they cannot
+    // be mapped and std::runtime_error if they do not hold a ring.
+    static ShmRing attach(int memoryFD, int doorbellFD);
+
+    ShmRing(ShmRing&& ring);
+
+    ShmRing& operator=(ShmRing&& ring);
+
+    ShmRing(const ShmRing&) = delete;
+
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    ~ShmRing() { close(); }
+
+    // Producer side. Returns false if there is no room for the message.
+    // The consumer may read it at once, but is only woken by notify.
+    bool tryWrite(const void* data, std::size_t size);
+
+    // Producer side. Wakes the consumer if it is waiting.
+    void notify();
+
+    // Consumer side. Returns false if the ring is empty. Throws
+    // std::runtime_error if the producer wrote a bad length.
+    bool tryRead(std::string& message);
+
+    // Consumer side. Call before waiting for doorbellFD() to be readable.
+    // Returns false, and the consumer must not wait, if a message arrived
+    // meanwhile.
+    bool prepareWait();
+
+    // Consumer side. Call after waking up.
+    void finishWait();
+
+    int memoryFD() const { return _memoryFD; }
+
+    int doorbellFD() const { return _doorbellFD; }
+
+    std::size_t capacity() const { return _capacity; }
+
+    void close() noexcept;
+
+  private:
+    // Offsets are fixed for the agent: _magic 0, _version 4, _capacity 8,
+    // _writePos 64, _readPos 128 and _consumerWaiting 136.
+    struct Header {
+        uint32_t _magic;
+        uint32_t _version;
+        uint64_t _capacity;
+        char _producerPadding[48];
+        // Written by the producer only.
+        std::atomic<uint64_t> _writePos;
+        char _consumerPadding[56];
+        // Written by the consumer only.
+        std::atomic<uint64_t> _readPos;
+        std::atomic<uint32_t> _consumerWaiting;
+    };
+
+    static constexpr auto kLengthSize = sizeof(uint32_t);
+
+    ShmRing(int memoryFD, int doorbellFD, std::size_t capacity);
+
+    void copyIn(uint64_t pos, const void* data, std::size_t size);
+
+    void copyOut(uint64_t pos, void* data, std::size_t size) const;
+
+    int _memoryFD;
+    int _doorbellFD;
+    std::size_t _capacity;
+    Header* _header;
+    unsigned char* _data;
+};
+
+}  // namespace utils
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UTILS_SHMRING_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/ShmRingClient.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include <sys/socket.h>
+
+#include "jaegertracing/utils/UnixDatagramClient.h"
+
+namespace jaegertracing {
+namespace utils {
+
+constexpr std::chrono::seconds ShmRingClient::kRegisterInterval;
+
+ShmRingClient::ShmRingClient(const std::string& path,
+                             int maxPacketSize,
+                             std::size_t ringCapacity)
+    : UDPClient(AF_UNIX,
+                maxPacketSize == 0 ? net::kUnixDatagramMaxLength
+                                   : maxPacketSize)
+    , _path(path)
+    , _addr(UnixDatagramClient::address(path))
+    , _ring(ShmRing::create(ringCapacity))
+    , _registered(false)
+    , _lastRegister()
+{
+    tryRegister();
+}
+
+int ShmRingClient::sendMany(const ::iovec* messages, int numMessages)
+{
+    if (!_registered && !tryRegister()) {
+        const auto error = errno;
+        throw std::system_error(error,
+                                std::system_category(),
+                                "Cannot register shared memory with " +
+                                    _path);
+    }
+
+    auto numSent = 0;
+    while (numSent < numMessages &&
+           _ring.tryWrite(messages[numSent].iov_base,
+                          messages[numSent].iov_len)) {
+        ++numSent;
+    }
+    if (numSent > 0) {
+        _ring.notify();
+    }
+    if (numSent < numMessages) {
+        // A full ring may mean the agent restarted and forgot it. Agents
+        // ignore a ring they already drain, so register it again, but not
+        // on every flush while the agent merely falls behind.
+        if (Clock::now() - _lastRegister >= kRegisterInterval) {
+            tryRegister();
+        }
+        addWouldBlock(numMessages - numSent);
+    }
+    return numSent;
+}
+
+bool ShmRingClient::tryRegister()
+{
+    // The message is the magic number, with the memory and doorbell
+    // descriptors attached.
+    auto magic = ShmRing::kMagic;
+    ::iovec payload;
+    payload.iov_base = &magic;
+    payload.iov_len = sizeof(magic);
+
+    const int fds[] = { _ring.memoryFD(), _ring.doorbellFD() };
+    union {
+        char _buffer[CMSG_SPACE(sizeof(fds))];
+        ::cmsghdr _align;
+    } control;
+    std::memset(&control, 0, sizeof(control));
+
+    ::msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_name = &_addr;
+    message.msg_namelen = sizeof(_addr);
+    message.msg_iov = &payload;
+    message.msg_iovlen = 1;
+    message.msg_control = control._buffer;
+    message.msg_controllen = sizeof(control._buffer);
+    auto* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(header), fds, sizeof(fds));
+
+    _lastRegister = Clock::now();
+    _registered = (::sendmsg(socket().handle(), &message, 0) >= 0);
+    return _registered;
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UTILS_SHMRINGCLIENT_H
+#define JAEGERTRACING_UTILS_SHMRINGCLIENT_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include <sys/un.h>
+
+#include "jaegertracing/utils/ShmRing.h"
+#include "jaegertracing/utils/UDPClient.h"
+
+namespace jaegertracing {
+namespace utils {
+
+// Hands messages to an agent on the same host through a ShmRing instead of
+// the network. The ring is registered by passing its descriptors to the
+// agent's Unix datagram socket at `path`. After that, sending a message is
+// a copy into shared memory, and a doorbell write only if the agent sleeps.
+class ShmRingClient : public UDPClient {
+  public:
+    // A `maxPacketSize` of zero means net::kUnixDatagramMaxLength.
+    ShmRingClient(const std::string& path,
+                  int maxPacketSize,
+                  std::size_t ringCapacity = ShmRing::kDefaultCapacity);
+
+    // Messages that do not fit in the ring are discarded and counted in
+    // numWouldBlock(), like those that do not fit in a socket buffer.
+    int sendMany(const ::iovec* messages, int numMessages) override;
+
+    const std::string& path() const { return _path; }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    // A full ring is registered again at most this often.
+    static constexpr auto kRegisterInterval = std::chrono::seconds(1);
+
+    bool tryRegister();
+
+    std::string _path;
+    ::sockaddr_un _addr;
+    ShmRing _ring;
+    bool _registered;
+    Clock::time_point _lastRegister;
+};
+
+}  // namespace utils
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UTILS_SHMRINGCLIENT_H
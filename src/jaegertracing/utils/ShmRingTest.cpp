@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/ShmRing.h"
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace jaegertracing {
+namespace utils {
+namespace {
+
+// A second mapping of the same ring, as the agent would have.
+ShmRing attachCopy(const ShmRing& ring)
+{
+    return ShmRing::attach(::dup(ring.memoryFD()), ::dup(ring.doorbellFD()));
+}
+
+}  // anonymous namespace
+
+TEST(ShmRing, testWriteRead)
+{
+    auto producer = ShmRing::create(1);
+    ASSERT_EQ(static_cast<std::size_t>(ShmRing::kDataOffset),
+              producer.capacity());
+    auto consumer = attachCopy(producer);
+    ASSERT_EQ(producer.capacity(), consumer.capacity());
+
+    std::string message;
+    ASSERT_FALSE(consumer.tryRead(message));
+
+    // Enough laps that messages wrap around the end, length and all.
+    for (auto i = 0; i < 1000; ++i) {
+        const auto sent = std::string(i % 97, 'a' + i % 26);
+        ASSERT_TRUE(producer.tryWrite(sent.data(), sent.size()));
+        ASSERT_TRUE(consumer.tryRead(message));
+        ASSERT_EQ(sent, message);
+    }
+    ASSERT_FALSE(consumer.tryRead(message));
+}
+
+TEST(ShmRing, testFull)
+{
+    auto producer = ShmRing::create(ShmRing::kDataOffset);
+    auto consumer = attachCopy(producer);
+    const std::string sent(1000, 'x');
+    auto numWritten = 0;
+    while (producer.tryWrite(sent.data(), sent.size())) {
+        ++numWritten;
+    }
+    ASSERT_EQ(4, numWritten);
+
+    std::string message;
+    ASSERT_TRUE(consumer.tryRead(message));
+    ASSERT_TRUE(producer.tryWrite(sent.data(), sent.size()));
+    for (auto i = 0; i < numWritten; ++i) {
+        ASSERT_TRUE(consumer.tryRead(message));
+        ASSERT_EQ(sent, message);
+    }
+    ASSERT_FALSE(consumer.tryRead(message));
+}
+
+TEST(ShmRing, testDoorbell)
+{
+    auto producer = ShmRing::create(ShmRing::kDefaultCapacity);
+    auto consumer = attachCopy(producer);
+    constexpr auto kNumMessages = 10000;
+
+    std::thread consumerThread([&consumer]() {
+        std::string message;
+        auto numRead = 0;
+        while (numRead < kNumMessages) {
+            if (consumer.tryRead(message)) {
+                ASSERT_EQ(std::to_string(numRead), message);
+                ++numRead;
+                continue;
+            }
+            if (consumer.prepareWait()) {
+                ::pollfd pollFD;
+                pollFD.fd = consumer.doorbellFD();
+                pollFD.events = POLLIN;
+                pollFD.revents = 0;
+                ASSERT_EQ(1, ::poll(&pollFD, 1, 5000));
+            }
+            consumer.finishWait();
+        }
+    });
+
+    for (auto i = 0; i < kNumMessages; ++i) {
+        const auto message = std::to_string(i);
+        while (!producer.tryWrite(message.data(), message.size())) {
+            std::this_thread::yield();
+        }
+        producer.notify();
+    }
+    consumerThread.join();
+}
+
+TEST(ShmRing, testAttachInvalid)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    ASSERT_THROW(ShmRing::attach(fds[0], fds[1]), std::runtime_error);
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
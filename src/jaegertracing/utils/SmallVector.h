@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UTILS_SMALLVECTOR_H
+#define JAEGERTRACING_UTILS_SMALLVECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jaegertracing {
+namespace utils {
+
+// Sequence container that stores up to N elements inside the object and
+// only allocates once it grows past that. Supports the subset of the
+// std::vector interface that spans use.
+template <typename T, std::size_t N>
+class SmallVector {
+  public:
+    static_assert(N > 0, "SmallVector needs inline capacity");
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() noexcept
+        : _data(inlineData())
+        , _size(0)
+        , _capacity(N)
+    {
+    }
+
+    SmallVector(std::initializer_list<T> values)
+        : SmallVector()
+    {
+        append(std::begin(values), std::end(values));
+    }
+
+    SmallVector(const std::vector<T>& values)
+        : SmallVector()
+    {
+        append(std::begin(values), std::end(values));
+    }
+
+    SmallVector(std::vector<T>&& values)
+        : SmallVector()
+    {
+        append(std::make_move_iterator(std::begin(values)),
+               std::make_move_iterator(std::end(values)));
+    }
+
+    SmallVector(const SmallVector& other)
+        : SmallVector()
+    {
+        append(std::begin(other), std::end(other));
+    }
+
+    SmallVector(SmallVector&& other) noexcept
+        : SmallVector()
+    {
+        moveFrom(other);
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        releaseHeap();
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other) {
+            clear();
+            append(std::begin(other), std::end(other));
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            releaseHeap();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    void swap(SmallVector& other) noexcept
+    {
+        if (isInline() || other.isInline()) {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+            return;
+        }
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+    }
+
+    friend void swap(SmallVector& lhs, SmallVector& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    iterator begin() { return _data; }
+
+    const_iterator begin() const { return _data; }
+
+    iterator end() { return _data + _size; }
+
+    const_iterator end() const { return _data + _size; }
+
+    size_type size() const { return _size; }
+
+    size_type capacity() const { return _capacity; }
+
+    bool empty() const { return _size == 0; }
+
+    T* data() { return _data; }
+
+    const T* data() const { return _data; }
+
+    T& operator[](size_type index) { return _data[index]; }
+
+    const T& operator[](size_type index) const { return _data[index]; }
+
+    T& front() { return *begin(); }
+
+    const T& front() const { return *begin(); }
+
+    T& back() { return *(end() - 1); }
+
+    const T& back() const { return *(end() - 1); }
+
+    void reserve(size_type capacity)
+    {
+        if (capacity > _capacity) {
+            grow(capacity);
+        }
+    }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args)
+    {
+        if (_size == _capacity) {
+            // The arguments may refer to an element, so construct the new
+            // one before moving the elements.
+            T value(std::forward<Args>(args)...);
+            grow(_capacity * 2);
+            ::new (static_cast<void*>(_data + _size)) T(std::move(value));
+        }
+        else {
+            ::new (static_cast<void*>(_data + _size))
+                T(std::forward<Args>(args)...);
+        }
+        ++_size;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename InputIterator>
+    void append(InputIterator first, InputIterator last)
+    {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    // Inserts [first, last) before `position`. Rebuilds the sequence, which
+    // is fine for the rare insertions not at the end.
+    template <typename InputIterator>
+    iterator
+    insert(const_iterator position, InputIterator first, InputIterator last)
+    {
+        const auto offset = static_cast<size_type>(position - begin());
+        SmallVector result;
+        result.append(std::make_move_iterator(begin()),
+                      std::make_move_iterator(begin() + offset));
+        result.append(first, last);
+        result.append(std::make_move_iterator(begin() + offset),
+                      std::make_move_iterator(end()));
+        *this = std::move(result);
+        return begin() + offset;
+    }
+
+    void pop_back() noexcept
+    {
+        --_size;
+        _data[_size].~T();
+    }
+
+    void clear() noexcept
+    {
+        for (auto* itr = _data; itr != _data + _size; ++itr) {
+            itr->~T();
+        }
+        _size = 0;
+    }
+
+  private:
+    using Storage =
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    T* inlineData() { return reinterpret_cast<T*>(_inline); }
+
+    bool isInline() const
+    {
+        return _data == reinterpret_cast<const T*>(_inline);
+    }
+
+    void grow(size_type capacity)
+    {
+        auto* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        for (size_type i = 0; i < _size; ++i) {
+            ::new (static_cast<void*>(data + i)) T(std::move(_data[i]));
+            _data[i].~T();
+        }
+        releaseHeap();
+        _data = data;
+        _capacity = capacity;
+    }
+
+    void releaseHeap() noexcept
+    {
+        if (!isInline()) {
+            ::operator delete(_data);
+            _data = inlineData();
+            _capacity = N;
+        }
+    }
+
+    // Requires this to be empty and inline.
+    void moveFrom(SmallVector& other) noexcept
+    {
+        assert(empty() && isInline());
+        if (other.isInline()) {
+            for (size_type i = 0; i < other._size; ++i) {
+                ::new (static_cast<void*>(_data + i))
+                    T(std::move(other._data[i]));
+            }
+            _size = other._size;
+            other.clear();
+            return;
+        }
+        _data = other._data;
+        _size = other._size;
+        _capacity = other._capacity;
+        other._data = other.inlineData();
+        other._size = 0;
+        other._capacity = N;
+    }
+
+    Storage _inline[N];
+    T* _data;
+    size_type _size;
+    size_type _capacity;
+};
+
+}  // namespace utils
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UTILS_SMALLVECTOR_H
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/SmallVector.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jaegertracing {
+namespace utils {
+
+TEST(SmallVector, testInlineAndHeap)
+{
+    SmallVector<std::string, 2> values;
+    ASSERT_TRUE(values.empty());
+    ASSERT_EQ(2U, values.capacity());
+    values.push_back("a");
+    values.emplace_back(3, 'b');
+    const auto* inlineData = values.data();
+    ASSERT_EQ(2U, values.capacity());
+
+    // Growing past the inline capacity moves the elements to the heap,
+    // including when the new element refers to an existing one.
+    values.push_back(values.front());
+    ASSERT_NE(inlineData, values.data());
+    ASSERT_EQ(3U, values.size());
+    ASSERT_EQ((std::vector<std::string>{ "a", "bbb", "a" }),
+              std::vector<std::string>(values.begin(), values.end()));
+
+    values.clear();
+    ASSERT_TRUE(values.empty());
+    ASSERT_LE(3U, values.capacity());
+}
+
+TEST(SmallVector, testCopyAndMove)
+{
+    for (auto size : { 1, 4 }) {
+        SmallVector<std::string, 2> values;
+        for (auto i = 0; i < size; ++i) {
+            values.push_back(std::to_string(i));
+        }
+
+        auto copy = values;
+        ASSERT_EQ(values.size(), copy.size());
+        ASSERT_TRUE(std::equal(values.begin(), values.end(), copy.begin()));
+
+        auto moved = std::move(copy);
+        ASSERT_TRUE(copy.empty());
+        ASSERT_EQ(values.size(), moved.size());
+        ASSERT_TRUE(std::equal(values.begin(), values.end(), moved.begin()));
+
+        SmallVector<std::string, 2> other{ "x" };
+        swap(other, moved);
+        ASSERT_EQ(1U, moved.size());
+        ASSERT_EQ("x", moved.front());
+        ASSERT_EQ(values.size(), other.size());
+        ASSERT_TRUE(std::equal(values.begin(), values.end(), other.begin()));
+
+        other = moved;
+        ASSERT_EQ(1U, other.size());
+        ASSERT_EQ("x", other.front());
+    }
+}
+
+TEST(SmallVector, testInsert)
+{
+    SmallVector<std::unique_ptr<int>, 2> values;
+    values.emplace_back(new int(2));
+    values.emplace_back(new int(3));
+    std::vector<std::unique_ptr<int>> front;
+    front.emplace_back(new int(0));
+    front.emplace_back(new int(1));
+    const auto itr = values.insert(values.begin(),
+                                   std::make_move_iterator(front.begin()),
+                                   std::make_move_iterator(front.end()));
+    ASSERT_EQ(values.begin(), itr);
+    ASSERT_EQ(4U, values.size());
+    for (auto i = 0; i < 4; ++i) {
+        ASSERT_EQ(i, *values[i]);
+    }
+
+    values.pop_back();
+    ASSERT_EQ(3U, values.size());
+    ASSERT_EQ(2, *values.back());
+}
+
+TEST(SmallVector, testFromVector)
+{
+    const std::vector<std::string> source{ "a", "b", "c" };
+    SmallVector<std::string, 4> copy(source);
+    ASSERT_EQ(3U, copy.size());
+    ASSERT_EQ("c", copy.back());
+    std::vector<std::string> temporary(source);
+    SmallVector<std::string, 2> moved(std::move(temporary));
+    ASSERT_EQ(3U, moved.size());
+    ASSERT_EQ("a", moved.front());
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
@@ -15,32 +15,168 @@
  */
 
 #include "jaegertracing/utils/UDPClient.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <thrift/protocol/TCompactProtocol.h>
 #include <thrift/protocol/TProtocol.h>
 
 namespace jaegertracing {
 namespace utils {
+namespace {
+
+// Room for a burst of full packets so a non-blocking send rarely fails.
+// The kernel caps this at net.core.wmem_max.
+constexpr auto kSendBufferSize = 1 << 20;
+
+#ifdef __linux__
+constexpr auto kMaxMessagesPerCall = 16;
+#endif
+
+bool wouldBlock(int error) { return error == EAGAIN || error == EWOULDBLOCK; }
+
+}  // anonymous namespace
 
 UDPClient::UDPClient(const net::IPAddress& serverAddr, int maxPacketSize)
+    : UDPClient(AF_INET, maxPacketSize)
+{
+    _serverAddr = serverAddr;
+    _socket.connect(_serverAddr);
+}
+
+UDPClient::UDPClient(int family, int maxPacketSize)
     : _maxPacketSize(maxPacketSize == 0 ? net::kUDPPacketMaxLength
                                         : maxPacketSize)
     , _buffer(new apache::thrift::transport::TMemoryBuffer(_maxPacketSize))
     , _socket()
-    , _serverAddr(serverAddr)
+    , _serverAddr()
     , _client()
+    , _numWouldBlock(0)
+    , _ioUring()
 {
     using TProtocolFactory = apache::thrift::protocol::TProtocolFactory;
     using TCompactProtocolFactory =
         apache::thrift::protocol::TCompactProtocolFactory;
 
-    _socket.open(AF_INET, SOCK_DGRAM);
-    _socket.connect(_serverAddr);
+    _socket.open(family, SOCK_DGRAM);
+
+    const auto flags = ::fcntl(_socket.handle(), F_GETFL, 0);
+    if (flags < 0 ||
+        ::fcntl(_socket.handle(), F_SETFL, flags | O_NONBLOCK) < 0) {
+        throw std::system_error(
+            errno, std::system_category(), "Failed to set O_NONBLOCK");
+    }
+
+    auto sendBufferSize = 0;
+    ::socklen_t optionLen = sizeof(sendBufferSize);
+    if (::getsockopt(_socket.handle(),
+                     SOL_SOCKET,
+                     SO_SNDBUF,
+                     &sendBufferSize,
+                     &optionLen) == 0 &&
+        sendBufferSize < kSendBufferSize) {
+        // Best effort, a smaller buffer only means more dropped packets.
+        ::setsockopt(_socket.handle(),
+                     SOL_SOCKET,
+                     SO_SNDBUF,
+                     &kSendBufferSize,
+                     sizeof(kSendBufferSize));
+    }
+
     std::shared_ptr<TProtocolFactory> protocolFactory(
         new TCompactProtocolFactory());
     auto protocol = protocolFactory->getProtocol(_buffer);
     _client.reset(new agent::thrift::AgentClient(protocol));
 }
 
+bool UDPClient::useIOUring(int numBuffers)
+{
+    _ioUring = IOUringSender::make(
+        _socket.handle(), static_cast<std::size_t>(_maxPacketSize), numBuffers);
+    return usingIOUring();
+}
+
+int UDPClient::sendMany(const ::iovec* messages, int numMessages)
+{
+    if (_ioUring) {
+        auto numLost = 0;
+        auto numDropped = 0;
+        _ioUring->sendMany(
+            messages, nullptr, numMessages, numLost, numDropped);
+        return numMessages;
+    }
+
+    auto numSent = 0;
+#ifdef __linux__
+    ::mmsghdr headers[kMaxMessagesPerCall];
+    while (numSent < numMessages) {
+        const auto batchSize =
+            std::min(kMaxMessagesPerCall, numMessages - numSent);
+        std::memset(headers, 0, sizeof(headers[0]) * batchSize);
+        for (auto i = 0; i < batchSize; ++i) {
+            auto& header = headers[i].msg_hdr;
+            header.msg_iov = const_cast<::iovec*>(&messages[numSent + i]);
+            header.msg_iovlen = 1;
+        }
+        const auto result =
+            ::sendmmsg(_socket.handle(), headers, batchSize, 0);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (wouldBlock(errno)) {
+                break;
+            }
+            throw std::system_error(
+                errno, std::system_category(), "Failed to write messages");
+        }
+        numSent += result;
+    }
+#else
+    while (numSent < numMessages) {
+        const auto& message = messages[numSent];
+        const auto numWritten =
+            ::send(_socket.handle(), message.iov_base, message.iov_len, 0);
+        if (numWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (wouldBlock(errno)) {
+                break;
+            }
+            throw std::system_error(
+                errno, std::system_category(), "Failed to write message");
+        }
+        ++numSent;
+    }
+#endif
+    _numWouldBlock += numMessages - numSent;
+    return numSent;
+}
+
+int UDPClient::sendWeighted(const ::iovec* messages,
+                            const int* weights,
+                            int numMessages,
+                            int& numLost,
+                            int& numDropped)
+{
+    if (_ioUring) {
+        return _ioUring->sendMany(
+            messages, weights, numMessages, numLost, numDropped);
+    }
+
+    const auto numSent = sendMany(messages, numMessages);
+    auto weightSent = 0;
+    for (auto i = 0; i < numSent; ++i) {
+        weightSent += weights[i];
+    }
+    for (auto i = numSent; i < numMessages; ++i) {
+        numDropped += weights[i];
+    }
+    return weightSent;
+}
+
 }  // namespace utils
 }  // namespace jaegertracing
@@ -17,17 +17,22 @@
 #ifndef JAEGERTRACING_UTILS_UDPCLIENT_H
 #define JAEGERTRACING_UTILS_UDPCLIENT_H
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <system_error>
 
+#include <sys/uio.h>
+
 #include <thrift/protocol/TCompactProtocol.h>
 #include <thrift/transport/TBufferTransports.h>
 
 #include "jaegertracing/net/IPAddress.h"
 #include "jaegertracing/net/Socket.h"
 #include "jaegertracing/thrift-gen/Agent.h"
+#include "jaegertracing/utils/IOUring.h"
 
 namespace jaegertracing {
 namespace utils {
@@ -59,19 +64,71 @@ class UDPClient : public agent::thrift::AgentIf {
                 << batch.spans.size();
             throw std::logic_error(oss.str());
         }
-        const auto numWritten = ::write(_socket.handle(), data, size);
-        if (static_cast<unsigned>(numWritten) != size) {
-            std::ostringstream oss;
-            oss << "Failed to write message"
-                   ", numWritten="
-                << numWritten << ", size=" << size;
-            throw std::system_error(errno, std::system_category(), oss.str());
+        send(data, size);
+    }
+
+    // Sends one already encoded Agent message.
+    void send(const uint8_t* data, std::size_t size)
+    {
+        ::iovec message;
+        message.iov_base = const_cast<uint8_t*>(data);
+        message.iov_len = size;
+        if (sendMany(&message, 1) != 1) {
+            throw std::system_error(
+                std::make_error_code(std::errc::operation_would_block),
+                "Failed to write message, socket buffer full");
         }
     }
 
+    // Sends already encoded Agent messages, one datagram each, using as few
+    // system calls as the platform allows. The socket never blocks: if its
+    // send buffer fills up, the remaining messages are discarded, counted
+    // in numWouldBlock() and the number actually sent is returned. Other
+    // errors throw std::system_error.
+    // Through io_uring all messages are queued and count as sent, see
+    // sendWeighted().
+    virtual int sendMany(const ::iovec* messages, int numMessages);
+
+    // Sends like sendMany(), where each message counts for its weight, e.g.
+    // the number of spans in it. Returns the weights of messages known to be
+    // sent, adds those of messages discarded because the send buffer was
+    // full to `numDropped`, and those of messages otherwise lost to
+    // `numLost`. Through io_uring, that is only known once a message is
+    // reaped, which may be on a later call.
+    int sendWeighted(const ::iovec* messages,
+                     const int* weights,
+                     int numMessages,
+                     int& numLost,
+                     int& numDropped);
+
+    // Sends through io_uring from now on, with `numBuffers` packets in
+    // flight at most. Returns false, and sending is unchanged, if io_uring
+    // is unavailable.
+    bool useIOUring(int numBuffers);
+
+    bool usingIOUring() const { return static_cast<bool>(_ioUring); }
+
+    // Messages discarded because the socket send buffer was full.
+    int64_t numWouldBlock() const
+    {
+        return _numWouldBlock + (_ioUring ? _ioUring->numWouldBlock() : 0);
+    }
     int maxPacketSize() const { return _maxPacketSize; }
 
-    void close() { _socket.close(); }
+    void close()
+    {
+        // Waits for sends in flight.
+        _ioUring.reset();
+        _socket.close();
+    }
+
+  protected:
+    // Opens a socket of `family` without connecting it.
+    UDPClient(int family, int maxPacketSize);
+
+    net::Socket& socket() { return _socket; }
+
+    void addWouldBlock(int numMessages) { _numWouldBlock += numMessages; }
 
   private:
     int _maxPacketSize;
@@ -79,6 +136,8 @@ class UDPClient : public agent::thrift::AgentIf {
     net::Socket _socket;
     net::IPAddress _serverAddr;
     std::unique_ptr<agent::thrift::AgentClient> _client;
+    int64_t _numWouldBlock;
+    std::unique_ptr<IOUringSender> _ioUring;
 };
 
 }  // namespace utils
@@ -22,6 +22,7 @@
 #include <future>
 #include <gtest/gtest.h>
 #include <stdexcept>
+#include <string>
 #include <sys/socket.h>
 #include <thread>
 #include <vector>
@@ -80,5 +81,36 @@ TEST(UDPClient, testBigMessage)
     serverThread.join();
 }
 
+TEST(UDPClient, testSendMany)
+{
+    net::Socket socket;
+    socket.open(AF_INET, SOCK_DGRAM);
+    socket.bind(net::IPAddress::v4("127.0.0.1", 0));
+    ::sockaddr_storage addrStorage;
+    ::socklen_t addrLen = sizeof(addrStorage);
+    ASSERT_EQ(0,
+              ::getsockname(socket.handle(),
+                            reinterpret_cast<::sockaddr*>(&addrStorage),
+                            &addrLen));
+    const net::IPAddress serverAddr(addrStorage, addrLen);
+
+    UDPClient udpClient(serverAddr, 0);
+    const std::string messages[] = { "first", "second", "third" };
+    ::iovec iovecs[3];
+    for (auto i = 0; i < 3; ++i) {
+        iovecs[i].iov_base = const_cast<char*>(messages[i].data());
+        iovecs[i].iov_len = messages[i].size();
+    }
+    ASSERT_EQ(3, udpClient.sendMany(iovecs, 3));
+    ASSERT_EQ(0, udpClient.numWouldBlock());
+
+    // Each message must arrive as its own datagram.
+    for (auto&& message : messages) {
+        char buffer[16];
+        const auto numRead = ::recv(socket.handle(), buffer, sizeof(buffer), 0);
+        ASSERT_EQ(message, std::string(buffer, numRead));
+    }
+}
+
 }  // namespace utils
 }  // namespace jaegertracing
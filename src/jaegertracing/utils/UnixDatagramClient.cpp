@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jaegertracing/utils/UnixDatagramClient.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+
+namespace jaegertracing {
+namespace utils {
+namespace {
+
+// The listener is gone, or was replaced by a new socket at the same path.
+bool disconnected(int error)
+{
+    return error == ECONNREFUSED || error == ENOTCONN || error == ENOENT;
+}
+
+}  // anonymous namespace
+
+::sockaddr_un UnixDatagramClient::address(const std::string& path)
+{
+    ::sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("Invalid Unix socket path \"" + path +
+                                    '"');
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return addr;
+}
+
+UnixDatagramClient::UnixDatagramClient(const std::string& path,
+                                       int maxPacketSize)
+    : UDPClient(AF_UNIX,
+                maxPacketSize == 0 ? net::kUnixDatagramMaxLength
+                                   : maxPacketSize)
+    , _path(path)
+    , _addr(address(path))
+    , _connected(false)
+{
+    tryConnect();
+}
+
+int UnixDatagramClient::sendMany(const ::iovec* messages, int numMessages)
+{
+    if (!_connected && !tryConnect()) {
+        const auto error = errno;
+        throw std::system_error(
+            error, std::system_category(), "Cannot connect socket to " + _path);
+    }
+    try {
+        return UDPClient::sendMany(messages, numMessages);
+    } catch (const std::system_error& ex) {
+        if (!disconnected(ex.code().value())) {
+            throw;
+        }
+    }
+    // Datagram sockets can simply connect again. Anything sent before the
+    // error went to the old listener, so all the messages are sent again.
+    _connected = false;
+    if (!tryConnect()) {
+        const auto error = errno;
+        throw std::system_error(error,
+                                std::system_category(),
+                                "Cannot reconnect socket to " + _path);
+    }
+    return UDPClient::sendMany(messages, numMessages);
+}
+
+bool UnixDatagramClient::tryConnect()
+{
+    const auto returnCode =
+        ::connect(socket().handle(),
+                  reinterpret_cast<const ::sockaddr*>(&_addr),
+                  sizeof(_addr));
+    _connected = (returnCode == 0);
+    return _connected;
+}
+
+}  // namespace utils
+}  // namespace jaegertracing
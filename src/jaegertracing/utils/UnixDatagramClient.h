@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2018 Uber Technologies, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JAEGERTRACING_UTILS_UNIXDATAGRAMCLIENT_H
+#define JAEGERTRACING_UTILS_UNIXDATAGRAMCLIENT_H
+
+#include <string>
+
+#include <sys/un.h>
+
+#include "jaegertracing/utils/UDPClient.h"
+
+namespace jaegertracing {
+namespace utils {
+
+// Sends the same messages as UDPClient over a Unix domain datagram socket.
+// Messages skip the network stack and may be larger than a UDP packet. The
+// agent need not be listening yet when the client is made: the socket is
+// connected on first use, and again if the agent restarts.
+class UnixDatagramClient : public UDPClient {
+  public:
+    // Throws std::invalid_argument if `path` is empty or too long for a
+    // socket address.
+    static ::sockaddr_un address(const std::string& path);
+
+    // A `maxPacketSize` of zero means net::kUnixDatagramMaxLength.
+    UnixDatagramClient(const std::string& path, int maxPacketSize);
+
+    int sendMany(const ::iovec* messages, int numMessages) override;
+
+    const std::string& path() const { return _path; }
+
+  private:
+    bool tryConnect();
+
+    std::string _path;
+    ::sockaddr_un _addr;
+    bool _connected;
+};
+
+}  // namespace utils
+}  // namespace jaegertracing
+
+#endif  // JAEGERTRACING_UTILS_UNIXDATAGRAMCLIENT_H